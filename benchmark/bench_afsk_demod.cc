@@ -0,0 +1,70 @@
+#include "afsk_demod.h"
+
+#include <benchmark/benchmark.h>
+
+using namespace audio_wifi_config;
+
+// 生成与配网工具相同格式的 AFSK 信号：起始标识 + 文本 + 校验和 + 结束标识，高位在前
+static std::vector<float> MakeAfskSignal(const std::string& text) {
+    std::vector<uint8_t> bits(16, 0);   // 前导静默位，等待分析窗口填满
+    bits.insert(bits.end(), kDefaultStartTransmissionPattern.begin(), kDefaultStartTransmissionPattern.end());
+    std::string bytes = text;
+    bytes += (char)AudioDataBuffer::CalculateChecksum(text);
+    for (char byte : bytes) {
+        for (int i = 7; i >= 0; i--) {
+            bits.push_back((byte >> i) & 1);
+        }
+    }
+    bits.insert(bits.end(), kDefaultEndTransmissionPattern.begin(), kDefaultEndTransmissionPattern.end());
+    bits.insert(bits.end(), 16, 0);
+
+    const size_t samples_per_bit = kAudioSampleRate / kBitRate;
+    std::vector<float> signal;
+    signal.reserve(bits.size() * samples_per_bit);
+    float phase = 0;
+    for (auto bit : bits) {
+        float step = 2.0f * (float)M_PI * (bit ? kMarkFrequency : kSpaceFrequency) / kAudioSampleRate;
+        for (size_t i = 0; i < samples_per_bit; i++) {
+            signal.push_back(8000.0f * std::sin(phase));
+            phase += step;
+        }
+    }
+    return signal;
+}
+
+// 参数为每次送入的采样数，192 对应设备上 30ms 的音频降采样到 6400Hz
+static void BM_AfskProcessAudioSamples(benchmark::State& state) {
+    auto signal = MakeAfskSignal("benchmark-ssid\npassword1234");
+    size_t chunk = state.range(0);
+    std::vector<float> samples(signal.begin(), signal.begin() + chunk);
+    AudioSignalProcessor processor(kAudioSampleRate, kMarkFrequency, kSpaceFrequency, kBitRate, kWindowSize);
+    for (auto _ : state) {
+        auto probabilities = processor.ProcessAudioSamples(samples);
+        benchmark::DoNotOptimize(probabilities);
+    }
+    state.SetItemsProcessed(state.iterations() * chunk);
+}
+BENCHMARK(BM_AfskProcessAudioSamples)->Arg(192);
+
+// 从音频到解出 Wi-Fi 信息的完整流程
+static void BM_AfskDecodeCredentials(benchmark::State& state) {
+    const std::string text = "benchmark-ssid\npassword1234";
+    auto signal = MakeAfskSignal(text);
+    const size_t chunk = 192;
+    for (auto _ : state) {
+        AudioSignalProcessor processor(kAudioSampleRate, kMarkFrequency, kSpaceFrequency, kBitRate, kWindowSize);
+        AudioDataBuffer buffer;
+        bool decoded = false;
+        for (size_t offset = 0; offset < signal.size() && !decoded; offset += chunk) {
+            size_t end = std::min(offset + chunk, signal.size());
+            std::vector<float> samples(signal.begin() + offset, signal.begin() + end);
+            decoded = buffer.ProcessProbabilityData(processor.ProcessAudioSamples(samples), 0.5f);
+        }
+        if (!decoded || buffer.decoded_text != text) {
+            state.SkipWithError("Failed to decode AFSK signal");
+            break;
+        }
+    }
+    state.SetItemsProcessed(state.iterations() * signal.size());
+}
+BENCHMARK(BM_AfskDecodeCredentials);
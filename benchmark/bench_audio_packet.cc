@@ -0,0 +1,49 @@
+#include "audio_packet.h"
+
+#include <benchmark/benchmark.h>
+
+// 60ms 的 OPUS 帧一般在 100~200 字节
+#define OPUS_PAYLOAD_SIZE 160
+
+static AudioStreamPacket MakePacket() {
+    AudioStreamPacket packet;
+    packet.sample_rate = 24000;
+    packet.frame_duration = 60;
+    packet.timestamp = 123456;
+    packet.payload.resize(OPUS_PAYLOAD_SIZE);
+    for (size_t i = 0; i < packet.payload.size(); i++) {
+        packet.payload[i] = (uint8_t)i;
+    }
+    return packet;
+}
+
+// 参数为协议版本
+static void BM_SerializeAudioPacket(benchmark::State& state) {
+    int version = state.range(0);
+    auto packet = MakePacket();
+    for (auto _ : state) {
+        std::string buffer;
+        auto serialized = SerializeAudioPacket(version, packet, buffer);
+        benchmark::DoNotOptimize(serialized);
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_SerializeAudioPacket)->Arg(1)->Arg(2)->Arg(3);
+
+static void BM_ParseAudioPacket(benchmark::State& state) {
+    int version = state.range(0);
+    auto packet = MakePacket();
+    std::string buffer;
+    auto serialized = SerializeAudioPacket(version, packet, buffer);
+    auto parsed = ParseAudioPacket(version, serialized.data(), serialized.size(), 24000, 60);
+    if (parsed == nullptr || parsed->payload.size() != OPUS_PAYLOAD_SIZE) {
+        state.SkipWithError("Round trip failed");
+        return;
+    }
+    for (auto _ : state) {
+        auto packet = ParseAudioPacket(version, serialized.data(), serialized.size(), 24000, 60);
+        benchmark::DoNotOptimize(packet);
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_ParseAudioPacket)->Arg(1)->Arg(2)->Arg(3);
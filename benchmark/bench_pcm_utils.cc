@@ -0,0 +1,50 @@
+#include "pcm_utils.h"
+
+#include <benchmark/benchmark.h>
+#include <vector>
+
+// 参数为每个声道的采样数，480 / 960 分别对应 16kHz 下 30ms / 60ms
+static std::vector<int16_t> MakePcm(size_t samples) {
+    std::vector<int16_t> pcm(samples);
+    for (size_t i = 0; i < samples; i++) {
+        pcm[i] = (int16_t)(i * 37);
+    }
+    return pcm;
+}
+
+static void BM_DeinterleaveStereo(benchmark::State& state) {
+    size_t frames = state.range(0);
+    auto input = MakePcm(frames * 2);
+    std::vector<int16_t> left(frames), right(frames);
+    for (auto _ : state) {
+        DeinterleaveStereo(input.data(), frames, left.data(), right.data());
+        benchmark::ClobberMemory();
+    }
+    state.SetItemsProcessed(state.iterations() * frames);
+}
+BENCHMARK(BM_DeinterleaveStereo)->Arg(480)->Arg(960);
+
+static void BM_InterleaveStereo(benchmark::State& state) {
+    size_t frames = state.range(0);
+    auto left = MakePcm(frames);
+    auto right = MakePcm(frames);
+    std::vector<int16_t> output(frames * 2);
+    for (auto _ : state) {
+        InterleaveStereo(left.data(), right.data(), frames, output.data());
+        benchmark::ClobberMemory();
+    }
+    state.SetItemsProcessed(state.iterations() * frames);
+}
+BENCHMARK(BM_InterleaveStereo)->Arg(480)->Arg(960);
+
+static void BM_ExtractLeftChannel(benchmark::State& state) {
+    size_t frames = state.range(0);
+    auto input = MakePcm(frames * 2);
+    std::vector<int16_t> output(frames);
+    for (auto _ : state) {
+        ExtractLeftChannel(input.data(), frames, output.data());
+        benchmark::ClobberMemory();
+    }
+    state.SetItemsProcessed(state.iterations() * frames);
+}
+BENCHMARK(BM_ExtractLeftChannel)->Arg(480)->Arg(960);
@@ -0,0 +1,28 @@
+#include "string_utils.h"
+
+#include <benchmark/benchmark.h>
+
+// 模拟服务器返回的 JSON，其中 escaped_percent% 的文本为 \uXXXX 转义的中文
+static std::string MakeEscapedText(size_t length, int escaped_percent) {
+    std::string text;
+    text.reserve(length);
+    size_t i = 0;
+    while (text.size() < length) {
+        if ((int)(i++ % 100) < escaped_percent) {
+            text += "\\u4f60";
+        } else {
+            text += 'a';
+        }
+    }
+    return text;
+}
+
+static void BM_DecodeUnicodeEscapes(benchmark::State& state) {
+    auto input = MakeEscapedText(4096, state.range(0));
+    for (auto _ : state) {
+        auto output = DecodeUnicodeEscapes(input);
+        benchmark::DoNotOptimize(output);
+    }
+    state.SetBytesProcessed(state.iterations() * input.size());
+}
+BENCHMARK(BM_DecodeUnicodeEscapes)->Arg(0)->Arg(20)->Arg(100);
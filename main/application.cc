@@ -5,12 +5,16 @@
 #include "display.h"
 #include "font_awesome_symbols.h"
 #include "mcp_server.h"
+#include "heap_guard.h"
 #include "mqtt_protocol.h"
+#include "power_governor.h"
 #include "server_config.h"
 #include "settings.h"
+#include "string_utils.h"
 #include "system_info.h"
 #include "websocket_protocol.h"
 
+#include <algorithm>
 #include <arpa/inet.h>
 #include <cJSON.h>
 #include <cctype>
@@ -18,6 +22,7 @@
 #include <driver/gpio.h>
 #include <esp_camera.h>
 #include <esp_log.h>
+#include <esp_timer.h>
 #include <img_converters.h>
 
 // 包含相机类头文件
@@ -25,58 +30,18 @@
 #include "boards/sensecap-watcher/sscma_camera.h"
 
 #define WEBSOCKET_CONNECT_GAP 5000 // 重连间隔,5s
-
-// Unicode解码函数
-std::string DecodeUnicodeEscapes(const std::string &input)
-{
-    std::string result;
-    result.reserve(input.length());
-
-    for (size_t i = 0; i < input.length(); ++i)
-    {
-        if (input[i] == '\\' && i + 1 < input.length() && input[i + 1] == 'u' && i + 5 < input.length())
-        {
-            // 解析 \uXXXX 格式的Unicode转义序列
-            std::string hex_str = input.substr(i + 2, 4);
-            char *end_ptr;
-            unsigned long unicode_value = strtoul(hex_str.c_str(), &end_ptr, 16);
-
-            if (end_ptr == hex_str.c_str() + 4) // 确保解析成功
-            {
-                // 将Unicode码点转换为UTF-8
-                if (unicode_value <= 0x7F)
-                {
-                    // 1字节UTF-8
-                    result += static_cast<char>(unicode_value);
-                }
-                else if (unicode_value <= 0x7FF)
-                {
-                    // 2字节UTF-8
-                    result += static_cast<char>(0xC0 | (unicode_value >> 6));
-                    result += static_cast<char>(0x80 | (unicode_value & 0x3F));
-                }
-                else if (unicode_value <= 0xFFFF)
-                {
-                    // 3字节UTF-8
-                    result += static_cast<char>(0xE0 | (unicode_value >> 12));
-                    result += static_cast<char>(0x80 | ((unicode_value >> 6) & 0x3F));
-                    result += static_cast<char>(0x80 | (unicode_value & 0x3F));
-                }
-                i += 5; // 跳过 \uXXXX
-            }
-            else
-            {
-                result += input[i]; // 解析失败，保持原字符
-            }
-        }
-        else
-        {
-            result += input[i];
-        }
-    }
-
-    return result;
-}
+#define MAX_AUDIO_SEND_FAILURES 10 // 聆听时连续发送失败次数达到该值则尝试切换网络
+#define MAX_STANDBY_RECONNECT_DELAY_MS 60000 // 待命通道重连失败后的最大退避时间
+#define MAX_POOR_LINK_CHECKS 3        // 对话中连续多次链路质量差则尝试切换网络
+#define PEER_DEAD_CHECK_INTERVAL_SECONDS 1 // 死连接检测随 1 秒的时钟定时器进行，与 ping 间隔无关
+#define MAX_PEER_DEAD_DETECT_SECONDS 10    // 服务器失联后最迟在该时间内发现
+
+// 最坏情况：最后一个 pong 刚到达后连接断开，静默超过心跳超时后在下一次检测时发现
+static_assert(CONFIG_HEARTBEAT_TIMEOUT_SECONDS + PEER_DEAD_CHECK_INTERVAL_SECONDS < MAX_PEER_DEAD_DETECT_SECONDS,
+              "Dead peer detection exceeds the worst-case budget");
+// 超时内至少要能收到一次 pong，否则空闲连接会被误判为已死
+static_assert(CONFIG_HEARTBEAT_INTERVAL_SECONDS < CONFIG_HEARTBEAT_TIMEOUT_SECONDS,
+              "Heartbeat interval must be shorter than the dead peer timeout");
 
 #define TAG "Application"
 
@@ -109,6 +74,19 @@ Application::Application()
                                                 .name = "clock_timer",
                                                 .skip_unhandled_events = true};
     esp_timer_create(&clock_timer_args, &clock_timer_handle_);
+
+    esp_timer_create_args_t standby_reconnect_timer_args = {.callback =
+                                                                [](void *arg)
+                                                            {
+                                                                Application *app = (Application *)arg;
+                                                                app->Schedule([app]()
+                                                                              { app->ConnectStandbyChannel(); });
+                                                            },
+                                                            .arg = this,
+                                                            .dispatch_method = ESP_TIMER_TASK,
+                                                            .name = "standby_reconnect",
+                                                            .skip_unhandled_events = true};
+    esp_timer_create(&standby_reconnect_timer_args, &standby_reconnect_timer_);
 }
 
 Application::~Application()
@@ -128,6 +106,11 @@ Application::~Application()
         esp_timer_stop(auto_logout_timer_);
         esp_timer_delete(auto_logout_timer_);
     }
+    if (standby_reconnect_timer_ != nullptr)
+    {
+        esp_timer_stop(standby_reconnect_timer_);
+        esp_timer_delete(standby_reconnect_timer_);
+    }
     vEventGroupDelete(event_group_);
 }
 
@@ -462,13 +445,51 @@ void Application::Start()
     auto codec = board.GetAudioCodec();
     audio_service_.Initialize(codec);
     audio_service_.Start();
+    // 待命时仍有音频要处理（如提示音）则保持升频
+    PowerGovernor::GetInstance().Initialize([this]() { return !audio_service_.IsIdle(); });
+
+    // 内部 RAM 碎片化时在待命状态下依次执行，代价低、对用户无感的在前
+    auto &heap_guard = HeapGuard::GetInstance();
+    heap_guard.AddCompactionPoint("decoder_pool", [this]() { audio_service_.TrimDecoderPool(); });
+    heap_guard.AddCompactionPoint("image_cache", [display]() { display->DropImageCache(); });
+    heap_guard.AddCompactionPoint("chat_history", [display]() { display->TrimChatHistory(2); });
+
+    // 灯效在事件总线任务中跟随设备状态和聆听时的 VAD 变化，不再由主任务直接驱动
+    auto update_led = [](const DeviceEvent &event)
+    {
+        if (event.type == kDeviceEventVadChanged && Application::GetInstance().GetDeviceState() != kDeviceStateListening)
+        {
+            return;
+        }
+        Board::GetInstance().GetLed()->OnStateChanged();
+    };
+    EventBus::GetInstance().Subscribe(kDeviceEventStateChanged, update_led);
+    EventBus::GetInstance().Subscribe(kDeviceEventVadChanged, update_led);
 
     AudioServiceCallbacks callbacks;
     callbacks.on_send_queue_available = [this]() { xEventGroupSetBits(event_group_, MAIN_EVENT_SEND_AUDIO); };
-    callbacks.on_wake_word_detected = [this](const std::string &wake_word) { xEventGroupSetBits(event_group_, MAIN_EVENT_WAKE_WORD_DETECTED); };
-    callbacks.on_vad_change = [this](bool speaking) { xEventGroupSetBits(event_group_, MAIN_EVENT_VAD_CHANGE); };
+    callbacks.on_wake_word_detected = [this](const std::string &wake_word)
+    {
+        PowerGovernor::GetInstance().OnWakeWordDetected(audio_service_.last_wake_word_time_us());
+        xEventGroupSetBits(event_group_, MAIN_EVENT_WAKE_WORD_DETECTED);
+        EventBus::GetInstance().Post(DeviceEvent(kDeviceEventWakeWordDetected));
+    };
+    callbacks.on_vad_change = [this](bool speaking)
+    {
+        DeviceEvent event(kDeviceEventVadChanged);
+        event.vad.speaking = speaking;
+        EventBus::GetInstance().Post(event);
+    };
+    callbacks.on_local_command = [this](const std::string &action, int64_t capture_time_us)
+    { Schedule([this, action, capture_time_us]()
+               { HandleLocalCommand(action, capture_time_us); }); };
     audio_service_.SetCallbacks(callbacks);
 
+#if CONFIG_USE_TTS_CACHE
+    // 缓存回放按解码队列的消耗速度送入，队列满时在缓存任务中等待
+    tts_cache_.Initialize([this](std::unique_ptr<AudioStreamPacket> packet) { audio_service_.PushPacketToDecodeQueue(std::move(packet), true); });
+#endif
+
     /* Start the clock timer to update the status bar */
     esp_timer_start_periodic(clock_timer_handle_, 1000000);
 
@@ -506,6 +527,10 @@ void Application::Start()
         protocol_ = std::make_unique<MqttProtocol>();
     }
 
+    protocol_->EnableTtsCache(tts_cache_.enabled());
+    // 请求服务器按扬声器的采样率下发，采样率一致时设备端无需重采样
+    protocol_->SetPreferredDownlinkFormat(codec->output_sample_rate(), OPUS_FRAME_DURATION_MS);
+
     protocol_->OnNetworkError(
         [this](const std::string &message)
         {
@@ -515,7 +540,10 @@ void Application::Start()
     protocol_->OnIncomingAudio(
         [this](std::unique_ptr<AudioStreamPacket> packet)
         {
-            if (device_state_ == kDeviceStateSpeaking)
+            // 未命中的句子在这里录制；命中后迟到的音频和回放期间的后续句子由缓存接管
+            packet = tts_cache_.ProcessIncomingAudio(std::move(packet));
+            // 打断后服务器停止下发之前到达的音频不再播放
+            if (packet && device_state_ == kDeviceStateSpeaking && !aborted_)
             {
                 audio_service_.PushPacketToDecodeQueue(std::move(packet));
             }
@@ -526,7 +554,7 @@ void Application::Start()
             board.SetPowerSaveMode(false);
             if (protocol_->server_sample_rate() != codec->output_sample_rate())
             {
-                ESP_LOGW(TAG, "Server sample rate %d does not match device output sample rate %d, resampling may cause distortion", protocol_->server_sample_rate(), codec->output_sample_rate());
+                ESP_LOGW(TAG, "Server chose downlink sample rate %d instead of device output sample rate %d, resampling on device", protocol_->server_sample_rate(), codec->output_sample_rate());
             }
         });
     protocol_->OnAudioChannelClosed(
@@ -538,6 +566,11 @@ void Application::Start()
                 {
                     auto display = Board::GetInstance().GetDisplay();
                     display->SetChatMessage("system", "");
+                    // 待命时常驻通道断开，状态不会变化，需要在后台重连
+                    if (device_state_ == kDeviceStateIdle && user_manager_.IsLoggedIn() && !esp_timer_is_active(standby_reconnect_timer_))
+                    {
+                        ScheduleStandbyReconnect(WEBSOCKET_CONNECT_GAP);
+                    }
                     SetDeviceState(kDeviceStateIdle);
                 });
         });
@@ -551,6 +584,8 @@ void Application::Start()
                 auto state = cJSON_GetObjectItem(root, "state");
                 if (strcmp(state->valuestring, "start") == 0)
                 {
+                    // 清除上一轮未能开始的缓存回放
+                    tts_cache_.Abort();
                     Schedule(
                         [this]()
                         {
@@ -563,6 +598,7 @@ void Application::Start()
                 }
                 else if (strcmp(state->valuestring, "stop") == 0)
                 {
+                    tts_cache_.OnSentenceEnd();
                     Schedule(
                         [this]()
                         {
@@ -591,6 +627,13 @@ void Application::Start()
                 }
                 else if (strcmp(state->valuestring, "sentence_start") == 0)
                 {
+                    // 服务器为可复用的句子附带内容哈希，命中本地缓存时通知服务器跳过下发
+                    auto hash = cJSON_GetObjectItem(root, "hash");
+                    std::string hash_str = cJSON_IsString(hash) ? hash->valuestring : "";
+                    if (tts_cache_.OnSentenceStart(hash_str))
+                    {
+                        Schedule([this, hash_str]() { protocol_->SendTtsCacheHit(hash_str); });
+                    }
                     auto text = cJSON_GetObjectItem(root, "text");
                     if (cJSON_IsString(text))
                     {
@@ -732,6 +775,162 @@ void Application::OnClockTimer()
         // SystemInfo::PrintTaskList();
         SystemInfo::PrintHeapStats();
     }
+
+    if (clock_ticks_ % CONFIG_HEAP_GUARD_CHECK_INTERVAL_SECONDS == 0)
+    {
+        Schedule([this]()
+                 { HeapGuard::GetInstance().Check(device_state_ == kDeviceStateIdle); });
+    }
+
+    // 心跳 ping 同时用于 RTT 采样和死连接检测；检测随时钟每秒进行，ping 按心跳间隔发送
+    bool send_ping = clock_ticks_ % CONFIG_HEARTBEAT_INTERVAL_SECONDS == 0;
+    Schedule([this, send_ping]()
+             { CheckLinkQuality(send_ping); });
+}
+
+LinkQuality Application::GetLinkQuality() const
+{
+    if (!protocol_)
+    {
+        return LinkQuality();
+    }
+    return protocol_->GetLinkQuality();
+}
+
+void Application::CheckLinkQuality(bool send_ping)
+{
+    if (protocol_ && protocol_->IsPeerDead())
+    {
+        OnPeerDead();
+        return;
+    }
+    if (!send_ping)
+    {
+        return;
+    }
+    if (!protocol_ || !protocol_->IsAudioChannelOpened())
+    {
+        link_quality_level_ = kLinkQualityUnknown;
+        poor_link_checks_ = 0;
+        return;
+    }
+
+    protocol_->SendPing();
+    auto level = protocol_->GetLinkQuality().Level();
+    if (level != link_quality_level_)
+    {
+        ESP_LOGI(TAG, "Link quality changed: %d -> %d", link_quality_level_, level);
+        link_quality_level_ = level;
+        audio_service_.SetLinkQuality(level);
+        DeviceEvent event(kDeviceEventNetworkChanged);
+        event.network.reason = kNetworkChangeLinkQuality;
+        event.network.link_quality = level;
+        EventBus::GetInstance().Post(event);
+    }
+
+    // 信号强度正常但 RTT/丢包持续恶化时，同样尝试切换到备用网络
+    bool in_conversation = device_state_ == kDeviceStateListening || device_state_ == kDeviceStateSpeaking;
+    if (!in_conversation || level != kLinkQualityPoor)
+    {
+        poor_link_checks_ = 0;
+        return;
+    }
+    if (++poor_link_checks_ >= MAX_POOR_LINK_CHECKS)
+    {
+        poor_link_checks_ = 0;
+        ESP_LOGW(TAG, "Link quality stays poor: %s", protocol_->GetLinkQuality().ToJson().c_str());
+        if (Board::GetInstance().FailoverNetwork())
+        {
+            MigrateAudioChannel();
+        }
+    }
+}
+
+void Application::HandleLocalCommand(const std::string &action, int64_t capture_time_us)
+{
+    if (device_state_ != kDeviceStateListening && device_state_ != kDeviceStateSpeaking)
+    {
+        return;
+    }
+    // 从命令词最后一块音频被采集到在主任务中执行，包含 AFE 缓冲、识别和调度排队的时间
+    ESP_LOGI(TAG, "Local command: %s, %lld ms from capture to dispatch", action.c_str(),
+             (esp_timer_get_time() - capture_time_us) / 1000);
+    auto &board = Board::GetInstance();
+    auto codec = board.GetAudioCodec();
+    if (action == "stop")
+    {
+        if (device_state_ == kDeviceStateSpeaking)
+        {
+            AbortSpeaking(kAbortReasonNone);
+        }
+    }
+    else if (action == "volume_up" || action == "volume_down")
+    {
+        int volume = codec->output_volume() + (action == "volume_up" ? 10 : -10);
+        volume = std::max(0, std::min(100, volume));
+        codec->SetOutputVolume(volume);
+        board.GetDisplay()->ShowNotification(Lang::Strings::VOLUME + std::to_string(volume));
+    }
+    else if (action == "goodbye")
+    {
+        if (protocol_)
+        {
+            protocol_->CloseAudioChannel();
+        }
+    }
+    else
+    {
+        ESP_LOGW(TAG, "Unknown local command action: %s", action.c_str());
+    }
+}
+
+void Application::OnPeerDead()
+{
+    // 检测时间 = 最后一次收到服务器数据到判定死连接的间隔，上限约为心跳超时 + 心跳间隔
+    ESP_LOGW(TAG, "Dead peer detected in state %s, %d ms since last incoming data", STATE_STRINGS[device_state_], protocol_->GetSilentTimeMs());
+    link_quality_level_ = kLinkQualityUnknown;
+    poor_link_checks_ = 0;
+
+    bool in_conversation = device_state_ == kDeviceStateListening || device_state_ == kDeviceStateSpeaking;
+    if (in_conversation && Board::GetInstance().FailoverNetwork())
+    {
+        MigrateAudioChannel();
+        return;
+    }
+
+    // 对话中关闭通道会回到待命并触发常驻连接重建；已在待命时状态不变，需要主动重连
+    bool was_idle = device_state_ == kDeviceStateIdle;
+    protocol_->CloseAudioChannel();
+    if (was_idle)
+    {
+        ScheduleStandbyReconnect(0);
+    }
+}
+
+void Application::ScheduleStandbyReconnect(int delay_ms)
+{
+    standby_reconnect_delay_ms_ = delay_ms;
+    esp_timer_stop(standby_reconnect_timer_);
+    esp_timer_start_once(standby_reconnect_timer_, (uint64_t)delay_ms * 1000 + 1);
+}
+
+void Application::ConnectStandbyChannel()
+{
+    // 再次检查状态，确保仍然在待命状态且用户仍然登录
+    if (device_state_ != kDeviceStateIdle || !user_manager_.IsLoggedIn() || protocol_->IsAudioChannelOpened())
+    {
+        ESP_LOGI(TAG, "Device state or login status changed during delay, skipping WebSocket connection");
+        return;
+    }
+
+    ESP_LOGI(TAG, "Opening WebSocket connection for standby notifications");
+    if (!protocol_->OpenAudioChannel())
+    {
+        // 失败后按指数退避在后台继续重连，避免服务器推送长时间丢失
+        int delay_ms = std::min(std::max(standby_reconnect_delay_ms_ * 2, WEBSOCKET_CONNECT_GAP), MAX_STANDBY_RECONNECT_DELAY_MS);
+        ESP_LOGW(TAG, "Failed to open WebSocket connection in standby mode, retry in %d ms", delay_ms);
+        ScheduleStandbyReconnect(delay_ms);
+    }
 }
 
 // Add a async task to MainLoop
@@ -754,7 +953,7 @@ void Application::MainEventLoop()
 
     while (true)
     {
-        auto bits = xEventGroupWaitBits(event_group_, MAIN_EVENT_SCHEDULE | MAIN_EVENT_SEND_AUDIO | MAIN_EVENT_WAKE_WORD_DETECTED | MAIN_EVENT_VAD_CHANGE | MAIN_EVENT_ERROR, pdTRUE, pdFALSE, portMAX_DELAY);
+        auto bits = xEventGroupWaitBits(event_group_, MAIN_EVENT_SCHEDULE | MAIN_EVENT_SEND_AUDIO | MAIN_EVENT_WAKE_WORD_DETECTED | MAIN_EVENT_ERROR, pdTRUE, pdFALSE, portMAX_DELAY);
         if (bits & MAIN_EVENT_ERROR)
         {
             SetDeviceState(kDeviceStateIdle);
@@ -767,8 +966,17 @@ void Application::MainEventLoop()
             {
                 if (!protocol_->SendAudio(std::move(packet)))
                 {
+                    if (device_state_ == kDeviceStateListening && ++audio_send_failures_ >= MAX_AUDIO_SEND_FAILURES)
+                    {
+                        audio_send_failures_ = 0;
+                        if (Board::GetInstance().FailoverNetwork())
+                        {
+                            MigrateAudioChannel();
+                        }
+                    }
                     break;
                 }
+                audio_send_failures_ = 0;
             }
         }
 
@@ -777,15 +985,6 @@ void Application::MainEventLoop()
             OnWakeWordDetected();
         }
 
-        if (bits & MAIN_EVENT_VAD_CHANGE)
-        {
-            if (device_state_ == kDeviceStateListening)
-            {
-                auto led = Board::GetInstance().GetLed();
-                led->OnStateChanged();
-            }
-        }
-
         if (bits & MAIN_EVENT_SCHEDULE)
         {
             std::unique_lock<std::mutex> lock(mutex_);
@@ -902,6 +1101,12 @@ void Application::AbortSpeaking(AbortReason reason)
 {
     ESP_LOGI(TAG, "Abort speaking");
     aborted_ = true;
+    tts_cache_.Abort();
+    // 不等服务器停止下发，立即清空本地已缓冲的音频；唤醒词打断时从检测时刻开始计算静音延迟
+    if (device_state_ == kDeviceStateSpeaking)
+    {
+        audio_service_.FlushPlayback(reason == kAbortReasonWakeWordDetected ? audio_service_.last_wake_word_time_us() : 0);
+    }
     protocol_->SendAbortSpeaking(reason);
 }
 
@@ -930,12 +1135,38 @@ void Application::SetDeviceState(DeviceState state)
     }
 
     // Send the state change event
-    DeviceStateEventManager::GetInstance().PostStateChangeEvent(previous_state, state);
+    DeviceEvent event(kDeviceEventStateChanged);
+    event.state.previous = previous_state;
+    event.state.current = state;
+    EventBus::GetInstance().Post(event);
+
+    // 本地命令词只在对话中生效
+    audio_service_.EnableLocalCommands(state == kDeviceStateListening || state == kDeviceStateSpeaking);
+
+#if CONFIG_USE_AUDIO_DMA_PROFILES
+    // 待命时只跑唤醒词，用大 DMA 缓冲降低中断频率；实时对话需要打断及时，用小缓冲
+    if (state == kDeviceStateIdle)
+    {
+        audio_service_.SetDmaProfile(kAudioDmaProfileLowPower);
+    }
+    else if ((state == kDeviceStateListening || state == kDeviceStateSpeaking) && listening_mode_ == kListeningModeRealtime)
+    {
+        audio_service_.SetDmaProfile(kAudioDmaProfileLowLatency);
+    }
+    else
+    {
+        audio_service_.SetDmaProfile(kAudioDmaProfileBalanced);
+    }
+#endif
+
+    // 离开说话状态时停止缓存回放，进入说话状态时在清空解码队列之后再开始
+    if (previous_state == kDeviceStateSpeaking)
+    {
+        tts_cache_.SetPlaybackEnabled(false);
+    }
 
     auto &board = Board::GetInstance();
     auto display = board.GetDisplay();
-    auto led = board.GetLed();
-    led->OnStateChanged();
     switch (state)
     {
     case kDeviceStateUnknown:
@@ -951,27 +1182,9 @@ void Application::SetDeviceState(DeviceState state)
         // 只有在用户已登录的情况下，才在待命状态建立WebSocket连接以接收服务器通知
         if (user_manager_.IsLoggedIn() && protocol_ && !protocol_->IsAudioChannelOpened())
         {
-            ESP_LOGI(TAG, "User is logged in, scheduling delayed WebSocket connection for standby notifications (2s delay)");
-            Schedule(
-                [this]()
-                {
-                    // 延时2秒再连接，防止服务端还未及时清除旧的连接
-                    vTaskDelay(pdMS_TO_TICKS(WEBSOCKET_CONNECT_GAP));
-
-                    // 再次检查状态，确保仍然在待命状态且用户仍然登录
-                    if (device_state_ == kDeviceStateIdle && user_manager_.IsLoggedIn() && !protocol_->IsAudioChannelOpened())
-                    {
-                        ESP_LOGI(TAG, "Opening WebSocket connection for standby notifications after 2s delay");
-                        if (!protocol_->OpenAudioChannel())
-                        {
-                            ESP_LOGW(TAG, "Failed to open WebSocket connection in standby mode");
-                        }
-                    }
-                    else
-                    {
-                        ESP_LOGI(TAG, "Device state or login status changed during delay, skipping WebSocket connection");
-                    }
-                });
+            ESP_LOGI(TAG, "User is logged in, scheduling delayed WebSocket connection for standby notifications");
+            // 延时再连接，防止服务端还未及时清除旧的连接；延时在定时器中进行，不阻塞主循环
+            ScheduleStandbyReconnect(WEBSOCKET_CONNECT_GAP);
         }
         else if (!user_manager_.IsLoggedIn())
         {
@@ -1026,6 +1239,7 @@ void Application::SetDeviceState(DeviceState state)
 #endif
         }
         audio_service_.ResetDecoder();
+        tts_cache_.SetPlaybackEnabled(true);
         break;
     case kDeviceStateLogin: {
         // 获取设备MAC地址的后三部分作为设备码
@@ -1140,6 +1354,49 @@ void Application::SendMcpMessage(const std::string &payload)
         });
 }
 
+void Application::MigrateAudioChannel()
+{
+    DeviceEvent event(kDeviceEventNetworkChanged);
+    event.network.reason = kNetworkChangeFailover;
+    event.network.link_quality = kLinkQualityUnknown;
+    EventBus::GetInstance().Post(event);
+
+    Schedule(
+        [this]()
+        {
+            if (!protocol_)
+            {
+                return;
+            }
+            auto previous_state = device_state_;
+            bool in_conversation = previous_state == kDeviceStateListening || previous_state == kDeviceStateSpeaking;
+            // 待命时只迁移用于接收通知的常驻连接，没有连接则无需处理
+            if (!in_conversation && !(previous_state == kDeviceStateIdle && protocol_->IsAudioChannelOpened()))
+            {
+                return;
+            }
+
+            ESP_LOGI(TAG, "Migrating audio channel to the new network");
+            bool processor_running = audio_service_.IsAudioProcessorRunning();
+            if (!protocol_->MigrateAudioChannel())
+            {
+                ESP_LOGE(TAG, "Failed to migrate audio channel");
+                return;
+            }
+
+            // 旧连接上的 TTS 流已中断，回到聆听并在新会话上重新开始
+            if (previous_state == kDeviceStateSpeaking)
+            {
+                audio_service_.ResetDecoder();
+                SetDeviceState(kDeviceStateListening);
+            }
+            if (device_state_ == kDeviceStateListening && processor_running)
+            {
+                protocol_->SendStartListening(listening_mode_);
+            }
+        });
+}
+
 void Application::SetAecMode(AecMode mode)
 {
     aec_mode_ = mode;
@@ -13,15 +13,15 @@
 #include <vector>
 
 #include "audio_service.h"
-#include "device_state_event.h"
+#include "event_bus.h"
 #include "ota.h"
 #include "protocol.h"
+#include "tts_cache.h"
 #include "user_manager.h"
 
 #define MAIN_EVENT_SCHEDULE (1 << 0)
 #define MAIN_EVENT_SEND_AUDIO (1 << 1)
 #define MAIN_EVENT_WAKE_WORD_DETECTED (1 << 2)
-#define MAIN_EVENT_VAD_CHANGE (1 << 3)
 #define MAIN_EVENT_ERROR (1 << 4)
 #define MAIN_EVENT_CHECK_NEW_VERSION_DONE (1 << 5)
 
@@ -93,6 +93,10 @@ public:
     void WakeWordInvoke(const std::string &wake_word);
     bool CanEnterSleepMode();
     void SendMcpMessage(const std::string &payload);
+    void MigrateAudioChannel(); // 网络切换后在新网络上重建音频通道
+    LinkQuality GetLinkQuality() const;
+    LinkQualityLevel GetLinkQualityLevel() const { return link_quality_level_; }
+    TtsCacheStatistics GetTtsCacheStatistics() { return tts_cache_.GetStatistics(); }
     void SetAecMode(AecMode mode);
     AecMode GetAecMode() const { return aec_mode_; }
     void PlaySound(const std::string_view &sound);
@@ -119,6 +123,7 @@ private:
     AecMode aec_mode_ = kAecOff;
     std::string last_error_message_;
     AudioService audio_service_;
+    TtsCache tts_cache_;
 
     bool has_server_time_ = false;
     bool aborted_ = false;
@@ -126,6 +131,11 @@ private:
     bool pending_inspection_after_login_ = false; // 标记登录后是否需要在TTS结束后的首次listening时发送巡检
     bool login_tts_completed_ = false;            // 标记登录后的TTS是否已完成
     int clock_ticks_ = 0;
+    int audio_send_failures_ = 0; // 连续发送失败次数，用于触发网络切换
+    int poor_link_checks_ = 0;    // 连续链路质量差的检查次数
+    esp_timer_handle_t standby_reconnect_timer_ = nullptr;
+    int standby_reconnect_delay_ms_ = 0; // 待命通道重连的退避时间
+    volatile LinkQualityLevel link_quality_level_ = kLinkQualityUnknown;
     TaskHandle_t check_new_version_task_handle_ = nullptr;
 
     void MainEventLoop();
@@ -133,6 +143,11 @@ private:
     void CheckNewVersion(Ota &ota);
     void ShowActivationCode(const std::string &code, const std::string &message);
     void OnClockTimer();
+    void CheckLinkQuality(bool send_ping);
+    void HandleLocalCommand(const std::string &action, int64_t capture_time_us);
+    void OnPeerDead();
+    void ScheduleStandbyReconnect(int delay_ms);
+    void ConnectStandbyChannel();
     void SetListeningMode(ListeningMode mode);
     std::string BuildUserInfoString() const; // 构建用户信息字符串
 };
@@ -15,7 +15,119 @@ AudioCodec::~AudioCodec() {
 }
 
 void AudioCodec::OutputData(std::vector<int16_t>& data) {
-    Write(data.data(), data.size());
+    OutputData(data.data(), data.size());
+}
+
+void AudioCodec::OutputData(const int16_t* data, size_t samples) {
+    Write(data, samples);
+}
+
+void AudioCodec::FlushOutput() {
+    if (tx_handle_ == nullptr || !output_enabled_) {
+        return;
+    }
+    // 停止 TX 通道后用静音预加载整个 DMA 环形缓冲区，覆盖尚未播放的数据。
+    // 预加载按字节进行，与各编解码器的采样格式无关；按 32 位双声道的最大帧长计算缓冲区大小
+    if (i2s_channel_disable(tx_handle_) != ESP_OK) {
+        return;
+    }
+    std::vector<uint8_t> silence(dma_desc_num_ * dma_frame_num_ * 2 * sizeof(int32_t), 0);
+    size_t loaded = 0;
+    i2s_channel_preload_data(tx_handle_, silence.data(), silence.size(), &loaded);
+    ESP_ERROR_CHECK_WITHOUT_ABORT(i2s_channel_enable(tx_handle_));
+}
+
+AudioDmaGeometry AudioCodec::GetDmaGeometry(AudioDmaProfile profile) {
+    // 单个 DMA 缓冲区不能超过 4092 字节，32 位双声道时 frame_num 最大 511
+    switch (profile) {
+    case kAudioDmaProfileLowLatency:
+        return { 4, 120 };
+    case kAudioDmaProfileLowPower:
+        return { 4, 480 };
+    default:
+        return { AUDIO_CODEC_DMA_DESC_NUM, AUDIO_CODEC_DMA_FRAME_NUM };
+    }
+}
+
+bool AudioCodec::SetDmaProfile(AudioDmaProfile profile) {
+    return false;
+}
+
+static bool IRAM_ATTR OnDmaEvent(i2s_chan_handle_t handle, i2s_event_data_t* event, void* user_ctx) {
+    (*(volatile uint32_t*)user_ctx)++;
+    return false;
+}
+
+// 统计 DMA 中断次数，用于比较各配置的实际中断频率；需在通道使能前调用
+void AudioCodec::RegisterDmaCallbacks() {
+    i2s_event_callbacks_t callbacks = {};
+    if (tx_handle_ != nullptr) {
+        callbacks.on_sent = OnDmaEvent;
+        i2s_channel_register_event_callback(tx_handle_, &callbacks, (void*)&dma_interrupt_count_);
+    }
+    if (rx_handle_ != nullptr) {
+        callbacks = {};
+        callbacks.on_recv = OnDmaEvent;
+        i2s_channel_register_event_callback(rx_handle_, &callbacks, (void*)&dma_interrupt_count_);
+    }
+}
+
+// 删除并按新的 DMA 配置重建同一 I2S 端口上的全双工通道，时钟和引脚沿用创建时保存的配置。
+// 失败时（通常是内存不足）恢复原来的配置并返回错误；恢复也失败时通道为空，不会中止运行
+esp_err_t AudioCodec::RecreateDuplexChannels(AudioDmaProfile profile) {
+    auto geometry = GetDmaGeometry(profile);
+    esp_err_t ret = CreateDmaChannels(geometry);
+    if (ret == ESP_OK) {
+        dma_profile_ = profile;
+        dma_desc_num_ = geometry.desc_num;
+        dma_frame_num_ = geometry.frame_num;
+        return ESP_OK;
+    }
+
+    ESP_LOGE(TAG, "Failed to create channels for DMA profile %d: %s", profile, esp_err_to_name(ret));
+    esp_err_t restore = CreateDmaChannels({ dma_desc_num_, dma_frame_num_ });
+    if (restore != ESP_OK) {
+        ESP_LOGE(TAG, "Failed to restore DMA profile %d: %s", dma_profile_, esp_err_to_name(restore));
+    }
+    return ret;
+}
+
+esp_err_t AudioCodec::CreateDmaChannels(const AudioDmaGeometry& geometry) {
+    DeleteDmaChannels();
+    i2s_chan_config_t chan_cfg = dma_chan_cfg_;
+    chan_cfg.dma_desc_num = geometry.desc_num;
+    chan_cfg.dma_frame_num = geometry.frame_num;
+    esp_err_t ret = i2s_new_channel(&chan_cfg, &tx_handle_, &rx_handle_);
+    if (ret == ESP_OK) {
+        ret = i2s_channel_init_std_mode(tx_handle_, &dma_std_cfg_);
+    }
+    if (ret == ESP_OK) {
+        ret = i2s_channel_init_std_mode(rx_handle_, &dma_std_cfg_);
+    }
+    if (ret == ESP_OK) {
+        RegisterDmaCallbacks();
+        ret = i2s_channel_enable(tx_handle_);
+    }
+    if (ret == ESP_OK) {
+        ret = i2s_channel_enable(rx_handle_);
+    }
+    if (ret != ESP_OK) {
+        DeleteDmaChannels();
+    }
+    return ret;
+}
+
+void AudioCodec::DeleteDmaChannels() {
+    if (tx_handle_ != nullptr) {
+        i2s_channel_disable(tx_handle_);
+        i2s_del_channel(tx_handle_);
+        tx_handle_ = nullptr;
+    }
+    if (rx_handle_ != nullptr) {
+        i2s_channel_disable(rx_handle_);
+        i2s_del_channel(rx_handle_);
+        rx_handle_ = nullptr;
+    }
 }
 
 bool AudioCodec::InputData(std::vector<int16_t>& data) {
@@ -34,6 +146,7 @@ void AudioCodec::Start() {
         output_volume_ = 10;
     }
 
+    RegisterDmaCallbacks();
     if (tx_handle_ != nullptr) {
         ESP_ERROR_CHECK(i2s_channel_enable(tx_handle_));
     }
@@ -15,6 +15,18 @@
 #define AUDIO_CODEC_DMA_FRAME_NUM 240
 #define AUDIO_CODEC_DEFAULT_MIC_GAIN 30.0
 
+// I2S DMA 缓冲区配置：描述符越多、每个越大，中断越少、功耗越低，但缓冲延迟越大
+enum AudioDmaProfile {
+    kAudioDmaProfileLowLatency,     // 实时对话
+    kAudioDmaProfileBalanced,       // 普通对话，即原来的固定配置
+    kAudioDmaProfileLowPower,       // 待命唤醒词检测
+};
+
+struct AudioDmaGeometry {
+    int desc_num;
+    int frame_num;
+};
+
 class AudioCodec {
 public:
     AudioCodec();
@@ -25,6 +37,14 @@ public:
     virtual void EnableOutput(bool enable);
 
     virtual void OutputData(std::vector<int16_t>& data);
+    // 按指针和长度写出，可以直接写出大缓冲区中的一段而不拷贝
+    virtual void OutputData(const int16_t* data, size_t samples);
+    virtual void FlushOutput();
+    // 运行时切换 DMA 配置；调用者需保证期间没有读写。不支持的编解码器返回 false
+    virtual bool SetDmaProfile(AudioDmaProfile profile);
+    // 调用者据此跳过不支持切换的编解码器，无需为一次空操作停下音频读写
+    virtual bool SupportsDmaProfiles() const { return false; }
+    static AudioDmaGeometry GetDmaGeometry(AudioDmaProfile profile);
     virtual bool InputData(std::vector<int16_t>& data);
     virtual void Start();
 
@@ -37,6 +57,10 @@ public:
     inline int output_volume() const { return output_volume_; }
     inline bool input_enabled() const { return input_enabled_; }
     inline bool output_enabled() const { return output_enabled_; }
+    inline AudioDmaProfile dma_profile() const { return dma_profile_; }
+    inline int dma_desc_num() const { return dma_desc_num_; }
+    inline int dma_frame_num() const { return dma_frame_num_; }
+    inline uint32_t dma_interrupt_count() const { return dma_interrupt_count_; }
 
 protected:
     i2s_chan_handle_t tx_handle_ = nullptr;
@@ -51,9 +75,19 @@ protected:
     int input_channels_ = 1;
     int output_channels_ = 1;
     int output_volume_ = 70;
+    AudioDmaProfile dma_profile_ = kAudioDmaProfileBalanced;
+    int dma_desc_num_ = AUDIO_CODEC_DMA_DESC_NUM;
+    int dma_frame_num_ = AUDIO_CODEC_DMA_FRAME_NUM;
+    volatile uint32_t dma_interrupt_count_ = 0;
+    i2s_chan_config_t dma_chan_cfg_ = {};   // 由支持切换的编解码器在创建通道时保存
+    i2s_std_config_t dma_std_cfg_ = {};
 
     virtual int Read(int16_t* dest, int samples) = 0;
     virtual int Write(const int16_t* data, int samples) = 0;
+    void RegisterDmaCallbacks();
+    esp_err_t RecreateDuplexChannels(AudioDmaProfile profile);
+    esp_err_t CreateDmaChannels(const AudioDmaGeometry& geometry);
+    void DeleteDmaChannels();
 };
 
 #endif // _AUDIO_CODEC_H
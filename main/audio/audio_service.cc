@@ -1,5 +1,10 @@
 #include "audio_service.h"
 #include <esp_log.h>
+#include <algorithm>
+#include <cmath>
+
+#include "event_bus.h"
+#include "pcm_utils.h"
 
 #if CONFIG_USE_AUDIO_PROCESSOR
 #include "processors/afe_audio_processor.h"
@@ -32,9 +37,27 @@ AudioService::~AudioService() {
 void AudioService::Initialize(AudioCodec* codec) {
     codec_ = codec;
     codec_->Start();
+    UpdateDmaProfileStatistics();
+
+#if CONFIG_USE_AUDIO_DEBUGGER
+    audio_debugger_ = std::make_unique<AudioDebugger>();
+#endif
 
     /* Setup the audio codec */
-    opus_decoder_ = std::make_unique<OpusDecoderWrapper>(codec->output_sample_rate(), 1, OPUS_FRAME_DURATION_MS);
+    // 预先创建常见下行流的解码器：与输出一致的采样率、服务器默认的 24kHz 和本地提示音的 16kHz。
+    // 没有 PSRAM 时内存紧张，只预建输出采样率的解码器，其余按需创建
+#if CONFIG_SPIRAM
+    for (int sample_rate : { codec->output_sample_rate(), 24000, 16000 }) {
+#else
+    for (int sample_rate : { codec->output_sample_rate() }) {
+#endif
+        bool exists = std::any_of(decoder_pool_.begin(), decoder_pool_.end(), [sample_rate](const DecoderSlot& slot) {
+            return slot.decoder->sample_rate() == sample_rate;
+        });
+        if (!exists) {
+            decoder_pool_.push_back(CreateDecoderSlot(sample_rate, OPUS_FRAME_DURATION_MS));
+        }
+    }
     opus_encoder_ = std::make_unique<OpusEncoderWrapper>(16000, 1, OPUS_FRAME_DURATION_MS);
     opus_encoder_->SetComplexity(0);
 
@@ -60,6 +83,9 @@ void AudioService::Initialize(AudioCodec* codec) {
 #endif
 
     audio_processor_->OnOutput([this](std::vector<int16_t>&& data) {
+#if CONFIG_USE_AUDIO_DEBUGGER
+        audio_debugger_->Feed(kAudioDebugTapAfeOutput, data.data(), data.size(), 1, 16000);
+#endif
         PushTaskToEncodeQueue(kAudioTaskTypeEncodeToSendQueue, std::move(data));
     });
 
@@ -72,6 +98,7 @@ void AudioService::Initialize(AudioCodec* codec) {
 
     if (wake_word_) {
         wake_word_->OnWakeWordDetected([this](const std::string& wake_word) {
+            last_wake_word_time_us_ = esp_timer_get_time();
             if (callbacks_.on_wake_word_detected) {
                 callbacks_.on_wake_word_detected(wake_word);
             }
@@ -144,31 +171,32 @@ void AudioService::Stop() {
 
 bool AudioService::ReadAudioData(std::vector<int16_t>& data, int sample_rate, int samples) {
     if (!codec_->input_enabled()) {
+        std::lock_guard<std::mutex> io_lock(codec_input_mutex_);
         codec_->EnableInput(true);
         esp_timer_start_periodic(audio_power_timer_, AUDIO_POWER_CHECK_INTERVAL_MS * 1000);
     }
 
     if (codec_->input_sample_rate() != sample_rate) {
         data.resize(samples * codec_->input_sample_rate() / sample_rate);
+        std::unique_lock<std::mutex> io_lock(codec_input_mutex_);
         if (!codec_->InputData(data)) {
             return false;
         }
+        io_lock.unlock();
+#if CONFIG_USE_AUDIO_DEBUGGER
+        // 音频调试：在重采样之前发送原始麦克风和参考通道
+        audio_debugger_->FeedInput(data, codec_->input_channels(), codec_->input_reference(), codec_->input_sample_rate());
+#endif
         if (codec_->input_channels() == 2) {
             auto mic_channel = std::vector<int16_t>(data.size() / 2);
             auto reference_channel = std::vector<int16_t>(data.size() / 2);
-            for (size_t i = 0, j = 0; i < mic_channel.size(); ++i, j += 2) {
-                mic_channel[i] = data[j];
-                reference_channel[i] = data[j + 1];
-            }
+            DeinterleaveStereo(data.data(), mic_channel.size(), mic_channel.data(), reference_channel.data());
             auto resampled_mic = std::vector<int16_t>(input_resampler_.GetOutputSamples(mic_channel.size()));
             auto resampled_reference = std::vector<int16_t>(reference_resampler_.GetOutputSamples(reference_channel.size()));
             input_resampler_.Process(mic_channel.data(), mic_channel.size(), resampled_mic.data());
             reference_resampler_.Process(reference_channel.data(), reference_channel.size(), resampled_reference.data());
             data.resize(resampled_mic.size() + resampled_reference.size());
-            for (size_t i = 0, j = 0; i < resampled_mic.size(); ++i, j += 2) {
-                data[j] = resampled_mic[i];
-                data[j + 1] = resampled_reference[i];
-            }
+            InterleaveStereo(resampled_mic.data(), resampled_reference.data(), resampled_mic.size(), data.data());
         } else {
             auto resampled = std::vector<int16_t>(input_resampler_.GetOutputSamples(data.size()));
             input_resampler_.Process(data.data(), data.size(), resampled.data());
@@ -176,22 +204,22 @@ bool AudioService::ReadAudioData(std::vector<int16_t>& data, int sample_rate, in
         }
     } else {
         data.resize(samples);
+        std::unique_lock<std::mutex> io_lock(codec_input_mutex_);
         if (!codec_->InputData(data)) {
             return false;
         }
+        io_lock.unlock();
+#if CONFIG_USE_AUDIO_DEBUGGER
+        audio_debugger_->FeedInput(data, codec_->input_channels(), codec_->input_reference(), codec_->input_sample_rate());
+#endif
     }
 
     /* Update the last input time */
     last_input_time_ = std::chrono::steady_clock::now();
     debug_statistics_.input_count++;
 
-#if CONFIG_USE_AUDIO_DEBUGGER
-    // 音频调试：发送原始音频数据
-    if (audio_debugger_ == nullptr) {
-        audio_debugger_ = std::make_unique<AudioDebugger>();
-    }
-    audio_debugger_->Feed(data);
-#endif
+    // 有参考通道时最后一个通道是参考信号，只统计麦克风
+    UpdateAudioLevel(input_level_, data.data(), data.size(), codec_->input_channels());
 
     return true;
 }
@@ -223,11 +251,8 @@ void AudioService::AudioInputTask() {
             if (ReadAudioData(data, 16000, samples)) {
                 // If input channels is 2, we need to fetch the left channel data
                 if (codec_->input_channels() == 2) {
-                    auto mono_data = std::vector<int16_t>(data.size() / 2);
-                    for (size_t i = 0, j = 0; i < mono_data.size(); ++i, j += 2) {
-                        mono_data[i] = data[j];
-                    }
-                    data = std::move(mono_data);
+                    ExtractLeftChannel(data.data(), data.size() / 2, data.data());
+                    data.resize(data.size() / 2);
                 }
                 PushTaskToEncodeQueue(kAudioTaskTypeEncodeToTestingQueue, std::move(data));
                 continue;
@@ -268,21 +293,38 @@ void AudioService::AudioInputTask() {
 void AudioService::AudioOutputTask() {
     while (true) {
         std::unique_lock<std::mutex> lock(audio_queue_mutex_);
-        audio_queue_cv_.wait(lock, [this]() { return !audio_playback_queue_.empty() || service_stopped_; });
+        audio_queue_cv_.wait(lock, [this]() { return !audio_playback_queue_.empty() || playback_flush_pending_ || service_stopped_; });
         if (service_stopped_) {
             break;
         }
+        if (playback_flush_pending_) {
+            lock.unlock();
+            FinishPlaybackFlush();
+            continue;
+        }
 
         auto task = std::move(audio_playback_queue_.front());
         audio_playback_queue_.pop_front();
         audio_queue_cv_.notify_all();
         lock.unlock();
 
+        std::unique_lock<std::mutex> io_lock(codec_output_mutex_);
         if (!codec_->output_enabled()) {
             codec_->EnableOutput(true);
             esp_timer_start_periodic(audio_power_timer_, AUDIO_POWER_CHECK_INTERVAL_MS * 1000);
         }
-        codec_->OutputData(task->pcm);
+        UpdateAudioLevel(output_level_, task->pcm.data(), task->pcm.size(), 1);
+#if CONFIG_USE_AUDIO_DEBUGGER
+        audio_debugger_->Feed(kAudioDebugTapPlayback, task->pcm.data(), task->pcm.size(), 1, codec_->output_sample_rate());
+#endif
+        // 按一个 DMA 周期分块写入，打断时最多等待一个周期即可清空；直接写出解码缓冲区的各段，不拷贝
+        size_t dma_frame_num = codec_->dma_frame_num();
+        const int16_t* pcm = task->pcm.data();
+        size_t pcm_size = task->pcm.size();
+        for (size_t offset = 0; offset < pcm_size && !playback_flush_pending_; offset += dma_frame_num) {
+            codec_->OutputData(pcm + offset, std::min(dma_frame_num, pcm_size - offset));
+        }
+        io_lock.unlock();
 
         /* Update the last output time */
         last_output_time_ = std::chrono::steady_clock::now();
@@ -290,7 +332,7 @@ void AudioService::AudioOutputTask() {
 
 #if CONFIG_USE_SERVER_AEC
         /* Record the timestamp for server AEC */
-        if (task->timestamp > 0) {
+        if (task->timestamp > 0 && !playback_flush_pending_) {
             lock.lock();
             timestamp_queue_.push_back(task->timestamp);
         }
@@ -300,42 +342,228 @@ void AudioService::AudioOutputTask() {
     ESP_LOGW(TAG, "Audio output task stopped");
 }
 
+void AudioService::FlushPlayback(int64_t trigger_time_us) {
+    std::lock_guard<std::mutex> lock(audio_queue_mutex_);
+    flush_trigger_time_us_ = trigger_time_us > 0 ? trigger_time_us : esp_timer_get_time();
+    playback_generation_++;
+    decoder_reset_pending_ = true;
+    audio_decode_queue_.clear();
+    audio_playback_queue_.clear();
+    timestamp_queue_.clear();
+    playback_flush_pending_ = true;
+    audio_queue_cv_.notify_all();
+}
+
+// 在输出任务中执行，避免与正在进行的 I2S 写入并发
+void AudioService::FinishPlaybackFlush() {
+    {
+        std::lock_guard<std::mutex> io_lock(codec_output_mutex_);
+        codec_->FlushOutput();
+    }
+
+    std::lock_guard<std::mutex> lock(audio_queue_mutex_);
+    playback_flush_pending_ = false;
+    uint32_t latency_ms = (esp_timer_get_time() - flush_trigger_time_us_) / 1000;
+    barge_in_statistics_.count++;
+    barge_in_statistics_.last_latency_ms = latency_ms;
+    barge_in_statistics_.max_latency_ms = std::max(barge_in_statistics_.max_latency_ms, latency_ms);
+    barge_in_statistics_.total_latency_ms += latency_ms;
+    ESP_LOGI(TAG, "Playback flushed, silence after %lu ms (max %lu ms)", (unsigned long)latency_ms,
+        (unsigned long)barge_in_statistics_.max_latency_ms);
+}
+
+bool AudioService::ConfigureAudioDebugger(const std::string& taps, const std::string& codec) {
+    if (audio_debugger_ == nullptr) {
+        return false;
+    }
+    audio_debugger_->Configure(AudioDebugger::ParseTaps(taps), codec == "adpcm" ? kAudioDebugCodecAdpcm : kAudioDebugCodecPcm);
+    return true;
+}
+
+std::string AudioService::GetAudioDebuggerStatus() {
+    if (audio_debugger_ == nullptr) {
+        return "{\"enabled\":false}";
+    }
+    return audio_debugger_->GetStatusJson();
+}
+
+BargeInStatistics AudioService::GetBargeInStatistics() {
+    std::lock_guard<std::mutex> lock(audio_queue_mutex_);
+    return barge_in_statistics_;
+}
+
+float AudioLevel::RmsDbfs() const {
+    if (rms == 0) {
+        return -96.0f;
+    }
+    return std::max(-96.0f, 20.0f * log10f(rms / 32768.0f));
+}
+
+int AudioLevel::Percent() const {
+    return std::max(0, std::min(100, (int)((RmsDbfs() + 60.0f) * 100.0f / 60.0f)));
+}
+
+// 只统计每帧第一个通道，顺带在已有的数据搬运之后做一次遍历
+void AudioService::UpdateAudioLevel(LevelSlot& level, const int16_t* data, size_t samples, int channels) {
+    size_t frames = samples / channels;
+    if (frames == 0) {
+        return;
+    }
+    uint64_t sum = 0;
+    int peak = 0;
+    for (size_t i = 0; i < samples; i += channels) {
+        int sample = data[i];
+        sum += sample * sample;
+        peak = std::max(peak, std::abs(sample));
+    }
+    uint32_t rms = std::min<uint32_t>(32767, sqrtf((float)sum / frames));
+    uint32_t now_ms = esp_timer_get_time() / 1000;
+    level.value = rms | ((uint32_t)std::min(peak, 32767) << 16);
+    level.time_ms = now_ms;
+
+#if CONFIG_AUDIO_LEVEL_EVENT_INTERVAL_MS > 0
+    // 限制事件频率，两路音量合并在一个事件里
+    uint32_t last = last_level_event_ms_;
+    if (now_ms - last >= CONFIG_AUDIO_LEVEL_EVENT_INTERVAL_MS && last_level_event_ms_.compare_exchange_strong(last, now_ms)) {
+        auto levels = GetAudioLevels();
+        DeviceEvent event(kDeviceEventAudioLevel);
+        event.audio_level.input_dbfs = levels.input.RmsDbfs();
+        event.audio_level.output_dbfs = levels.output.RmsDbfs();
+        EventBus::GetInstance().Post(event);
+    }
+#endif
+}
+
+AudioLevels AudioService::GetAudioLevels() const {
+    uint32_t now_ms = esp_timer_get_time() / 1000;
+    auto unpack = [now_ms](const LevelSlot& slot) {
+        AudioLevel level;
+        if (now_ms - slot.time_ms.load() <= AUDIO_LEVEL_STALE_MS) {
+            uint32_t value = slot.value;
+            level.rms = value & 0xFFFF;
+            level.peak = (value >> 16) & 0xFFFF;
+        }
+        return level;
+    };
+    AudioLevels levels;
+    levels.input = unpack(input_level_);
+    levels.output = unpack(output_level_);
+    return levels;
+}
+
+bool AudioService::SetDmaProfile(AudioDmaProfile profile) {
+    // 不支持切换的编解码器直接返回，不必在每次状态切换时停下输入输出
+    if (codec_ == nullptr || !codec_->SupportsDmaProfiles()) {
+        return false;
+    }
+    if (codec_->dma_profile() == profile) {
+        return true;
+    }
+    std::scoped_lock io_lock(codec_input_mutex_, codec_output_mutex_);
+    UpdateDmaProfileStatistics();
+    auto previous = codec_->dma_profile();
+    auto start_time = esp_timer_get_time();
+    if (!codec_->SetDmaProfile(profile)) {
+        return false;
+    }
+
+    std::lock_guard<std::mutex> lock(dma_statistics_mutex_);
+    // 重建通道的耗时不计入任何配置
+    dma_profile_start_time_us_ = esp_timer_get_time();
+    dma_profile_start_interrupts_ = codec_->dma_interrupt_count();
+    auto& stats = dma_profile_statistics_[codec_->dma_profile()];
+    stats.switches++;
+    stats.buffer_latency_ms = codec_->dma_desc_num() * codec_->dma_frame_num() * 1000 / codec_->output_sample_rate();
+    auto& last = dma_profile_statistics_[previous];
+    ESP_LOGI(TAG, "DMA profile %d -> %d in %ld us, buffer %lu ms, previous profile %lu irq/s",
+        previous, codec_->dma_profile(), (long)(dma_profile_start_time_us_ - start_time),
+        (unsigned long)stats.buffer_latency_ms, (unsigned long)last.InterruptsPerSecond());
+    return true;
+}
+
+// 把当前配置从上次统计以来的时长和中断数累加进去
+void AudioService::UpdateDmaProfileStatistics() {
+    std::lock_guard<std::mutex> lock(dma_statistics_mutex_);
+    auto now = esp_timer_get_time();
+    uint32_t interrupts = codec_->dma_interrupt_count();
+    auto& stats = dma_profile_statistics_[codec_->dma_profile()];
+    if (dma_profile_start_time_us_ > 0) {
+        stats.active_ms += (now - dma_profile_start_time_us_) / 1000;
+        stats.interrupts += interrupts - dma_profile_start_interrupts_;
+    } else {
+        stats.buffer_latency_ms = codec_->dma_desc_num() * codec_->dma_frame_num() * 1000 / codec_->output_sample_rate();
+    }
+    dma_profile_start_time_us_ = now;
+    dma_profile_start_interrupts_ = interrupts;
+}
+
+std::vector<DmaProfileStatistics> AudioService::GetDmaProfileStatistics() {
+    UpdateDmaProfileStatistics();
+    std::lock_guard<std::mutex> lock(dma_statistics_mutex_);
+    return std::vector<DmaProfileStatistics>(std::begin(dma_profile_statistics_), std::end(dma_profile_statistics_));
+}
+
 void AudioService::OpusCodecTask() {
     while (true) {
         std::unique_lock<std::mutex> lock(audio_queue_mutex_);
         audio_queue_cv_.wait(lock, [this]() {
-            return service_stopped_ ||
-                (!audio_encode_queue_.empty() && audio_send_queue_.size() < MAX_SEND_PACKETS_IN_QUEUE) ||
+            return service_stopped_ || decoder_trim_pending_ ||
+                !audio_encode_queue_.empty() ||
                 (!audio_decode_queue_.empty() && audio_playback_queue_.size() < MAX_PLAYBACK_TASKS_IN_QUEUE);
         });
         if (service_stopped_) {
             break;
         }
 
+        // 解码器池只在本任务中访问，在这里释放
+        if (decoder_trim_pending_) {
+            decoder_trimmed_ = 0;
+            while (decoder_pool_.size() > 1) {
+                decoder_pool_.pop_back();
+                decoder_trimmed_++;
+            }
+            decoder_trim_pending_ = false;
+            audio_queue_cv_.notify_all();
+        }
+
         /* Decode the audio from decode queue */
         if (!audio_decode_queue_.empty() && audio_playback_queue_.size() < MAX_PLAYBACK_TASKS_IN_QUEUE) {
             auto packet = std::move(audio_decode_queue_.front());
             audio_decode_queue_.pop_front();
             audio_queue_cv_.notify_all();
+            uint32_t generation = playback_generation_;
+            bool reset_decoders = decoder_reset_pending_;
+            decoder_reset_pending_ = false;
             lock.unlock();
 
             auto task = std::make_unique<AudioTask>();
             task->type = kAudioTaskTypeDecodeToPlaybackQueue;
             task->timestamp = packet->timestamp;
 
-            SetDecodeSampleRate(packet->sample_rate, packet->frame_duration);
-            if (opus_decoder_->Decode(std::move(packet->payload), task->pcm)) {
+            if (reset_decoders) {
+                for (auto& slot : decoder_pool_) {
+                    slot.decoder->ResetState();
+                }
+            }
+            auto& slot = SetDecodeSampleRate(packet->sample_rate, packet->frame_duration);
+            if (slot.decoder->Decode(std::move(packet->payload), task->pcm)) {
+#if CONFIG_USE_AUDIO_DEBUGGER
+                audio_debugger_->Feed(kAudioDebugTapDownlink, task->pcm.data(), task->pcm.size(), 1, packet->sample_rate);
+#endif
                 // Resample if the sample rate is different
-                if (opus_decoder_->sample_rate() != codec_->output_sample_rate()) {
-                    int target_size = output_resampler_.GetOutputSamples(task->pcm.size());
+                if (slot.resampler) {
+                    int target_size = slot.resampler->GetOutputSamples(task->pcm.size());
                     std::vector<int16_t> resampled(target_size);
-                    output_resampler_.Process(task->pcm.data(), task->pcm.size(), resampled.data());
+                    slot.resampler->Process(task->pcm.data(), task->pcm.size(), resampled.data());
                     task->pcm = std::move(resampled);
                 }
 
                 lock.lock();
-                audio_playback_queue_.push_back(std::move(task));
-                audio_queue_cv_.notify_all();
+                // 解码期间发生了打断，丢弃这一帧
+                if (generation == playback_generation_) {
+                    audio_playback_queue_.push_back(std::move(task));
+                    audio_queue_cv_.notify_all();
+                }
             } else {
                 ESP_LOGE(TAG, "Failed to decode audio");
                 lock.lock();
@@ -344,12 +572,24 @@ void AudioService::OpusCodecTask() {
         }
         
         /* Encode the audio to send queue */
-        if (!audio_encode_queue_.empty() && audio_send_queue_.size() < MAX_SEND_PACKETS_IN_QUEUE) {
+        if (!audio_encode_queue_.empty()) {
             auto task = std::move(audio_encode_queue_.front());
             audio_encode_queue_.pop_front();
             audio_queue_cv_.notify_all();
+            // 发送队列满时不再停止编码（那样会反压到采集任务），而是按策略丢帧
+            if (task->type == kAudioTaskTypeEncodeToSendQueue && !ApplyUplinkOverloadPolicy(*task)) {
+                continue;
+            }
             lock.unlock();
 
+            // 编码器只在本任务中访问，因此在这里切换 DTX，链路差或上行拥塞时静音帧不再占用带宽
+            bool dtx = poor_link_ || uplink_congested_;
+            if (dtx_enabled_ != dtx) {
+                dtx_enabled_ = dtx;
+                opus_encoder_->SetDtx(dtx_enabled_);
+                ESP_LOGI(TAG, "Opus DTX %s", dtx_enabled_ ? "enabled" : "disabled");
+            }
+
             auto packet = std::make_unique<AudioStreamPacket>();
             packet->frame_duration = OPUS_FRAME_DURATION_MS;
             packet->sample_rate = 16000;
@@ -379,19 +619,35 @@ void AudioService::OpusCodecTask() {
     ESP_LOGW(TAG, "Opus codec task stopped");
 }
 
-void AudioService::SetDecodeSampleRate(int sample_rate, int frame_duration) {
-    if (opus_decoder_->sample_rate() == sample_rate && opus_decoder_->duration_ms() == frame_duration) {
-        return;
+DecoderSlot AudioService::CreateDecoderSlot(int sample_rate, int frame_duration) {
+    DecoderSlot slot;
+    slot.decoder = std::make_unique<OpusDecoderWrapper>(sample_rate, 1, frame_duration);
+    if (sample_rate != codec_->output_sample_rate()) {
+        slot.resampler = std::make_unique<OpusResampler>();
+        slot.resampler->Configure(sample_rate, codec_->output_sample_rate());
     }
+    return slot;
+}
 
-    opus_decoder_.reset();
-    opus_decoder_ = std::make_unique<OpusDecoderWrapper>(sample_rate, 1, frame_duration);
+// 只在编解码任务中调用。各路流的解码器常驻池中，切换时不再销毁重建，也不会丢失解码状态
+DecoderSlot& AudioService::SetDecodeSampleRate(int sample_rate, int frame_duration) {
+    auto it = std::find_if(decoder_pool_.begin(), decoder_pool_.end(), [=](const DecoderSlot& slot) {
+        return slot.decoder->sample_rate() == sample_rate && slot.decoder->duration_ms() == frame_duration;
+    });
+    if (it != decoder_pool_.end()) {
+        if (it != decoder_pool_.begin()) {
+            decoder_pool_.splice(decoder_pool_.begin(), decoder_pool_, it);
+        }
+        return decoder_pool_.front();
+    }
 
-    auto codec = Board::GetInstance().GetAudioCodec();
-    if (opus_decoder_->sample_rate() != codec->output_sample_rate()) {
-        ESP_LOGI(TAG, "Resampling audio from %d to %d", opus_decoder_->sample_rate(), codec->output_sample_rate());
-        output_resampler_.Configure(opus_decoder_->sample_rate(), codec->output_sample_rate());
+    if (decoder_pool_.size() >= MAX_DECODERS_IN_POOL) {
+        decoder_pool_.pop_back();
     }
+    ESP_LOGI(TAG, "Create decoder for %d Hz / %d ms%s", sample_rate, frame_duration,
+        sample_rate != codec_->output_sample_rate() ? ", resampling to output rate" : "");
+    decoder_pool_.push_front(CreateDecoderSlot(sample_rate, frame_duration));
+    return decoder_pool_.front();
 }
 
 void AudioService::PushTaskToEncodeQueue(AudioTaskType type, std::vector<int16_t>&& pcm) {
@@ -412,11 +668,58 @@ void AudioService::PushTaskToEncodeQueue(AudioTaskType type, std::vector<int16_t
         timestamp_queue_.pop_front();
     }
 
-    audio_queue_cv_.wait(lock, [this]() { return audio_encode_queue_.size() < MAX_ENCODE_TASKS_IN_QUEUE; });
+#if CONFIG_USE_AUDIO_PROCESSOR
+    task->voice = voice_detected_;
+#endif
+
+    // 采集任务不能阻塞，否则 I2S DMA 溢出并打乱 AFE 的时间线；编码跟不上时丢弃最旧的帧
+    if (audio_encode_queue_.size() >= MAX_ENCODE_TASKS_IN_QUEUE) {
+        audio_encode_queue_.pop_front();
+        if (uplink_drop_statistics_.encode_queue_full++ % 50 == 0) {
+            ESP_LOGW(TAG, "Encode queue is full, dropped %lu frames", uplink_drop_statistics_.encode_queue_full);
+        }
+    }
     audio_encode_queue_.push_back(std::move(task));
     audio_queue_cv_.notify_all();
 }
 
+/*
+ * 在持有 audio_queue_mutex_ 时调用。发送队列满时按配置的策略腾出空间：
+ * - 丢弃最旧：移除队首的包，保证发送的是最新的语音
+ * - 静音优先：新帧为静音时直接丢弃，是语音时才移除最旧的包
+ * 返回 false 表示丢弃当前帧，不再编码。
+ */
+bool AudioService::ApplyUplinkOverloadPolicy(const AudioTask& task) {
+    if (audio_send_queue_.size() < MAX_SEND_PACKETS_IN_QUEUE) {
+        if (uplink_congested_ && audio_send_queue_.size() < MAX_SEND_PACKETS_IN_QUEUE / 2) {
+            uplink_congested_ = false;
+            ESP_LOGI(TAG, "Uplink congestion cleared");
+        }
+        return true;
+    }
+
+    if (!uplink_congested_) {
+        uplink_congested_ = true;
+        uplink_drop_statistics_.congestion_events++;
+        ESP_LOGW(TAG, "Uplink congested, send queue is full");
+    }
+
+#if CONFIG_UPLINK_DROP_SILENCE_FIRST
+    if (!task.voice) {
+        uplink_drop_statistics_.send_queue_silence++;
+        return false;
+    }
+#endif
+    audio_send_queue_.pop_front();
+    uplink_drop_statistics_.send_queue_oldest++;
+    return true;
+}
+
+UplinkDropStatistics AudioService::GetUplinkDropStatistics() {
+    std::lock_guard<std::mutex> lock(audio_queue_mutex_);
+    return uplink_drop_statistics_;
+}
+
 bool AudioService::PushPacketToDecodeQueue(std::unique_ptr<AudioStreamPacket> packet, bool wait) {
     std::unique_lock<std::mutex> lock(audio_queue_mutex_);
     if (audio_decode_queue_.size() >= MAX_DECODE_PACKETS_IN_QUEUE) {
@@ -489,12 +792,22 @@ void AudioService::EnableVoiceProcessing(bool enable) {
 
         /* We should make sure no audio is playing */
         ResetDecoder();
+        {
+            std::lock_guard<std::mutex> lock(audio_queue_mutex_);
+            uplink_drop_statistics_ = UplinkDropStatistics();
+            uplink_congested_ = false;
+        }
         audio_input_need_warmup_ = true;
         audio_processor_->Start();
         xEventGroupSetBits(event_group_, AS_EVENT_AUDIO_PROCESSOR_RUNNING);
     } else {
         audio_processor_->Stop();
         xEventGroupClearBits(event_group_, AS_EVENT_AUDIO_PROCESSOR_RUNNING);
+        auto stats = GetUplinkDropStatistics();
+        if (stats.encode_queue_full + stats.send_queue_oldest + stats.send_queue_silence > 0) {
+            ESP_LOGW(TAG, "Uplink drops: encode_queue_full=%lu send_queue_oldest=%lu send_queue_silence=%lu congestion_events=%lu",
+                stats.encode_queue_full, stats.send_queue_oldest, stats.send_queue_silence, stats.congestion_events);
+        }
     }
 }
 
@@ -516,6 +829,33 @@ void AudioService::EnableDeviceAec(bool enable) {
     audio_processor_->EnableDeviceAec(enable);
 }
 
+void AudioService::EnableLocalCommands(bool enable) {
+#if CONFIG_USE_LOCAL_COMMANDS
+    if (enable && !command_recognizer_initialized_) {
+        command_recognizer_initialized_ = true;
+        command_recognizer_ = std::make_unique<AfeCommandRecognizer>();
+        if (!command_recognizer_->Initialize(codec_)) {
+            command_recognizer_.reset();
+            return;
+        }
+        command_recognizer_->OnCommand([this](const std::string& action, int64_t capture_time_us) {
+            if (callbacks_.on_local_command) {
+                callbacks_.on_local_command(action, capture_time_us);
+            }
+        });
+    }
+    if (!command_recognizer_) {
+        return;
+    }
+    ESP_LOGD(TAG, "%s local commands", enable ? "Enabling" : "Disabling");
+    if (enable) {
+        command_recognizer_->Start();
+    } else {
+        command_recognizer_->Stop();
+    }
+#endif
+}
+
 void AudioService::SetCallbacks(AudioServiceCallbacks& callbacks) {
     callbacks_ = callbacks;
 }
@@ -544,9 +884,23 @@ bool AudioService::IsIdle() {
     return audio_encode_queue_.empty() && audio_decode_queue_.empty() && audio_playback_queue_.empty() && audio_testing_queue_.empty();
 }
 
+int AudioService::TrimDecoderPool() {
+    std::unique_lock<std::mutex> lock(audio_queue_mutex_);
+    decoder_trim_pending_ = true;
+    audio_queue_cv_.notify_all();
+    if (!audio_queue_cv_.wait_for(lock, std::chrono::milliseconds(500), [this]() { return !decoder_trim_pending_; })) {
+        ESP_LOGW(TAG, "Timeout waiting for decoder pool trim");
+        return 0;
+    }
+    if (decoder_trimmed_ > 0) {
+        ESP_LOGI(TAG, "Released %d idle decoders", decoder_trimmed_);
+    }
+    return decoder_trimmed_;
+}
+
 void AudioService::ResetDecoder() {
     std::lock_guard<std::mutex> lock(audio_queue_mutex_);
-    opus_decoder_->ResetState();
+    decoder_reset_pending_ = true;
     timestamp_queue_.clear();
     audio_decode_queue_.clear();
     audio_playback_queue_.clear();
@@ -554,17 +908,31 @@ void AudioService::ResetDecoder() {
     audio_queue_cv_.notify_all();
 }
 
+void AudioService::SetLinkQuality(LinkQualityLevel level) {
+    poor_link_ = level == kLinkQualityPoor;
+}
+
 void AudioService::CheckAndUpdateAudioPowerState() {
     auto now = std::chrono::steady_clock::now();
     auto input_elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(now - last_input_time_).count();
     auto output_elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(now - last_output_time_).count();
-    if (input_elapsed > AUDIO_POWER_TIMEOUT_MS && codec_->input_enabled()) {
-        codec_->EnableInput(false);
+    // 开关状态在锁内读取，避免与输入输出任务中的打开操作交错
+    bool input_enabled, output_enabled;
+    {
+        std::lock_guard<std::mutex> io_lock(codec_input_mutex_);
+        if (input_elapsed > AUDIO_POWER_TIMEOUT_MS && codec_->input_enabled()) {
+            codec_->EnableInput(false);
+        }
+        input_enabled = codec_->input_enabled();
     }
-    if (output_elapsed > AUDIO_POWER_TIMEOUT_MS && codec_->output_enabled()) {
-        codec_->EnableOutput(false);
+    {
+        std::lock_guard<std::mutex> io_lock(codec_output_mutex_);
+        if (output_elapsed > AUDIO_POWER_TIMEOUT_MS && codec_->output_enabled()) {
+            codec_->EnableOutput(false);
+        }
+        output_enabled = codec_->output_enabled();
     }
-    if (!codec_->input_enabled() && !codec_->output_enabled()) {
+    if (!input_enabled && !output_enabled) {
         esp_timer_stop(audio_power_timer_);
     }
 }
\ No newline at end of file
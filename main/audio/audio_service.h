@@ -3,9 +3,11 @@
 
 #include <memory>
 #include <deque>
+#include <list>
 #include <condition_variable>
 #include <chrono>
 #include <mutex>
+#include <atomic>
 
 #include <freertos/FreeRTOS.h>
 #include <freertos/task.h>
@@ -22,6 +24,10 @@
 #include "wake_word.h"
 #include "protocol.h"
 
+#if CONFIG_USE_LOCAL_COMMANDS
+#include "processors/afe_command_recognizer.h"
+#endif
+
 
 /*
  * There are two types of audio data flow:
@@ -41,6 +47,13 @@
 #define MAX_SEND_PACKETS_IN_QUEUE (2400 / OPUS_FRAME_DURATION_MS)
 #define AUDIO_TESTING_MAX_DURATION_MS 10000
 #define MAX_TIMESTAMPS_IN_QUEUE 3
+#if CONFIG_SPIRAM
+#define MAX_DECODERS_IN_POOL 4
+#else
+#define MAX_DECODERS_IN_POOL 2
+#endif
+
+#define AUDIO_LEVEL_STALE_MS 200
 
 #define AUDIO_POWER_TIMEOUT_MS 15000
 #define AUDIO_POWER_CHECK_INTERVAL_MS 1000
@@ -56,6 +69,7 @@ struct AudioServiceCallbacks {
     std::function<void(const std::string&)> on_wake_word_detected;
     std::function<void(bool)> on_vad_change;
     std::function<void(void)> on_audio_testing_queue_full;
+    std::function<void(const std::string&, int64_t capture_time_us)> on_local_command;
 };
 
 
@@ -69,6 +83,7 @@ struct AudioTask {
     AudioTaskType type;
     std::vector<int16_t> pcm;
     uint32_t timestamp;
+    bool voice = true;  // 采集时的 VAD 状态，拥塞时优先丢弃静音帧
 };
 
 struct DebugStatistics {
@@ -78,6 +93,52 @@ struct DebugStatistics {
     uint32_t playback_count = 0;
 };
 
+// 上行过载时的丢帧计数，按原因分类
+struct UplinkDropStatistics {
+    uint32_t encode_queue_full = 0;   // 编码跟不上采集，丢弃最旧的 PCM 帧
+    uint32_t send_queue_oldest = 0;   // 网络阻塞，丢弃发送队列中最旧的包
+    uint32_t send_queue_silence = 0;  // 网络阻塞，丢弃新编码出的静音帧
+    uint32_t congestion_events = 0;   // 进入拥塞状态的次数
+};
+
+// 打断（barge-in）时从触发到扬声器静音的延迟
+struct BargeInStatistics {
+    uint32_t count = 0;
+    uint32_t last_latency_ms = 0;
+    uint32_t max_latency_ms = 0;
+    uint32_t total_latency_ms = 0;
+};
+
+// 各 DMA 配置下的缓冲延迟和实测中断频率
+struct DmaProfileStatistics {
+    uint32_t switches = 0;          // 切换到该配置的次数
+    uint32_t buffer_latency_ms = 0; // 单向 DMA 缓冲延迟：描述符数 × 帧数 / 采样率
+    uint64_t active_ms = 0;         // 累计处于该配置的时间
+    uint64_t interrupts = 0;        // 累计 DMA 中断次数（收发合计）
+
+    uint32_t InterruptsPerSecond() const { return active_ms > 0 ? interrupts * 1000 / active_ms : 0; }
+};
+
+// 最近一帧的音量，幅度为 0~32767 的线性值；超过 AUDIO_LEVEL_STALE_MS 未更新时为 0
+struct AudioLevel {
+    uint16_t rms = 0;
+    uint16_t peak = 0;
+
+    float RmsDbfs() const;      // 静音时为 -96
+    int Percent() const;        // -60dBFS~0dBFS 映射到 0~100，便于灯效和动画使用
+};
+
+struct AudioLevels {
+    AudioLevel input;           // 麦克风（不含参考通道）
+    AudioLevel output;          // 扬声器
+};
+
+// 一路下行音频流（采样率 + 帧长）对应的解码器和重采样器
+struct DecoderSlot {
+    std::unique_ptr<OpusDecoderWrapper> decoder;
+    std::unique_ptr<OpusResampler> resampler;   // 采样率与输出一致时为空
+};
+
 class AudioService {
 public:
     AudioService();
@@ -98,6 +159,7 @@ public:
     void EnableVoiceProcessing(bool enable);
     void EnableAudioTesting(bool enable);
     void EnableDeviceAec(bool enable);
+    void EnableLocalCommands(bool enable);
 
     void SetCallbacks(AudioServiceCallbacks& callbacks);
 
@@ -106,6 +168,22 @@ public:
     void PlaySound(const std::string_view& sound);
     bool ReadAudioData(std::vector<int16_t>& data, int sample_rate, int samples);
     void ResetDecoder();
+    // 内存紧张时释放池中除当前解码器外的解码器，等待编解码任务处理，返回释放的个数
+    int TrimDecoderPool();
+    // 立即清空解码、播放队列和 I2S DMA 缓冲区；trigger_time_us 为触发时刻（如唤醒词检测时刻），用于统计静音延迟
+    void FlushPlayback(int64_t trigger_time_us = 0);
+    int64_t last_wake_word_time_us() const { return last_wake_word_time_us_; }
+    BargeInStatistics GetBargeInStatistics();
+    // 切换 I2S DMA 配置，等待正在进行的读写完成后再重建通道
+    bool SetDmaProfile(AudioDmaProfile profile);
+    std::vector<DmaProfileStatistics> GetDmaProfileStatistics();
+    // 运行时选择音频调试的采集点（逗号分隔，如 "mic,playback"，空串关闭）和压缩方式（pcm / adpcm）
+    bool ConfigureAudioDebugger(const std::string& taps, const std::string& codec);
+    std::string GetAudioDebuggerStatus();
+    void SetLinkQuality(LinkQualityLevel level);
+    UplinkDropStatistics GetUplinkDropStatistics();
+    // 无锁读取，可在任意任务中频繁调用
+    AudioLevels GetAudioLevels() const;
 
 private:
     AudioCodec* codec_ = nullptr;
@@ -113,12 +191,20 @@ private:
     std::unique_ptr<AudioProcessor> audio_processor_;
     std::unique_ptr<WakeWord> wake_word_;
     std::unique_ptr<AudioDebugger> audio_debugger_;
+#if CONFIG_USE_LOCAL_COMMANDS
+    std::unique_ptr<AfeCommandRecognizer> command_recognizer_;
+    bool command_recognizer_initialized_ = false;
+#endif
     std::unique_ptr<OpusEncoderWrapper> opus_encoder_;
-    std::unique_ptr<OpusDecoderWrapper> opus_decoder_;
+    std::list<DecoderSlot> decoder_pool_;   // 按最近使用排序，front 为当前解码器
     OpusResampler input_resampler_;
     OpusResampler reference_resampler_;
-    OpusResampler output_resampler_;
     DebugStatistics debug_statistics_;
+    UplinkDropStatistics uplink_drop_statistics_;
+    BargeInStatistics barge_in_statistics_;
+    DmaProfileStatistics dma_profile_statistics_[kAudioDmaProfileLowPower + 1];
+    int64_t dma_profile_start_time_us_ = 0;
+    uint32_t dma_profile_start_interrupts_ = 0;
 
     EventGroupHandle_t event_group_;
 
@@ -128,6 +214,10 @@ private:
     TaskHandle_t opus_codec_task_handle_ = nullptr;
     std::mutex audio_queue_mutex_;
     std::condition_variable audio_queue_cv_;
+    // 保护对 codec_ 的读写，切换 DMA 配置时同时持有
+    std::mutex codec_input_mutex_;
+    std::mutex codec_output_mutex_;
+    std::mutex dma_statistics_mutex_;
     std::deque<std::unique_ptr<AudioStreamPacket>> audio_decode_queue_;
     std::deque<std::unique_ptr<AudioStreamPacket>> audio_send_queue_;
     std::deque<std::unique_ptr<AudioStreamPacket>> audio_testing_queue_;
@@ -143,6 +233,27 @@ private:
     bool voice_detected_ = false;
     bool service_stopped_ = true;
     bool audio_input_need_warmup_ = false;
+    std::atomic<bool> poor_link_ = false;   // 由应用层根据链路质量设置，编码任务据此开关 DTX
+    bool uplink_congested_ = false;         // 发送队列满后置位，排空到一半以下时清除
+    bool dtx_enabled_ = false;
+    std::atomic<bool> playback_flush_pending_ = false;  // 由 FlushPlayback 置位，输出任务清空 DMA 后清除
+    bool decoder_reset_pending_ = false;    // 由编码任务在下次解码前重置池中所有解码器
+    bool decoder_trim_pending_ = false;
+    int decoder_trimmed_ = 0;
+    uint32_t playback_generation_ = 0;      // 每次清空加一，丢弃清空前开始解码的帧
+    int64_t flush_trigger_time_us_ = 0;
+    std::atomic<int64_t> last_wake_word_time_us_ = 0;
+    // 每路音量打包为 rms(16) | peak(16)，与更新时间分开存放，都是 32 位原子变量。
+    // ESP32 系列上 64 位原子操作要靠锁实现，不能用于音频任务；两者分开读写时
+    // 最多把刚过期的数值多显示一次，不影响使用
+    struct LevelSlot {
+        std::atomic<uint32_t> value = 0;
+        std::atomic<uint32_t> time_ms = 0;
+    };
+    static_assert(std::atomic<uint32_t>::is_always_lock_free, "audio level atomics must be lock-free");
+    LevelSlot input_level_;
+    LevelSlot output_level_;
+    std::atomic<uint32_t> last_level_event_ms_ = 0;
 
     esp_timer_handle_t audio_power_timer_ = nullptr;
     std::chrono::steady_clock::time_point last_input_time_;
@@ -152,8 +263,13 @@ private:
     void AudioOutputTask();
     void OpusCodecTask();
     void PushTaskToEncodeQueue(AudioTaskType type, std::vector<int16_t>&& pcm);
-    void SetDecodeSampleRate(int sample_rate, int frame_duration);
+    bool ApplyUplinkOverloadPolicy(const AudioTask& task);
+    DecoderSlot& SetDecodeSampleRate(int sample_rate, int frame_duration);
+    DecoderSlot CreateDecoderSlot(int sample_rate, int frame_duration);
+    void FinishPlaybackFlush();
     void CheckAndUpdateAudioPowerState();
+    void UpdateDmaProfileStatistics();
+    void UpdateAudioLevel(LevelSlot& level, const int16_t* data, size_t samples, int channels);
 };
 
 #endif
\ No newline at end of file
@@ -64,7 +64,7 @@ Es8311AudioCodec::~Es8311AudioCodec() {
 }
 
 void Es8311AudioCodec::UpdateDeviceState() {
-    if ((input_enabled_ || output_enabled_) && dev_ == nullptr) {
+    if ((input_enabled_ || output_enabled_) && dev_ == nullptr && data_if_ != nullptr) {
         esp_codec_dev_cfg_t dev_cfg = {
             .dev_type = ESP_CODEC_DEV_TYPE_IN_OUT,
             .codec_if = codec_if_,
@@ -106,6 +106,7 @@ void Es8311AudioCodec::CreateDuplexChannels(gpio_num_t mclk, gpio_num_t bclk, gp
         .intr_priority = 0,
     };
     ESP_ERROR_CHECK(i2s_new_channel(&chan_cfg, &tx_handle_, &rx_handle_));
+    dma_chan_cfg_ = chan_cfg;
 
     i2s_std_config_t std_cfg = {
         .clk_cfg = {
@@ -146,9 +147,41 @@ void Es8311AudioCodec::CreateDuplexChannels(gpio_num_t mclk, gpio_num_t bclk, gp
 
     ESP_ERROR_CHECK(i2s_channel_init_std_mode(tx_handle_, &std_cfg));
     ESP_ERROR_CHECK(i2s_channel_init_std_mode(rx_handle_, &std_cfg));
+    dma_std_cfg_ = std_cfg;
     ESP_LOGI(TAG, "Duplex channels created");
 }
 
+bool Es8311AudioCodec::SetDmaProfile(AudioDmaProfile profile) {
+    if (profile == dma_profile_) {
+        return true;
+    }
+    // data_if 持有通道句柄，需要先关闭设备，重建通道后再按当前输入输出状态重新打开
+    if (dev_ != nullptr) {
+        esp_codec_dev_close(dev_);
+        esp_codec_dev_delete(dev_);
+        dev_ = nullptr;
+    }
+    audio_codec_delete_data_if(data_if_);
+    data_if_ = nullptr;
+
+    bool success = RecreateDuplexChannels(profile) == ESP_OK;
+    if (tx_handle_ == nullptr || rx_handle_ == nullptr) {
+        // 连原配置都无法恢复，保持设备关闭，读写返回失败
+        return false;
+    }
+
+    audio_codec_i2s_cfg_t i2s_cfg = {
+        .port = I2S_NUM_0,
+        .rx_handle = rx_handle_,
+        .tx_handle = tx_handle_,
+    };
+    data_if_ = audio_codec_new_i2s_data(&i2s_cfg);
+    assert(data_if_ != NULL);
+    UpdateDeviceState();
+    ESP_LOGI(TAG, "DMA profile %d: %d x %d frames", dma_profile_, dma_desc_num_, dma_frame_num_);
+    return success;
+}
+
 void Es8311AudioCodec::SetOutputVolume(int volume) {
     ESP_ERROR_CHECK(esp_codec_dev_set_out_vol(dev_, volume));
     AudioCodec::SetOutputVolume(volume);
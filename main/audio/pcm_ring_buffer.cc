@@ -0,0 +1,86 @@
+#include "pcm_ring_buffer.h"
+
+#include <esp_log.h>
+#include <algorithm>
+#include <cstring>
+
+#define TAG "PcmRingBuffer"
+
+PcmRingBuffer::PcmRingBuffer(size_t capacity, MemoryPlacement placement) : capacity_(capacity), placement_(placement) {
+}
+
+PcmRingBuffer::~PcmRingBuffer() {
+    MemoryPolicy::GetInstance().Free(kMemoryTagAudio, data_);
+}
+
+void PcmRingBuffer::SetCapacity(size_t capacity, MemoryPlacement placement) {
+    MemoryPolicy::GetInstance().Free(kMemoryTagAudio, data_);
+    data_ = nullptr;
+    capacity_ = capacity;
+    placement_ = placement;
+    head_ = 0;
+    size_ = 0;
+}
+
+bool PcmRingBuffer::Allocate() {
+    data_ = (int16_t*)MemoryPolicy::GetInstance().Allocate(kMemoryTagAudio, placement_, capacity_ * sizeof(int16_t));
+    if (data_ == nullptr) {
+        ESP_LOGE(TAG, "Failed to allocate %u samples", capacity_);
+        return false;
+    }
+    return true;
+}
+
+size_t PcmRingBuffer::Write(const int16_t* data, size_t samples) {
+    if (capacity_ == 0 || (data_ == nullptr && !Allocate())) {
+        return samples;
+    }
+    // 超过容量时只保留最后 capacity_ 个采样
+    size_t overwritten = 0;
+    if (samples > capacity_) {
+        overwritten = samples - capacity_;
+        data += overwritten;
+        samples = capacity_;
+    }
+    size_t free_space = capacity_ - size_;
+    if (samples > free_space) {
+        size_t drop = samples - free_space;
+        head_ = (head_ + drop) % capacity_;
+        size_ -= drop;
+        overwritten += drop;
+    }
+
+    size_t tail = (head_ + size_) % capacity_;
+    size_t first = std::min(samples, capacity_ - tail);
+    memcpy(data_ + tail, data, first * sizeof(int16_t));
+    memcpy(data_, data + first, (samples - first) * sizeof(int16_t));
+    size_ += samples;
+    return overwritten;
+}
+
+size_t PcmRingBuffer::Read(int16_t* dest, size_t samples) {
+    samples = std::min(samples, size_);
+    if (samples == 0) {
+        return 0;
+    }
+    size_t first = std::min(samples, capacity_ - head_);
+    memcpy(dest, data_ + head_, first * sizeof(int16_t));
+    memcpy(dest + first, data_, (samples - first) * sizeof(int16_t));
+    head_ = (head_ + samples) % capacity_;
+    size_ -= samples;
+    return samples;
+}
+
+bool PcmRingBuffer::ReadFrame(std::vector<int16_t>& frame, size_t frame_samples) {
+    if (size_ < frame_samples) {
+        return false;
+    }
+    frame.resize(frame_samples);
+    Read(frame.data(), frame_samples);
+    return true;
+}
+
+void PcmRingBuffer::Clear() {
+    head_ = 0;
+    size_ = 0;
+}
@@ -0,0 +1,48 @@
+#ifndef PCM_RING_BUFFER_H
+#define PCM_RING_BUFFER_H
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "memory_policy.h"
+
+/*
+ * 固定容量的 PCM 环形缓冲区。
+ * 存储区在首次写入时一次性分配，之后读写只做 memcpy，不会移动已有数据或重新分配。
+ * 写满时覆盖最旧的数据，可直接用作唤醒词前的音频预录缓冲。
+ * 不是线程安全的，由使用者加锁。
+ */
+class PcmRingBuffer {
+public:
+    PcmRingBuffer() = default;
+    PcmRingBuffer(size_t capacity, MemoryPlacement placement = kMemoryPlacementInternal);
+    ~PcmRingBuffer();
+    PcmRingBuffer(const PcmRingBuffer&) = delete;
+    PcmRingBuffer& operator=(const PcmRingBuffer&) = delete;
+
+    // 修改容量会丢弃已有数据，存储区在下次写入时分配
+    void SetCapacity(size_t capacity, MemoryPlacement placement = kMemoryPlacementInternal);
+    // 写满时覆盖最旧的数据，返回被覆盖的采样数
+    size_t Write(const int16_t* data, size_t samples);
+    // 读出并移除最旧的 samples 个采样，返回实际读出的采样数
+    size_t Read(int16_t* dest, size_t samples);
+    // 数据足够一帧时读出一帧，frame 的容量足够时不会重新分配
+    bool ReadFrame(std::vector<int16_t>& frame, size_t frame_samples);
+    void Clear();
+
+    size_t size() const { return size_; }
+    size_t capacity() const { return capacity_; }
+    bool empty() const { return size_ == 0; }
+
+private:
+    int16_t* data_ = nullptr;
+    size_t capacity_ = 0;
+    MemoryPlacement placement_ = kMemoryPlacementInternal;
+    size_t head_ = 0;   // 最旧数据的位置
+    size_t size_ = 0;
+
+    bool Allocate();
+};
+
+#endif // PCM_RING_BUFFER_H
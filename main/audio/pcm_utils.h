@@ -0,0 +1,35 @@
+#ifndef PCM_UTILS_H
+#define PCM_UTILS_H
+
+#include <cstddef>
+#include <cstdint>
+
+/*
+ * 双声道输入（左声道为麦克风，右声道为回采参考）的交织与拆分。
+ * 每次读取音频都会调用，放在头文件中便于内联；不依赖 ESP-IDF，可以在主机上做基准测试
+ */
+
+// 交织的双声道数据拆分为两个单声道，frames 为每个声道的采样数
+inline void DeinterleaveStereo(const int16_t* input, size_t frames, int16_t* left, int16_t* right) {
+    for (size_t i = 0; i < frames; i++) {
+        left[i] = input[i * 2];
+        right[i] = input[i * 2 + 1];
+    }
+}
+
+// 两个单声道合并为交织的双声道数据
+inline void InterleaveStereo(const int16_t* left, const int16_t* right, size_t frames, int16_t* output) {
+    for (size_t i = 0; i < frames; i++) {
+        output[i * 2] = left[i];
+        output[i * 2 + 1] = right[i];
+    }
+}
+
+// 只取左声道，output 可以与 input 相同（原地压缩）
+inline void ExtractLeftChannel(const int16_t* input, size_t frames, int16_t* output) {
+    for (size_t i = 0; i < frames; i++) {
+        output[i] = input[i * 2];
+    }
+}
+
+#endif // PCM_UTILS_H
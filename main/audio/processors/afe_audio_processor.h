@@ -12,6 +12,8 @@
 
 #include "audio_processor.h"
 #include "audio_codec.h"
+#include "afe_pipeline.h"
+#include "pcm_ring_buffer.h"
 
 class AfeAudioProcessor : public AudioProcessor {
 public:
@@ -29,17 +31,14 @@ public:
     void EnableDeviceAec(bool enable) override;
 
 private:
-    EventGroupHandle_t event_group_ = nullptr;
-    esp_afe_sr_iface_t* afe_iface_ = nullptr;
-    esp_afe_sr_data_t* afe_data_ = nullptr;
     std::function<void(std::vector<int16_t>&& data)> output_callback_;
     std::function<void(bool speaking)> vad_state_change_callback_;
     AudioCodec* codec_ = nullptr;
     int frame_samples_ = 0;
     bool is_speaking_ = false;
-    std::vector<int16_t> output_buffer_;
+    PcmRingBuffer output_buffer_;   // 把 AFE 每次 fetch 的数据拼成固定时长的帧
 
-    void AudioProcessorTask();
+    void OnFetch(afe_fetch_result_t* res);
 };
 
 #endif 
\ No newline at end of file
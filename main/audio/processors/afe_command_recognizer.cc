@@ -0,0 +1,110 @@
+#include "afe_command_recognizer.h"
+#include "settings.h"
+
+#include <esp_log.h>
+#include <esp_timer.h>
+#include <model_path.h>
+#include <esp_mn_speech_commands.h>
+#include <sstream>
+
+#define TAG "AfeCommandRecognizer"
+
+// 两条命令之间超过该时间无结果时 multinet 返回超时，清理状态后继续监听
+#define COMMAND_DETECT_TIMEOUT_MS 3000
+#define COMMAND_DETECT_THRESHOLD 0.5f
+
+AfeCommandRecognizer::AfeCommandRecognizer() {
+}
+
+AfeCommandRecognizer::~AfeCommandRecognizer() {
+    if (model_data_ != nullptr) {
+        multinet_->destroy(model_data_);
+    }
+}
+
+bool AfeCommandRecognizer::Initialize(AudioCodec* codec) {
+    auto& pipeline = AfePipeline::GetInstance();
+    if (!pipeline.Initialize(codec)) {
+        return false;
+    }
+
+    char* mn_name = esp_srmodel_filter(pipeline.models(), ESP_MN_PREFIX, ESP_MN_CHINESE);
+    if (mn_name == nullptr) {
+        ESP_LOGE(TAG, "No multinet model found, local commands disabled");
+        return false;
+    }
+    multinet_ = esp_mn_handle_from_name(mn_name);
+    model_data_ = multinet_->create(mn_name, COMMAND_DETECT_TIMEOUT_MS);
+    multinet_->set_det_threshold(model_data_, COMMAND_DETECT_THRESHOLD);
+    if (multinet_->get_samp_chunksize(model_data_) != pipeline.fetch_size()) {
+        ESP_LOGE(TAG, "Multinet chunk size %d does not match AFE fetch size %d",
+            multinet_->get_samp_chunksize(model_data_), pipeline.fetch_size());
+        multinet_->destroy(model_data_);
+        model_data_ = nullptr;
+        return false;
+    }
+
+    Settings settings("commands", false);
+    std::string table = settings.GetString("table", CONFIG_LOCAL_COMMANDS);
+
+    esp_mn_commands_clear();
+    std::stringstream ss(table);
+    std::string entry;
+    while (std::getline(ss, entry, ';')) {
+        auto pos = entry.find(':');
+        if (pos == std::string::npos) {
+            ESP_LOGW(TAG, "Invalid command entry: %s", entry.c_str());
+            continue;
+        }
+        actions_.push_back(entry.substr(pos + 1));
+        // command_id 从 1 开始，对应 actions_ 的下标 + 1
+        esp_mn_commands_add(actions_.size(), entry.substr(0, pos).c_str());
+    }
+    esp_mn_commands_update();
+    multinet_->print_active_speech_commands(model_data_);
+
+    pipeline.OnFetch(kAfeConsumerCommand, [this](afe_fetch_result_t* res) {
+        OnFetch(res);
+    });
+    ESP_LOGI(TAG, "Local commands enabled with %u entries, model: %s", actions_.size(), mn_name);
+    return true;
+}
+
+void AfeCommandRecognizer::OnCommand(std::function<void(const std::string& action, int64_t capture_time_us)> callback) {
+    command_callback_ = callback;
+}
+
+void AfeCommandRecognizer::Start() {
+    if (model_data_ == nullptr) {
+        return;
+    }
+    multinet_->clean(model_data_);
+    AfePipeline::GetInstance().Activate(kAfeConsumerCommand, true);
+}
+
+void AfeCommandRecognizer::Stop() {
+    AfePipeline::GetInstance().Activate(kAfeConsumerCommand, false);
+}
+
+void AfeCommandRecognizer::OnFetch(afe_fetch_result_t* res) {
+    auto start_time = esp_timer_get_time();
+    auto capture_time = AfePipeline::GetInstance().fetch_capture_time_us();
+    esp_mn_state_t mn_state = multinet_->detect(model_data_, res->data);
+    if (mn_state == ESP_MN_STATE_DETECTED) {
+        esp_mn_results_t* mn_result = multinet_->get_results(model_data_);
+        int command_id = mn_result->command_id[0];
+        multinet_->clean(model_data_);
+        if (command_id < 1 || command_id > (int)actions_.size()) {
+            return;
+        }
+        auto& action = actions_[command_id - 1];
+        ESP_LOGI(TAG, "Command detected: %s -> %s, prob=%f, detect %ld us, since capture %ld ms",
+            mn_result->string, action.c_str(), mn_result->prob[0], (long)(esp_timer_get_time() - start_time),
+            (long)((esp_timer_get_time() - capture_time) / 1000));
+        if (command_callback_) {
+            command_callback_(action, capture_time);
+        }
+    } else if (mn_state == ESP_MN_STATE_TIMEOUT) {
+        multinet_->clean(model_data_);
+    }
+}
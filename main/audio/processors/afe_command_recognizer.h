@@ -0,0 +1,39 @@
+#ifndef AFE_COMMAND_RECOGNIZER_H
+#define AFE_COMMAND_RECOGNIZER_H
+
+#include <esp_mn_iface.h>
+#include <esp_mn_models.h>
+
+#include <string>
+#include <vector>
+#include <functional>
+
+#include "audio_codec.h"
+#include "afe_pipeline.h"
+
+/*
+ * 本地命令词识别：在共享 AFE 的输出上运行 multinet，
+ * 识别到命令词后直接回调对应的本地动作，不经过服务器。
+ * 命令表格式为 "拼音:动作;拼音:动作"，默认取自 Kconfig，可通过 NVS 覆盖。
+ */
+class AfeCommandRecognizer {
+public:
+    AfeCommandRecognizer();
+    ~AfeCommandRecognizer();
+
+    bool Initialize(AudioCodec* codec);
+    // capture_time_us 为命令词最后一块音频的采集时间，用于统计端到端延迟
+    void OnCommand(std::function<void(const std::string& action, int64_t capture_time_us)> callback);
+    void Start();
+    void Stop();
+
+private:
+    esp_mn_iface_t* multinet_ = nullptr;
+    model_iface_data_t* model_data_ = nullptr;
+    std::vector<std::string> actions_;
+    std::function<void(const std::string& action, int64_t capture_time_us)> command_callback_;
+
+    void OnFetch(afe_fetch_result_t* res);
+};
+
+#endif
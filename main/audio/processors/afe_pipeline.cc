@@ -0,0 +1,250 @@
+#include "afe_pipeline.h"
+#include <esp_log.h>
+#include <esp_timer.h>
+#include <model_path.h>
+#include <cstring>
+#include <sstream>
+
+#define TAG "AfePipeline"
+
+// multinet 命令词识别在 fetch 任务中运行，需要更大的栈
+#if CONFIG_USE_LOCAL_COMMANDS
+#define AFE_FETCH_TASK_STACK_SIZE 16384
+#else
+#define AFE_FETCH_TASK_STACK_SIZE 4096
+#endif
+
+AfePipeline::AfePipeline() {
+    event_group_ = xEventGroupCreate();
+}
+
+AfePipeline::~AfePipeline() {
+    if (afe_data_ != nullptr) {
+        afe_iface_->destroy(afe_data_);
+    }
+    vEventGroupDelete(event_group_);
+}
+
+bool AfePipeline::Initialize(AudioCodec* codec) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (afe_data_ != nullptr) {
+        return true;
+    }
+    codec_ = codec;
+    int ref_num = codec_->input_reference() ? 1 : 0;
+
+    std::string input_format;
+    for (int i = 0; i < codec_->input_channels() - ref_num; i++) {
+        input_format.push_back('M');
+    }
+    for (int i = 0; i < ref_num; i++) {
+        input_format.push_back('R');
+    }
+
+    srmodel_list_t *models = esp_srmodel_init("model");
+    models_ = models;
+
+#if CONFIG_USE_AFE_WAKE_WORD
+    if (models == nullptr || models->num == -1) {
+        ESP_LOGE(TAG, "Failed to initialize wakenet model");
+        return false;
+    }
+    for (int i = 0; i < models->num; i++) {
+        ESP_LOGI(TAG, "Model %d: %s", i, models->model_name[i]);
+        if (strstr(models->model_name[i], ESP_WN_PREFIX) != NULL) {
+            auto words = esp_srmodel_get_wake_words(models, models->model_name[i]);
+            // split by ";" to get all wake words
+            std::stringstream ss(words);
+            std::string word;
+            while (std::getline(ss, word, ';')) {
+                wake_words_.push_back(word);
+            }
+        }
+    }
+#if CONFIG_USE_DEVICE_AEC
+    // 设备端 AEC 的通话回声消除依赖 VC 类型与 VOIP 模式，wakenet 跟随同一条流水线
+    afe_config_t* afe_config = afe_config_init(input_format.c_str(), models, AFE_TYPE_VC, AFE_MODE_HIGH_PERF);
+    afe_config->aec_mode = AEC_MODE_VOIP_HIGH_PERF;
+#else
+    // 有唤醒词时使用 SR 类型，wakenet 与语音通话所需的 VAD/NS 在同一条流水线上
+    afe_config_t* afe_config = afe_config_init(input_format.c_str(), models, AFE_TYPE_SR, AFE_MODE_HIGH_PERF);
+    afe_config->aec_mode = AEC_MODE_SR_HIGH_PERF;
+#endif
+    wakenet_init_ = afe_config->wakenet_init;
+#else
+    afe_config_t* afe_config = afe_config_init(input_format.c_str(), NULL, AFE_TYPE_VC, AFE_MODE_HIGH_PERF);
+    afe_config->aec_mode = AEC_MODE_VOIP_HIGH_PERF;
+    afe_config->wakenet_init = false;
+#endif
+
+#if CONFIG_USE_AUDIO_PROCESSOR
+    char* ns_model_name = esp_srmodel_filter(models, ESP_NSNET_PREFIX, NULL);
+    char* vad_model_name = esp_srmodel_filter(models, ESP_VADN_PREFIX, NULL);
+    afe_config->vad_mode = VAD_MODE_0;
+    afe_config->vad_min_noise_ms = 100;
+    if (vad_model_name != nullptr) {
+        afe_config->vad_model_name = vad_model_name;
+    }
+    if (ns_model_name != nullptr) {
+        afe_config->ns_init = true;
+        afe_config->ns_model_name = ns_model_name;
+        afe_config->afe_ns_mode = AFE_NS_MODE_NET;
+    } else {
+        afe_config->ns_init = false;
+    }
+    afe_config->vad_init = true;
+#else
+    afe_config->vad_init = false;
+    afe_config->ns_init = false;
+#endif
+
+    // 唤醒词使用参考通道做 AEC，设备端 AEC 也需要 AEC 模块；是否生效由 ApplyMode 决定
+#ifdef CONFIG_USE_DEVICE_AEC
+    afe_config->aec_init = true;
+#else
+    afe_config->aec_init = codec_->input_reference() && wakenet_init_;
+#endif
+    afe_config->afe_perferred_core = 1;
+    afe_config->afe_perferred_priority = 1;
+    afe_config->agc_init = false;
+    afe_config->memory_alloc_mode = AFE_MEMORY_ALLOC_MORE_PSRAM;
+
+    vad_init_ = afe_config->vad_init;
+    ns_init_ = afe_config->ns_init;
+    aec_init_ = afe_config->aec_init;
+
+    afe_iface_ = esp_afe_handle_from_config(afe_config);
+    afe_data_ = afe_iface_->create_from_config(afe_config);
+    ApplyMode(0);
+
+    xTaskCreate([](void* arg) {
+        auto this_ = (AfePipeline*)arg;
+        this_->FetchTask();
+        vTaskDelete(NULL);
+    }, "audio_afe", AFE_FETCH_TASK_STACK_SIZE, this, 3, NULL);
+    return true;
+}
+
+size_t AfePipeline::GetFeedSize() {
+    if (afe_data_ == nullptr) {
+        return 0;
+    }
+    return afe_iface_->get_feed_chunksize(afe_data_) * codec_->input_channels();
+}
+
+void AfePipeline::Feed(const int16_t* data) {
+    if (afe_data_ == nullptr) {
+        return;
+    }
+    uint32_t index = feed_count_;
+    feed_times_us_[index % AFE_FEED_TIME_SLOTS] = esp_timer_get_time();
+    feed_count_ = index + 1;
+    afe_iface_->feed(afe_data_, data);
+}
+
+void AfePipeline::OnFetch(AfeConsumer consumer, std::function<void(afe_fetch_result_t* result)> callback) {
+    if (consumer == kAfeConsumerWakeWord) {
+        wake_word_callback_ = callback;
+    } else if (consumer == kAfeConsumerVoice) {
+        voice_callback_ = callback;
+    } else {
+        command_callback_ = callback;
+    }
+}
+
+void AfePipeline::Activate(AfeConsumer consumer, bool active) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    EventBits_t bits = xEventGroupGetBits(event_group_);
+    EventBits_t new_bits = active ? (bits | consumer) : (bits & ~consumer);
+    if (new_bits == bits || afe_data_ == nullptr) {
+        return;
+    }
+    if (active) {
+        xEventGroupSetBits(event_group_, consumer);
+    } else {
+        xEventGroupClearBits(event_group_, consumer);
+    }
+    ApplyMode(new_bits);
+    // 没有任何使用者时清空缓冲区，避免下次启动时取到陈旧的音频
+    if (new_bits == 0) {
+        afe_iface_->reset_buffer(afe_data_);
+        // fetched_samples_ 只在 fetch 任务中修改，这里只记录重置时的送入位置
+        resync_feed_count_ = feed_count_.load();
+        fetch_resync_ = true;
+    }
+}
+
+bool AfePipeline::IsActive(AfeConsumer consumer) {
+    return xEventGroupGetBits(event_group_) & consumer;
+}
+
+void AfePipeline::EnableDeviceAec(bool enable) {
+    std::lock_guard<std::mutex> lock(mutex_);
+#if !CONFIG_USE_DEVICE_AEC
+    if (enable) {
+        ESP_LOGE(TAG, "Device AEC is not supported");
+        return;
+    }
+#endif
+    device_aec_ = enable;
+    if (afe_data_ != nullptr) {
+        ApplyMode(xEventGroupGetBits(event_group_));
+    }
+}
+
+// 调用者需持有 mutex_
+void AfePipeline::ApplyMode(EventBits_t active) {
+    bool wake_word = active & kAfeConsumerWakeWord;
+    bool voice = active & kAfeConsumerVoice;
+
+    if (wakenet_init_) {
+        wake_word ? afe_iface_->enable_wakenet(afe_data_) : afe_iface_->disable_wakenet(afe_data_);
+    }
+    if (ns_init_) {
+        voice ? afe_iface_->enable_ns(afe_data_) : afe_iface_->disable_ns(afe_data_);
+    }
+    if (vad_init_) {
+        // 设备端 AEC 打开时沿用原来的做法关闭 VAD
+        (voice && !device_aec_) ? afe_iface_->enable_vad(afe_data_) : afe_iface_->disable_vad(afe_data_);
+    }
+    if (aec_init_) {
+        bool aec = (wake_word && codec_->input_reference()) || (voice && device_aec_);
+        aec ? afe_iface_->enable_aec(afe_data_) : afe_iface_->disable_aec(afe_data_);
+    }
+}
+
+void AfePipeline::FetchTask() {
+    auto fetch_size = afe_iface_->get_fetch_chunksize(afe_data_);
+    auto feed_size = afe_iface_->get_feed_chunksize(afe_data_);
+    ESP_LOGI(TAG, "AFE task started, feed size: %d fetch size: %d", feed_size, fetch_size);
+
+    while (true) {
+        xEventGroupWaitBits(event_group_, AFE_CONSUMER_ALL, pdFALSE, pdFALSE, portMAX_DELAY);
+
+        auto res = afe_iface_->fetch_with_delay(afe_data_, portMAX_DELAY);
+        if (res == nullptr || res->ret_value == ESP_FAIL) {
+            if (res != nullptr) {
+                ESP_LOGI(TAG, "Error code: %d", res->ret_value);
+            }
+            continue;
+        }
+        if (fetch_resync_.exchange(false)) {
+            fetched_samples_ = (uint64_t)resync_feed_count_.load() * feed_size;
+        }
+        uint64_t last_sample = fetched_samples_ + fetch_size - 1;
+        fetched_samples_ += fetch_size;
+        fetch_capture_time_us_ = feed_times_us_[(last_sample / feed_size) % AFE_FEED_TIME_SLOTS];
+
+        // 同一份 fetch 结果分发给当前所有使用者
+        EventBits_t bits = xEventGroupGetBits(event_group_);
+        if ((bits & kAfeConsumerVoice) && voice_callback_) {
+            voice_callback_(res);
+        }
+        if ((bits & kAfeConsumerWakeWord) && wake_word_callback_) {
+            wake_word_callback_(res);
+        }
+        if ((bits & kAfeConsumerCommand) && command_callback_) {
+            command_callback_(res);
+        }
+    }
+}
@@ -0,0 +1,84 @@
+#ifndef AFE_PIPELINE_H
+#define AFE_PIPELINE_H
+
+#include <esp_afe_sr_models.h>
+#include <freertos/FreeRTOS.h>
+#include <freertos/task.h>
+#include <freertos/event_groups.h>
+
+#include <string>
+#include <vector>
+#include <functional>
+#include <mutex>
+#include <atomic>
+
+#include "audio_codec.h"
+
+enum AfeConsumer {
+    kAfeConsumerWakeWord = (1 << 0),
+    kAfeConsumerVoice = (1 << 1),
+    kAfeConsumerCommand = (1 << 2),
+};
+
+#define AFE_CONSUMER_ALL (kAfeConsumerWakeWord | kAfeConsumerVoice | kAfeConsumerCommand)
+#define AFE_FEED_TIME_SLOTS 32  // 记录最近 feed 时间的个数，需覆盖 AFE 内部缓冲的块数
+
+/*
+ * AfeWakeWord 与 AfeAudioProcessor 共用的唯一一个 ESP-SR AFE 实例。
+ * 模型、feed 缓冲区和 fetch 任务只有一份，待命与聆听之间切换时
+ * 只是按模式开关 wakenet / VAD / NS / AEC，不再销毁重建或切换 AFE。
+ */
+class AfePipeline {
+public:
+    static AfePipeline& GetInstance() {
+        static AfePipeline instance;
+        return instance;
+    }
+    AfePipeline(const AfePipeline&) = delete;
+    AfePipeline& operator=(const AfePipeline&) = delete;
+
+    bool Initialize(AudioCodec* codec);
+    void Feed(const int16_t* data);
+    size_t GetFeedSize();
+    void OnFetch(AfeConsumer consumer, std::function<void(afe_fetch_result_t* result)> callback);
+    void Activate(AfeConsumer consumer, bool active);
+    bool IsActive(AfeConsumer consumer);
+    void EnableDeviceAec(bool enable);
+    const std::vector<std::string>& wake_words() const { return wake_words_; }
+    srmodel_list_t* models() const { return models_; }
+    int fetch_size() const { return afe_data_ ? afe_iface_->get_fetch_chunksize(afe_data_) : 0; }
+    // 当前 fetch 结果最后一个采样送入 AFE 的时间，只在 fetch 回调中有效
+    int64_t fetch_capture_time_us() const { return fetch_capture_time_us_; }
+
+private:
+    AfePipeline();
+    ~AfePipeline();
+
+    std::mutex mutex_;
+    EventGroupHandle_t event_group_ = nullptr;
+    esp_afe_sr_iface_t* afe_iface_ = nullptr;
+    esp_afe_sr_data_t* afe_data_ = nullptr;
+    AudioCodec* codec_ = nullptr;
+    srmodel_list_t* models_ = nullptr;
+    std::vector<std::string> wake_words_;
+    std::function<void(afe_fetch_result_t* result)> wake_word_callback_;
+    std::function<void(afe_fetch_result_t* result)> voice_callback_;
+    std::function<void(afe_fetch_result_t* result)> command_callback_;
+    bool wakenet_init_ = false;
+    bool vad_init_ = false;
+    bool ns_init_ = false;
+    bool aec_init_ = false;
+    bool device_aec_ = false;
+    // 按采样序号把 fetch 结果对应回送入时间，AFE 内部的缓冲延迟也计算在内
+    int64_t feed_times_us_[AFE_FEED_TIME_SLOTS] = {};
+    std::atomic<uint32_t> feed_count_{0};
+    uint64_t fetched_samples_ = 0;
+    std::atomic<uint32_t> resync_feed_count_{0};
+    std::atomic<bool> fetch_resync_{false};
+    int64_t fetch_capture_time_us_ = 0;
+
+    void ApplyMode(EventBits_t active);
+    void FetchTask();
+};
+
+#endif
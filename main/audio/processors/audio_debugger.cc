@@ -1,35 +1,72 @@
 #include "audio_debugger.h"
 #include "sdkconfig.h"
 
+#include <algorithm>
+
 #if CONFIG_USE_AUDIO_DEBUGGER
 #include <esp_log.h>
 #include <arpa/inet.h>
 #include <unistd.h>
 #include <errno.h>
 #include <cstring>
-#include <string>
 #endif
 
 #define TAG "AudioDebugger"
 
+// 包头之后的负载不超过该长度，避免 IP 分片
+#define AUDIO_DEBUG_MAX_PAYLOAD 1400
+#define AUDIO_DEBUG_MAGIC 0x4441    // "AD"
+#define AUDIO_DEBUG_VERSION 1
+
+// 所有字段为小端
+struct __attribute__((packed)) AudioDebugHeader {
+    uint16_t magic;
+    uint8_t version;
+    uint8_t tap;
+    uint8_t codec;
+    uint8_t channels;
+    uint16_t sample_rate;
+    uint32_t sequence;          // 每个采集点独立递增，用于统计丢包和乱序
+    uint32_t sample_index;      // 本数据报第一帧在该采集点流中的位置（每通道采样数）
+    uint16_t frames;            // 本数据报的帧数（每通道采样数）
+    uint16_t reserved;
+};
+
+static const char* const kTapNames[kAudioDebugTapCount] = {
+    "mic", "reference", "afe_output", "downlink", "playback",
+};
+
+static const int16_t kAdpcmStepTable[89] = {
+    7, 8, 9, 10, 11, 12, 13, 14, 16, 17, 19, 21, 23, 25, 28, 31, 34, 37, 41, 45,
+    50, 55, 60, 66, 73, 80, 88, 97, 107, 118, 130, 143, 157, 173, 190, 209, 230,
+    253, 279, 307, 337, 371, 408, 449, 494, 544, 598, 658, 724, 796, 876, 963,
+    1060, 1166, 1282, 1411, 1552, 1707, 1878, 2066, 2272, 2499, 2749, 3024, 3327,
+    3660, 4026, 4428, 4871, 5358, 5894, 6484, 7132, 7845, 8630, 9493, 10442,
+    11487, 12635, 13899, 15289, 16818, 18500, 20350, 22385, 24623, 27086, 29794, 32767,
+};
 
-AudioDebugger::AudioDebugger() {
+static const int8_t kAdpcmIndexTable[16] = {
+    -1, -1, -1, -1, 2, 4, 6, 8, -1, -1, -1, -1, 2, 4, 6, 8,
+};
+
+
+AudioDebugger::AudioDebugger() : tap_mask_(0), codec_(kAudioDebugCodecPcm) {
 #if CONFIG_USE_AUDIO_DEBUGGER
     udp_sockfd_ = socket(AF_INET, SOCK_DGRAM, 0);
     if (udp_sockfd_ >= 0) {
         // 解析配置的服务器地址 "IP:PORT"
         std::string server_addr = CONFIG_AUDIO_DEBUG_UDP_SERVER;
         size_t colon_pos = server_addr.find(':');
-        
+
         if (colon_pos != std::string::npos) {
             std::string ip = server_addr.substr(0, colon_pos);
             int port = std::stoi(server_addr.substr(colon_pos + 1));
-            
+
             memset(&udp_server_addr_, 0, sizeof(udp_server_addr_));
             udp_server_addr_.sin_family = AF_INET;
             udp_server_addr_.sin_port = htons(port);
             inet_pton(AF_INET, ip.c_str(), &udp_server_addr_.sin_addr);
-            
+
             ESP_LOGI(TAG, "Initialized server address: %s", CONFIG_AUDIO_DEBUG_UDP_SERVER);
         } else {
             ESP_LOGW(TAG, "Invalid server address: %s, should be IP:PORT", CONFIG_AUDIO_DEBUG_UDP_SERVER);
@@ -39,6 +76,11 @@ AudioDebugger::AudioDebugger() {
     } else {
         ESP_LOGW(TAG, "Failed to create UDP socket: %d", errno);
     }
+#if CONFIG_AUDIO_DEBUG_ADPCM
+    Configure(ParseTaps(CONFIG_AUDIO_DEBUG_DEFAULT_TAPS), kAudioDebugCodecAdpcm);
+#else
+    Configure(ParseTaps(CONFIG_AUDIO_DEBUG_DEFAULT_TAPS), kAudioDebugCodecPcm);
+#endif
 #endif
 }
 
@@ -51,18 +93,206 @@ AudioDebugger::~AudioDebugger() {
 #endif
 }
 
-void AudioDebugger::Feed(const std::vector<int16_t>& data) {
+const char* AudioDebugger::GetTapName(AudioDebugTap tap) {
+    return tap < kAudioDebugTapCount ? kTapNames[tap] : "unknown";
+}
+
+// 解析逗号分隔的采集点名称，"all" 表示全部
+uint32_t AudioDebugger::ParseTaps(const std::string& taps) {
+    uint32_t mask = 0;
+    size_t start = 0;
+    while (start <= taps.size()) {
+        size_t end = taps.find(',', start);
+        if (end == std::string::npos) {
+            end = taps.size();
+        }
+        std::string name = taps.substr(start, end - start);
+        if (name == "all") {
+            mask = (1u << kAudioDebugTapCount) - 1;
+        }
+        for (int i = 0; i < kAudioDebugTapCount; i++) {
+            if (name == kTapNames[i]) {
+                mask |= 1u << i;
+            }
+        }
+        start = end + 1;
+    }
+    return mask;
+}
+
+void AudioDebugger::Configure(uint32_t tap_mask, AudioDebugCodec codec) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    tap_mask_ = tap_mask & ((1u << kAudioDebugTapCount) - 1);
+    codec_ = codec;
 #if CONFIG_USE_AUDIO_DEBUGGER
-    if (udp_sockfd_ >= 0) {
-        ssize_t sent = sendto(udp_sockfd_, data.data(), data.size() * sizeof(int16_t), 0,
-                             (struct sockaddr*)&udp_server_addr_, sizeof(udp_server_addr_));
-        if (sent < 0) {
-            ESP_LOGW(TAG, "Failed to send audio data to %s: %d", CONFIG_AUDIO_DEBUG_UDP_SERVER, errno);
-        } else {
-            ESP_LOGD(TAG, "Sent %d bytes audio data to %s", sent, CONFIG_AUDIO_DEBUG_UDP_SERVER);
+    ESP_LOGI(TAG, "Taps: 0x%02lx, codec: %s", (unsigned long)tap_mask_.load(), codec == kAudioDebugCodecAdpcm ? "adpcm" : "pcm");
+#endif
+}
+
+std::string AudioDebugger::GetStatusJson() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    std::string json = "{\"taps\":[";
+    bool first = true;
+    for (int i = 0; i < kAudioDebugTapCount; i++) {
+        if (tap_mask_ & (1u << i)) {
+            json += first ? "\"" : ",\"";
+            json += kTapNames[i];
+            json += "\"";
+            first = false;
+        }
+    }
+    json += "],\"codec\":\"";
+    json += codec_ == kAudioDebugCodecAdpcm ? "adpcm" : "pcm";
+    json += "\",\"sent\":" + std::to_string(sent_packets_) + ",\"dropped\":" + std::to_string(dropped_packets_) + "}";
+    return json;
+}
+
+void AudioDebugger::FeedInput(const std::vector<int16_t>& data, int channels, bool has_reference, int sample_rate) {
+    bool mic = IsTapEnabled(kAudioDebugTapMic);
+    bool reference = has_reference && IsTapEnabled(kAudioDebugTapReference);
+    if (!mic && !reference) {
+        return;
+    }
+    if (channels == 1) {
+        Feed(kAudioDebugTapMic, data.data(), data.size(), 1, sample_rate);
+        return;
+    }
+
+    int mic_channels = has_reference ? channels - 1 : channels;
+    size_t frames = data.size() / channels;
+    if (mic) {
+        std::vector<int16_t> mic_data(frames * mic_channels);
+        for (size_t i = 0; i < frames; i++) {
+            memcpy(&mic_data[i * mic_channels], &data[i * channels], mic_channels * sizeof(int16_t));
         }
+        Feed(kAudioDebugTapMic, mic_data.data(), mic_data.size(), mic_channels, sample_rate);
+    }
+    if (reference) {
+        std::vector<int16_t> reference_data(frames);
+        for (size_t i = 0; i < frames; i++) {
+            reference_data[i] = data[i * channels + channels - 1];
+        }
+        Feed(kAudioDebugTapReference, reference_data.data(), reference_data.size(), 1, sample_rate);
+    }
+}
+
+void AudioDebugger::Feed(AudioDebugTap tap, const int16_t* data, size_t samples, int channels, int sample_rate) {
+#if CONFIG_USE_AUDIO_DEBUGGER
+    if (!IsTapEnabled(tap) || channels <= 0) {
+        return;
+    }
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto codec = codec_.load();
+    auto& state = taps_[tap];
+    // 格式变化时重新开始这一路流，接收端据此切换输出文件
+    if (state.channels != channels || state.sample_rate != sample_rate) {
+        state.channels = channels;
+        state.sample_rate = sample_rate;
+        state.sample_index = 0;
+        state.adpcm.assign(channels, AdpcmState());
+    }
+
+    size_t frames = samples / channels;
+    size_t max_frames = codec == kAudioDebugCodecAdpcm ?
+        (AUDIO_DEBUG_MAX_PAYLOAD - channels * 4) * 2 / channels : AUDIO_DEBUG_MAX_PAYLOAD / (channels * sizeof(int16_t));
+    max_frames &= ~(size_t)1;
+    for (size_t offset = 0; offset < frames; offset += max_frames) {
+        size_t count = std::min(max_frames, frames - offset);
+        SendChunk(tap, state, codec, data + offset * channels, count);
+    }
+#endif
+}
+
+// 调用者需持有 mutex_
+void AudioDebugger::SendChunk(AudioDebugTap tap, TapState& state, AudioDebugCodec codec, const int16_t* data, size_t frames) {
+#if CONFIG_USE_AUDIO_DEBUGGER
+    int channels = state.channels;
+    buffer_.resize(sizeof(AudioDebugHeader));
+    auto header = (AudioDebugHeader*)buffer_.data();
+    header->magic = AUDIO_DEBUG_MAGIC;
+    header->version = AUDIO_DEBUG_VERSION;
+    header->tap = tap;
+    header->codec = codec;
+    header->channels = channels;
+    header->sample_rate = state.sample_rate;
+    header->sequence = state.sequence++;
+    header->sample_index = state.sample_index;
+    header->frames = frames;
+    header->reserved = 0;
+    state.sample_index += frames;
+
+    if (codec == kAudioDebugCodecAdpcm) {
+        // 每个通道的编码起始状态：int16 预测值 + uint8 步长索引 + 1 字节对齐
+        for (int ch = 0; ch < channels; ch++) {
+            auto& adpcm = state.adpcm[ch];
+            buffer_.push_back(adpcm.predictor & 0xFF);
+            buffer_.push_back((adpcm.predictor >> 8) & 0xFF);
+            buffer_.push_back(adpcm.step_index);
+            buffer_.push_back(0);
+        }
+        // 按采样交织，每字节两个采样，低 4 位在前
+        size_t total = frames * channels;
+        uint8_t byte = 0;
+        for (size_t i = 0; i < total; i++) {
+            uint8_t nibble = EncodeAdpcmSample(state.adpcm[i % channels], data[i]);
+            if (i & 1) {
+                buffer_.push_back(byte | (nibble << 4));
+            } else {
+                byte = nibble;
+            }
+        }
+        if (total & 1) {
+            buffer_.push_back(byte);
+        }
+    } else {
+        auto bytes = (const uint8_t*)data;
+        buffer_.insert(buffer_.end(), bytes, bytes + frames * channels * sizeof(int16_t));
+    }
+
+    // 不阻塞音频任务，发送缓冲区满时直接丢弃
+    ssize_t sent = sendto(udp_sockfd_, buffer_.data(), buffer_.size(), MSG_DONTWAIT,
+                         (struct sockaddr*)&udp_server_addr_, sizeof(udp_server_addr_));
+    if (sent < 0) {
+        if (dropped_packets_++ % 100 == 0) {
+            ESP_LOGW(TAG, "Failed to send audio data to %s: %d, dropped %lu", CONFIG_AUDIO_DEBUG_UDP_SERVER, errno,
+                (unsigned long)dropped_packets_);
+        }
+    } else {
+        sent_packets_++;
     }
 #endif
 }
 
- 
\ No newline at end of file
+uint8_t AudioDebugger::EncodeAdpcmSample(AdpcmState& state, int16_t sample) {
+    int step = kAdpcmStepTable[state.step_index];
+    int diff = sample - state.predictor;
+    uint8_t nibble = 0;
+    if (diff < 0) {
+        nibble = 8;
+        diff = -diff;
+    }
+
+    int delta = step >> 3;
+    if (diff >= step) {
+        nibble |= 4;
+        diff -= step;
+        delta += step;
+    }
+    step >>= 1;
+    if (diff >= step) {
+        nibble |= 2;
+        diff -= step;
+        delta += step;
+    }
+    step >>= 1;
+    if (diff >= step) {
+        nibble |= 1;
+        delta += step;
+    }
+
+    int predictor = state.predictor + ((nibble & 8) ? -delta : delta);
+    state.predictor = std::max(-32768, std::min(32767, predictor));
+    int index = state.step_index + kAdpcmIndexTable[nibble];
+    state.step_index = std::max(0, std::min(88, index));
+    return nibble;
+}
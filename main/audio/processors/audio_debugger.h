@@ -2,21 +2,77 @@
 #define AUDIO_DEBUGGER_H
 
 #include <vector>
+#include <string>
 #include <cstdint>
+#include <mutex>
+#include <atomic>
 
 #include <sys/socket.h>
 #include <netinet/in.h>
 
+// 音频调试的采集点，每个采集点是一路独立的流
+enum AudioDebugTap {
+    kAudioDebugTapMic = 0,          // 原始麦克风输入（重采样到 16kHz 后，不含参考通道）
+    kAudioDebugTapReference,        // 回声参考通道
+    kAudioDebugTapAfeOutput,        // 音频处理器输出，即上行编码前的 PCM
+    kAudioDebugTapDownlink,         // 下行解码后、重采样前的 PCM
+    kAudioDebugTapPlayback,         // 实际写入扬声器的 PCM，包含提示音
+    kAudioDebugTapCount,
+};
+
+enum AudioDebugCodec {
+    kAudioDebugCodecPcm = 0,
+    kAudioDebugCodecAdpcm,          // IMA ADPCM，4 bit/采样
+};
+
+/*
+ * 通过 UDP 把各采集点的音频发送到 scripts/audio_debug_server.py。
+ * 每个数据报带有包头（采集点、序号、采样位置），大帧会拆分成多个数据报，
+ * 接收端按采集点分流，按采样位置重组并用静音补齐丢包。
+ * ADPCM 的编码状态写在每个数据报的包头之后，单个数据报可以独立解码。
+ */
 class AudioDebugger {
 public:
     AudioDebugger();
     ~AudioDebugger();
 
-    void Feed(const std::vector<int16_t>& data);
+    void Feed(AudioDebugTap tap, const int16_t* data, size_t samples, int channels, int sample_rate);
+    // 原始输入按通道拆分为麦克风和参考两路
+    void FeedInput(const std::vector<int16_t>& data, int channels, bool has_reference, int sample_rate);
+
+    bool IsTapEnabled(AudioDebugTap tap) const { return udp_sockfd_ >= 0 && (tap_mask_ & (1u << tap)); }
+    void Configure(uint32_t tap_mask, AudioDebugCodec codec);
+    std::string GetStatusJson();
+
+    static uint32_t ParseTaps(const std::string& taps);
+    static const char* GetTapName(AudioDebugTap tap);
 
 private:
+    struct AdpcmState {
+        int16_t predictor = 0;
+        uint8_t step_index = 0;
+    };
+
+    struct TapState {
+        uint32_t sequence = 0;
+        uint32_t sample_index = 0;
+        int channels = 0;
+        int sample_rate = 0;
+        std::vector<AdpcmState> adpcm;
+    };
+
     int udp_sockfd_ = -1;
     struct sockaddr_in udp_server_addr_;
+    std::atomic<uint32_t> tap_mask_;
+    std::atomic<AudioDebugCodec> codec_;
+    std::mutex mutex_;
+    TapState taps_[kAudioDebugTapCount];
+    std::vector<uint8_t> buffer_;
+    uint32_t sent_packets_ = 0;
+    uint32_t dropped_packets_ = 0;
+
+    void SendChunk(AudioDebugTap tap, TapState& state, AudioDebugCodec codec, const int16_t* data, size_t frames);
+    static uint8_t EncodeAdpcmSample(AdpcmState& state, int16_t sample);
 };
 
-#endif 
\ No newline at end of file
+#endif
@@ -1,4 +1,5 @@
 #include "no_audio_processor.h"
+#include "pcm_utils.h"
 #include <esp_log.h>
 
 #define TAG "NoAudioProcessor"
@@ -20,11 +21,9 @@ void NoAudioProcessor::Feed(std::vector<int16_t>&& data) {
 
     if (codec_->input_channels() == 2) {
         // If input channels is 2, we need to fetch the left channel data
-        auto mono_data = std::vector<int16_t>(data.size() / 2);
-        for (size_t i = 0, j = 0; i < mono_data.size(); ++i, j += 2) {
-            mono_data[i] = data[j];
-        }
-        output_callback_(std::move(mono_data));
+        ExtractLeftChannel(data.data(), data.size() / 2, data.data());
+        data.resize(data.size() / 2);
+        output_callback_(std::move(data));
     } else {
         output_callback_(std::move(data));
     }
@@ -0,0 +1,439 @@
+#include "tts_cache.h"
+
+#include <esp_log.h>
+#include <esp_spiffs.h>
+#include <esp_partition.h>
+#include <freertos/FreeRTOS.h>
+#include <freertos/task.h>
+#include <cJSON.h>
+
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <dirent.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <algorithm>
+
+#define TAG "TtsCache"
+
+#define TTS_CACHE_PARTITION "tts_cache"
+#define TTS_CACHE_BASE_PATH "/tts_cache"
+#define TTS_CACHE_INDEX_FILE TTS_CACHE_BASE_PATH "/index"
+#define TTS_CACHE_MAGIC 0x43535454  // "TTSC"
+// SPIFFS 文件名最长 32 字节（含扩展名和结束符）
+#define TTS_CACHE_MAX_HASH_LENGTH 24
+// 过长的句子不缓存，避免单条占用过多空间和录制内存
+#define TTS_CACHE_MAX_ENTRY_BYTES (64 * 1024)
+
+struct TtsCacheFileHeader {
+    uint32_t magic;
+    uint32_t sample_rate;
+    uint32_t frame_duration;
+} __attribute__((packed));
+
+float TtsCacheStatistics::HitRate() const {
+    uint32_t total = hits + misses;
+    return total == 0 ? 0.0f : (float)hits / total;
+}
+
+std::string TtsCacheStatistics::ToJson() const {
+    cJSON* root = cJSON_CreateObject();
+    cJSON_AddNumberToObject(root, "hits", hits);
+    cJSON_AddNumberToObject(root, "misses", misses);
+    cJSON_AddNumberToObject(root, "hit_rate", std::round(HitRate() * 1000) / 1000);
+    cJSON_AddNumberToObject(root, "bytes_saved", bytes_saved);
+    cJSON_AddNumberToObject(root, "stored", stored);
+    cJSON_AddNumberToObject(root, "evicted", evicted);
+    cJSON_AddNumberToObject(root, "entries", entries);
+    cJSON_AddNumberToObject(root, "used_bytes", used_bytes);
+    cJSON_AddNumberToObject(root, "capacity_bytes", capacity_bytes);
+    auto json_str = cJSON_PrintUnformatted(root);
+    std::string json(json_str);
+    cJSON_free(json_str);
+    cJSON_Delete(root);
+    return json;
+}
+
+TtsCache::TtsCache() {
+}
+
+TtsCache::~TtsCache() {
+    if (mounted_) {
+        esp_vfs_spiffs_unregister(TTS_CACHE_PARTITION);
+    }
+}
+
+bool TtsCache::Initialize(std::function<void(std::unique_ptr<AudioStreamPacket> packet)> sink) {
+    if (esp_partition_find_first(ESP_PARTITION_TYPE_DATA, ESP_PARTITION_SUBTYPE_DATA_SPIFFS, TTS_CACHE_PARTITION) == nullptr) {
+        ESP_LOGI(TAG, "No %s partition, TTS cache disabled", TTS_CACHE_PARTITION);
+        return false;
+    }
+
+    sink_ = sink;
+    enabled_ = true;
+    xTaskCreate([](void* arg) {
+        auto this_ = (TtsCache*)arg;
+        if (this_->Mount()) {
+            this_->CacheTask();
+        }
+        vTaskDelete(NULL);
+    }, "tts_cache", 4096, this, 2, NULL);
+    return true;
+}
+
+bool TtsCache::Mount() {
+    // 启动时不格式化：首次使用或分区损坏时格式化整个分区要数秒，放在缓存任务中进行
+    esp_vfs_spiffs_conf_t conf = {
+        .base_path = TTS_CACHE_BASE_PATH,
+        .partition_label = TTS_CACHE_PARTITION,
+        .max_files = 4,
+        .format_if_mount_failed = false,
+    };
+    esp_err_t ret = esp_vfs_spiffs_register(&conf);
+    if (ret == ESP_FAIL) {
+        ESP_LOGW(TAG, "Failed to mount %s partition, formatting", TTS_CACHE_PARTITION);
+        ret = esp_spiffs_format(TTS_CACHE_PARTITION);
+        if (ret == ESP_OK) {
+            ret = esp_vfs_spiffs_register(&conf);
+        }
+    }
+    if (ret != ESP_OK) {
+        ESP_LOGE(TAG, "Failed to mount %s partition: %s", TTS_CACHE_PARTITION, esp_err_to_name(ret));
+        enabled_ = false;
+        return false;
+    }
+
+    size_t total = 0, used = 0;
+    esp_spiffs_info(TTS_CACHE_PARTITION, &total, &used);
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        // SPIFFS 接近写满时垃圾回收代价很高，只使用 3/4 的空间
+        capacity_bytes_ = total * 3 / 4;
+        LoadIndex();
+        mounted_ = true;
+        ESP_LOGI(TAG, "TTS cache mounted, %u entries, %u / %u bytes", entries_.size(), used_bytes_, capacity_bytes_);
+    }
+    return true;
+}
+
+bool TtsCache::IsValidHash(const std::string& hash) {
+    if (hash.empty() || hash.size() > TTS_CACHE_MAX_HASH_LENGTH) {
+        return false;
+    }
+    // 哈希直接用作文件名，只接受字母和数字
+    return std::all_of(hash.begin(), hash.end(), [](char c) {
+        return (c >= '0' && c <= '9') || (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z');
+    });
+}
+
+std::string TtsCache::GetPath(const std::string& hash) const {
+    return std::string(TTS_CACHE_BASE_PATH "/") + hash + ".tts";
+}
+
+void TtsCache::LoadIndex() {
+    // 索引文件每行为 "哈希 字节数"，按最近使用排序
+    FILE* fp = fopen(TTS_CACHE_INDEX_FILE, "r");
+    if (fp != nullptr) {
+        char hash[TTS_CACHE_MAX_HASH_LENGTH + 8];
+        unsigned size;
+        while (fscanf(fp, "%31s %u", hash, &size) == 2) {
+            struct stat st;
+            if (IsValidHash(hash) && stat(GetPath(hash).c_str(), &st) == 0 && (size_t)st.st_size == size) {
+                entries_.push_back({hash, size});
+                used_bytes_ += size;
+            }
+        }
+        fclose(fp);
+    }
+
+    // 清理索引之外的文件（写入过程中断电留下的残留）
+    DIR* dir = opendir(TTS_CACHE_BASE_PATH);
+    if (dir == nullptr) {
+        return;
+    }
+    struct dirent* ent;
+    while ((ent = readdir(dir)) != nullptr) {
+        std::string name = ent->d_name;
+        if (name == "index") {
+            continue;
+        }
+        auto it = std::find_if(entries_.begin(), entries_.end(), [&name](const Entry& entry) {
+            return entry.hash + ".tts" == name;
+        });
+        if (it == entries_.end()) {
+            ESP_LOGW(TAG, "Removing orphan cache file %s", name.c_str());
+            unlink((std::string(TTS_CACHE_BASE_PATH "/") + name).c_str());
+        }
+    }
+    closedir(dir);
+}
+
+void TtsCache::SaveIndex() {
+    std::string content;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        for (auto& entry : entries_) {
+            content += entry.hash + " " + std::to_string(entry.size) + "\n";
+        }
+        index_dirty_ = false;
+    }
+    FILE* fp = fopen(TTS_CACHE_INDEX_FILE, "w");
+    if (fp == nullptr) {
+        ESP_LOGE(TAG, "Failed to write cache index");
+        return;
+    }
+    fwrite(content.data(), 1, content.size(), fp);
+    fclose(fp);
+}
+
+bool TtsCache::OnSentenceStart(const std::string& hash) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    FinishSentence();
+    if (!mounted_ || !IsValidHash(hash)) {
+        return false;
+    }
+
+    sentence_hash_ = hash;
+    sentence_bytes_ = 0;
+    auto it = std::find_if(entries_.begin(), entries_.end(), [&hash](const Entry& entry) {
+        return entry.hash == hash;
+    });
+    if (it != entries_.end()) {
+        entries_.splice(entries_.begin(), entries_, it);
+        index_dirty_ = true;
+        statistics_.hits++;
+        statistics_.bytes_saved += it->size;
+        sentence_state_ = kSentenceCached;
+        PushWork({kWorkReplay, generation_, hash});
+        ESP_LOGI(TAG, "Cache hit: %s (%u bytes)", hash.c_str(), it->size);
+        return true;
+    }
+
+    statistics_.misses++;
+    sentence_state_ = kSentenceRecording;
+    return false;
+}
+
+void TtsCache::OnSentenceEnd() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    FinishSentence();
+    if (statistics_.hits + statistics_.misses > 0) {
+        ESP_LOGI(TAG, "Hit rate %.1f%% (%lu/%lu), downlink bytes saved %llu", statistics_.HitRate() * 100,
+            (unsigned long)statistics_.hits, (unsigned long)(statistics_.hits + statistics_.misses), statistics_.bytes_saved);
+    }
+}
+
+// 调用者需持有 mutex_
+void TtsCache::FinishSentence() {
+    if (sentence_state_ == kSentenceRecording && !recording_.empty()) {
+        PushWork({kWorkStore, generation_, sentence_hash_, nullptr, std::move(recording_)});
+    }
+    recording_.clear();
+    sentence_state_ = kSentenceNone;
+}
+
+std::unique_ptr<AudioStreamPacket> TtsCache::ProcessIncomingAudio(std::unique_ptr<AudioStreamPacket> packet) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (sentence_state_ == kSentenceCached) {
+        // 服务器收到 cache_hit 之前已经发出的音频，丢弃并从节省的字节数中扣除
+        statistics_.bytes_saved -= std::min<uint64_t>(statistics_.bytes_saved, packet->payload.size());
+        return nullptr;
+    }
+
+    if (sentence_state_ == kSentenceRecording) {
+        sentence_bytes_ += packet->payload.size() + sizeof(uint16_t);
+        if (sentence_bytes_ > TTS_CACHE_MAX_ENTRY_BYTES) {
+            ESP_LOGW(TAG, "Sentence %s is too long to cache", sentence_hash_.c_str());
+            recording_.clear();
+            sentence_state_ = kSentenceNone;
+        } else {
+            recording_.push_back(std::make_unique<AudioStreamPacket>(*packet));
+        }
+    }
+
+    // 回放尚未结束时，后续句子的音频排在回放之后
+    if (replay_works_ > 0) {
+        PushWork({kWorkPacket, generation_, "", std::move(packet)});
+        return nullptr;
+    }
+    return packet;
+}
+
+void TtsCache::SetPlaybackEnabled(bool enabled) {
+    if (!enabled) {
+        Abort();
+    }
+    std::lock_guard<std::mutex> lock(mutex_);
+    playback_enabled_ = enabled;
+    cv_.notify_all();
+}
+
+void TtsCache::Abort() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    generation_++;
+    recording_.clear();
+    sentence_state_ = kSentenceNone;
+    // 写入任务保留，回放和排队的音频全部丢弃
+    for (auto it = works_.begin(); it != works_.end();) {
+        if (it->type != kWorkStore) {
+            replay_works_--;
+            it = works_.erase(it);
+        } else {
+            ++it;
+        }
+    }
+}
+
+TtsCacheStatistics TtsCache::GetStatistics() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    TtsCacheStatistics statistics = statistics_;
+    statistics.entries = entries_.size();
+    statistics.used_bytes = used_bytes_;
+    statistics.capacity_bytes = capacity_bytes_;
+    return statistics;
+}
+
+// 调用者需持有 mutex_
+void TtsCache::PushWork(Work&& work) {
+    if (work.type != kWorkStore) {
+        replay_works_++;
+    }
+    works_.push_back(std::move(work));
+    cv_.notify_all();
+}
+
+void TtsCache::CacheTask() {
+    while (true) {
+        std::unique_lock<std::mutex> lock(mutex_);
+        // 回放需要等到进入说话状态、解码队列清空之后才开始
+        cv_.wait(lock, [this]() {
+            return !works_.empty() && (works_.front().type == kWorkStore || playback_enabled_);
+        });
+        Work work = std::move(works_.front());
+        works_.pop_front();
+        lock.unlock();
+
+        if (work.type == kWorkStore) {
+            Store(work.hash, work.frames);
+        } else if (work.type == kWorkReplay) {
+            Replay(work.hash, work.generation);
+        } else if (work.generation == generation_) {
+            sink_(std::move(work.packet));
+        }
+
+        lock.lock();
+        if (work.type != kWorkStore) {
+            replay_works_--;
+        }
+        bool save_index = index_dirty_ && works_.empty();
+        lock.unlock();
+        if (save_index) {
+            SaveIndex();
+        }
+    }
+}
+
+void TtsCache::Replay(const std::string& hash, uint32_t generation) {
+    auto path = GetPath(hash);
+    FILE* fp = fopen(path.c_str(), "rb");
+    TtsCacheFileHeader header;
+    if (fp == nullptr || fread(&header, sizeof(header), 1, fp) != 1 || header.magic != TTS_CACHE_MAGIC) {
+        ESP_LOGE(TAG, "Failed to read cache entry %s", hash.c_str());
+        if (fp != nullptr) {
+            fclose(fp);
+        }
+        // 损坏的条目从索引中移除，下次由服务器重新下发
+        std::lock_guard<std::mutex> lock(mutex_);
+        auto it = std::find_if(entries_.begin(), entries_.end(), [&hash](const Entry& entry) {
+            return entry.hash == hash;
+        });
+        if (it != entries_.end()) {
+            used_bytes_ -= it->size;
+            entries_.erase(it);
+            index_dirty_ = true;
+            unlink(path.c_str());
+        }
+        return;
+    }
+
+    uint16_t size;
+    int frames = 0;
+    while (fread(&size, sizeof(size), 1, fp) == 1) {
+        if (generation != generation_) {
+            break;
+        }
+        auto packet = std::make_unique<AudioStreamPacket>();
+        packet->sample_rate = header.sample_rate;
+        packet->frame_duration = header.frame_duration;
+        packet->payload.resize(size);
+        if (fread(packet->payload.data(), 1, size, fp) != size) {
+            break;
+        }
+        sink_(std::move(packet));
+        frames++;
+    }
+    fclose(fp);
+    ESP_LOGI(TAG, "Replayed %s, %d frames", hash.c_str(), frames);
+}
+
+void TtsCache::Store(const std::string& hash, const std::vector<std::unique_ptr<AudioStreamPacket>>& frames) {
+    size_t size = sizeof(TtsCacheFileHeader);
+    for (auto& frame : frames) {
+        size += sizeof(uint16_t) + frame->payload.size();
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (std::any_of(entries_.begin(), entries_.end(), [&hash](const Entry& entry) { return entry.hash == hash; })) {
+            return;
+        }
+        // 按 LRU 淘汰，直到新条目可以放下
+        while (!entries_.empty() && used_bytes_ + size > capacity_bytes_) {
+            auto& victim = entries_.back();
+            unlink(GetPath(victim.hash).c_str());
+            used_bytes_ -= victim.size;
+            statistics_.evicted++;
+            entries_.pop_back();
+            index_dirty_ = true;
+        }
+        if (used_bytes_ + size > capacity_bytes_) {
+            return;
+        }
+    }
+
+    auto path = GetPath(hash);
+    FILE* fp = fopen(path.c_str(), "wb");
+    if (fp == nullptr) {
+        ESP_LOGE(TAG, "Failed to create cache entry %s", hash.c_str());
+        return;
+    }
+    TtsCacheFileHeader header = {
+        .magic = TTS_CACHE_MAGIC,
+        .sample_rate = (uint32_t)frames.front()->sample_rate,
+        .frame_duration = (uint32_t)frames.front()->frame_duration,
+    };
+    bool ok = fwrite(&header, sizeof(header), 1, fp) == 1;
+    for (auto& frame : frames) {
+        if (!ok) {
+            break;
+        }
+        uint16_t frame_size = frame->payload.size();
+        ok = fwrite(&frame_size, sizeof(frame_size), 1, fp) == 1 &&
+            fwrite(frame->payload.data(), 1, frame_size, fp) == frame_size;
+    }
+    ok = (fclose(fp) == 0) && ok;
+    if (!ok) {
+        ESP_LOGE(TAG, "Failed to write cache entry %s", hash.c_str());
+        unlink(path.c_str());
+        return;
+    }
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    entries_.push_front({hash, size});
+    used_bytes_ += size;
+    statistics_.stored++;
+    index_dirty_ = true;
+    ESP_LOGI(TAG, "Stored %s, %u frames %u bytes, cache %u / %u bytes", hash.c_str(), frames.size(), size,
+        used_bytes_, capacity_bytes_);
+}
@@ -0,0 +1,118 @@
+#ifndef TTS_CACHE_H
+#define TTS_CACHE_H
+
+#include <memory>
+#include <deque>
+#include <list>
+#include <string>
+#include <vector>
+#include <mutex>
+#include <condition_variable>
+#include <functional>
+#include <atomic>
+
+#include "protocol.h"
+
+struct TtsCacheStatistics {
+    uint32_t hits = 0;
+    uint32_t misses = 0;
+    uint32_t stored = 0;
+    uint32_t evicted = 0;
+    uint64_t bytes_saved = 0;       // 命中后服务器不再下发的字节数
+    size_t entries = 0;
+    size_t used_bytes = 0;
+    size_t capacity_bytes = 0;
+
+    float HitRate() const;
+    std::string ToJson() const;
+};
+
+/*
+ * 服务器 TTS 音频的闪存缓存。
+ * 服务器在 tts sentence_start 中带上内容哈希，命中时设备回复 cache_hit，
+ * 服务器跳过该句的音频下发，设备从 tts_cache 分区读出 Opus 帧序列回放；
+ * 未命中时录下该句的下行 Opus 帧，句子结束后写入分区，按 LRU 淘汰。
+ *
+ * 文件读写和回放都在 tts_cache 任务中串行执行，不阻塞网络接收和主任务。
+ * 回放期间到达的后续句子的音频会排在回放之后，保证句子顺序。
+ */
+class TtsCache {
+public:
+    TtsCache();
+    ~TtsCache();
+
+    // sink 将音频包送入解码队列，允许阻塞等待。
+    // 分区的挂载、损坏时的格式化和索引加载都在缓存任务中进行，不阻塞启动；挂载完成前按未命中处理
+    bool Initialize(std::function<void(std::unique_ptr<AudioStreamPacket> packet)> sink);
+    bool enabled() const { return enabled_; }
+
+    // 返回 true 表示命中，调用者应回复 cache_hit
+    bool OnSentenceStart(const std::string& hash);
+    void OnSentenceEnd();
+    // 返回 nullptr 表示音频包已被缓存接管（丢弃、录制后转交回放队列），否则原样交还调用者
+    std::unique_ptr<AudioStreamPacket> ProcessIncomingAudio(std::unique_ptr<AudioStreamPacket> packet);
+    // 只有在说话状态下才开始回放，离开说话状态时取消录制和回放
+    void SetPlaybackEnabled(bool enabled);
+    // 打断播放时取消录制和回放
+    void Abort();
+    TtsCacheStatistics GetStatistics();
+
+private:
+    struct Entry {
+        std::string hash;
+        size_t size;
+    };
+
+    enum WorkType {
+        kWorkReplay,
+        kWorkPacket,
+        kWorkStore,
+    };
+
+    struct Work {
+        WorkType type;
+        uint32_t generation;
+        std::string hash;
+        std::unique_ptr<AudioStreamPacket> packet;
+        std::vector<std::unique_ptr<AudioStreamPacket>> frames;
+    };
+
+    enum SentenceState {
+        kSentenceNone,
+        kSentenceRecording,
+        kSentenceCached,
+    };
+
+    std::atomic<bool> enabled_ = false;    // 分区存在且未挂载失败
+    std::atomic<bool> mounted_ = false;
+    std::function<void(std::unique_ptr<AudioStreamPacket> packet)> sink_;
+    std::mutex mutex_;
+    std::condition_variable cv_;
+    std::list<Entry> entries_;      // 最近使用的在前
+    size_t used_bytes_ = 0;
+    size_t capacity_bytes_ = 0;
+    bool index_dirty_ = false;
+    std::deque<Work> works_;
+    int replay_works_ = 0;          // 排队及正在执行的回放任务数
+    bool playback_enabled_ = false;
+    std::atomic<uint32_t> generation_ = 0;
+    TtsCacheStatistics statistics_;
+
+    SentenceState sentence_state_ = kSentenceNone;
+    std::string sentence_hash_;
+    size_t sentence_bytes_ = 0;
+    std::vector<std::unique_ptr<AudioStreamPacket>> recording_;
+
+    bool Mount();
+    static bool IsValidHash(const std::string& hash);
+    std::string GetPath(const std::string& hash) const;
+    void LoadIndex();
+    void SaveIndex();
+    void FinishSentence();
+    void PushWork(Work&& work);
+    void CacheTask();
+    void Replay(const std::string& hash, uint32_t generation);
+    void Store(const std::string& hash, const std::vector<std::unique_ptr<AudioStreamPacket>>& frames);
+};
+
+#endif
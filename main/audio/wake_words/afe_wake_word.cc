@@ -6,173 +6,125 @@
 #include <model_path.h>
 #include <sstream>
 
-#define DETECTION_RUNNING_EVENT 1
-
 #define TAG "AfeWakeWord"
 
-AfeWakeWord::AfeWakeWord() : afe_data_(nullptr), wake_word_pcm_(), wake_word_opus_() { event_group_ = xEventGroupCreate(); }
+// 保留唤醒词前约 2 秒的音频
+#define WAKE_WORD_PCM_SAMPLES (16000 * 2)
+
+AfeWakeWord::AfeWakeWord() : wake_word_pcm_(WAKE_WORD_PCM_SAMPLES, kMemoryPlacementPsram), wake_word_opus_() {}
 
 AfeWakeWord::~AfeWakeWord()
 {
-    if (afe_data_ != nullptr)
-    {
-        afe_iface_->destroy(afe_data_);
-    }
-
     if (wake_word_encode_task_stack_ != nullptr)
     {
-        heap_caps_free(wake_word_encode_task_stack_);
+        MemoryPolicy::GetInstance().Free(kMemoryTagAudio, wake_word_encode_task_stack_);
     }
-
-    vEventGroupDelete(event_group_);
 }
 
 void AfeWakeWord::Initialize(AudioCodec *codec)
 {
     codec_ = codec;
-    int ref_num = codec_->input_reference() ? 1 : 0;
 
-    srmodel_list_t *models = esp_srmodel_init("model");
-    if (models == nullptr || models->num == -1)
+    // AFE 与语音处理共用，wakenet 只在唤醒词检测运行时开启
+    auto &pipeline = AfePipeline::GetInstance();
+    if (!pipeline.Initialize(codec_))
     {
-        ESP_LOGE(TAG, "Failed to initialize wakenet model");
         return;
     }
-    for (int i = 0; i < models->num; i++)
-    {
-        ESP_LOGI(TAG, "Model %d: %s", i, models->model_name[i]);
-        if (strstr(models->model_name[i], ESP_WN_PREFIX) != NULL)
-        {
-            wakenet_model_ = models->model_name[i];
-            auto words = esp_srmodel_get_wake_words(models, wakenet_model_);
-            // split by ";" to get all wake words
-            std::stringstream ss(words);
-            std::string word;
-            while (std::getline(ss, word, ';'))
-            {
-                wake_words_.push_back(word);
-            }
-        }
-    }
-
-    std::string input_format;
-    for (int i = 0; i < codec_->input_channels() - ref_num; i++)
-    {
-        input_format.push_back('M');
-    }
-    for (int i = 0; i < ref_num; i++)
-    {
-        input_format.push_back('R');
-    }
-    afe_config_t *afe_config = afe_config_init(input_format.c_str(), models, AFE_TYPE_SR, AFE_MODE_HIGH_PERF);
-    afe_config->aec_init = codec_->input_reference();
-    afe_config->aec_mode = AEC_MODE_SR_HIGH_PERF;
-    afe_config->afe_perferred_core = 1;
-    afe_config->afe_perferred_priority = 1;
-    afe_config->memory_alloc_mode = AFE_MEMORY_ALLOC_MORE_PSRAM;
-
-    afe_iface_ = esp_afe_handle_from_config(afe_config);
-    afe_data_ = afe_iface_->create_from_config(afe_config);
-
-    xTaskCreate(
-        [](void *arg)
-        {
-            auto this_ = (AfeWakeWord *)arg;
-            this_->AudioDetectionTask();
-            vTaskDelete(NULL);
-        },
-        "audio_detection", 4096, this, 3, nullptr);
+    pipeline.OnFetch(kAfeConsumerWakeWord, [this](afe_fetch_result_t *res) { OnFetch(res); });
 }
 
 void AfeWakeWord::OnWakeWordDetected(std::function<void(const std::string &wake_word)> callback) { wake_word_detected_callback_ = callback; }
 
-void AfeWakeWord::Start() { xEventGroupSetBits(event_group_, DETECTION_RUNNING_EVENT); }
+void AfeWakeWord::Start() { AfePipeline::GetInstance().Activate(kAfeConsumerWakeWord, true); }
 
 void AfeWakeWord::Stop()
 {
-    xEventGroupClearBits(event_group_, DETECTION_RUNNING_EVENT);
-    if (afe_data_ != nullptr)
-    {
-        afe_iface_->reset_buffer(afe_data_);
-    }
+    AfePipeline::GetInstance().Activate(kAfeConsumerWakeWord, false);
+    energy_gate_.Reset();
 
     // 清除唤醒词数据容器以防止使用无效数据
     {
         std::lock_guard<std::mutex> lock(wake_word_mutex_);
-        wake_word_pcm_.clear();
-        wake_word_opus_.clear();
+        wake_word_pcm_.Clear();
+        RecycleWakeWordOpus();
         ESP_LOGI(TAG, "Cleared wake word PCM and Opus data containers");
     }
 }
 
 void AfeWakeWord::Feed(const std::vector<int16_t> &data)
 {
-    if (afe_data_ == nullptr)
+    auto &pipeline = AfePipeline::GetInstance();
+#if CONFIG_WAKE_WORD_ENERGY_GATE
+    // 语音处理同时使用 AFE 时不能门控，否则上行音频会断流
+    if (!pipeline.IsActive(kAfeConsumerVoice))
     {
+        energy_gate_.Process(data.data(), data.size(), codec_->input_channels(),
+                             [&pipeline](const int16_t *chunk, size_t samples) { pipeline.Feed(chunk); });
         return;
     }
-    afe_iface_->feed(afe_data_, data.data());
+#endif
+    pipeline.Feed(data.data());
 }
 
-size_t AfeWakeWord::GetFeedSize()
-{
-    if (afe_data_ == nullptr)
-    {
-        return 0;
-    }
-    return afe_iface_->get_feed_chunksize(afe_data_) * codec_->input_channels();
-}
+size_t AfeWakeWord::GetFeedSize() { return AfePipeline::GetInstance().GetFeedSize(); }
 
-void AfeWakeWord::AudioDetectionTask()
+void AfeWakeWord::OnFetch(afe_fetch_result_t *res)
 {
-    auto fetch_size = afe_iface_->get_fetch_chunksize(afe_data_);
-    auto feed_size = afe_iface_->get_feed_chunksize(afe_data_);
-    ESP_LOGI(TAG, "Audio detection task started, feed size: %d fetch size: %d", feed_size, fetch_size);
+    // Store the wake word data for voice recognition, like who is speaking
+    StoreWakeWordData(res->data, res->data_size / sizeof(int16_t));
 
-    while (true)
+    if (res->wakeup_state == WAKENET_DETECTED)
     {
-        xEventGroupWaitBits(event_group_, DETECTION_RUNNING_EVENT, pdFALSE, pdTRUE, portMAX_DELAY);
+        Stop();
+        auto &wake_words = AfePipeline::GetInstance().wake_words();
+        last_detected_wake_word_ = wake_words[res->wakenet_model_index - 1];
 
-        auto res = afe_iface_->fetch_with_delay(afe_data_, portMAX_DELAY);
-        if (res == nullptr || res->ret_value == ESP_FAIL)
+        if (wake_word_detected_callback_)
         {
-            continue;
-            ;
-        }
-
-        // Store the wake word data for voice recognition, like who is speaking
-        StoreWakeWordData(res->data, res->data_size / sizeof(int16_t));
-
-        if (res->wakeup_state == WAKENET_DETECTED)
-        {
-            Stop();
-            last_detected_wake_word_ = wake_words_[res->wakenet_model_index - 1];
-
-            if (wake_word_detected_callback_)
-            {
-                wake_word_detected_callback_(last_detected_wake_word_);
-            }
+            wake_word_detected_callback_(last_detected_wake_word_);
         }
     }
 }
 
 void AfeWakeWord::StoreWakeWordData(const int16_t *data, size_t samples)
 {
-    // store audio data to wake_word_pcm_
-    wake_word_pcm_.emplace_back(std::vector<int16_t>(data, data + samples));
-    // keep about 2 seconds of data, detect duration is 30ms (sample_rate == 16000, chunksize == 512)
-    while (wake_word_pcm_.size() > 2000 / 30)
+    // 写满后覆盖最旧的数据
+    std::lock_guard<std::mutex> lock(wake_word_mutex_);
+    wake_word_pcm_.Write(data, samples);
+}
+
+// 调用者需持有 wake_word_mutex_。帧数据与池中节点的旧缓冲区交换，opus 换回的缓冲区可供下一帧输出使用
+void AfeWakeWord::PushWakeWordOpus(std::vector<uint8_t> &opus)
+{
+    if (wake_word_opus_pool_.empty())
     {
-        wake_word_pcm_.pop_front();
+        wake_word_opus_.emplace_back();
     }
+    else
+    {
+        wake_word_opus_.splice(wake_word_opus_.end(), wake_word_opus_pool_, wake_word_opus_pool_.begin());
+    }
+    wake_word_opus_.back().swap(opus);
+    opus.clear();
+    wake_word_cv_.notify_all();
+}
+
+// 调用者需持有 wake_word_mutex_
+void AfeWakeWord::RecycleWakeWordOpus()
+{
+    wake_word_opus_pool_.splice(wake_word_opus_pool_.end(), wake_word_opus_);
 }
 
 void AfeWakeWord::EncodeWakeWordData()
 {
-    wake_word_opus_.clear();
+    {
+        std::lock_guard<std::mutex> lock(wake_word_mutex_);
+        RecycleWakeWordOpus();
+    }
     if (wake_word_encode_task_stack_ == nullptr)
     {
-        wake_word_encode_task_stack_ = (StackType_t *)heap_caps_malloc(4096 * 8, MALLOC_CAP_SPIRAM);
+        wake_word_encode_task_stack_ = (StackType_t *)MemoryPolicy::GetInstance().Allocate(kMemoryTagAudio, kMemoryPlacementPsram, 4096 * 8);
     }
     wake_word_encode_task_ = xTaskCreateStatic(
         [](void *arg)
@@ -185,43 +137,40 @@ void AfeWakeWord::EncodeWakeWordData()
 
                 int packets = 0;
 
-                // 创建本地副本以避免在移动过程中的竞态条件
-                std::list<std::vector<int16_t>> local_pcm_data;
+                // 缓冲区留在原处按读游标逐帧取出，每次只在锁内拷贝一帧，编码期间到达的音频照常写入。
+                // 只编码开始时已有的整帧，之后写入的数据留给下一次唤醒
+                const size_t frame_samples = OPUS_FRAME_DURATION_MS * 16000 / 1000;
+                size_t frames;
                 {
                     std::lock_guard<std::mutex> lock(this_->wake_word_mutex_);
-                    // 使用swap避免拷贝，同时确保原容器被清空
-                    local_pcm_data.swap(this_->wake_word_pcm_);
+                    frames = this_->wake_word_pcm_.size() / frame_samples;
                 }
-
-                // 现在安全地处理本地数据
-                for (auto &pcm : local_pcm_data)
+                std::vector<int16_t> pcm;
+                std::vector<uint8_t> opus;
+                for (size_t i = 0; i < frames; i++)
                 {
-                    // 检查PCM数据是否有效
-                    if (pcm.empty())
                     {
-                        ESP_LOGW(TAG, "Skipping empty PCM data packet");
-                        continue;
+                        std::lock_guard<std::mutex> lock(this_->wake_word_mutex_);
+                        if (!this_->wake_word_pcm_.ReadFrame(pcm, frame_samples))
+                        {
+                            break;
+                        }
+                    }
+                    if (encoder->Encode(std::move(pcm), opus))
+                    {
+                        std::lock_guard<std::mutex> lock(this_->wake_word_mutex_);
+                        this_->PushWakeWordOpus(opus);
+                        packets++;
                     }
-
-                    encoder->Encode(std::move(pcm),
-                                    [this_](std::vector<uint8_t> &&opus)
-                                    {
-                                        std::lock_guard<std::mutex> lock(this_->wake_word_mutex_);
-                                        this_->wake_word_opus_.emplace_back(std::move(opus));
-                                        this_->wake_word_cv_.notify_all();
-                                    });
-                    packets++;
                 }
 
-                // 清空本地数据（虽然已经被移动了，但保持一致性）
-                local_pcm_data.clear();
-
                 auto end_time = esp_timer_get_time();
                 ESP_LOGI(TAG, "Encode wake word opus %d packets in %ld ms", packets, (long)((end_time - start_time) / 1000));
 
+                // 空帧表示结束
                 std::lock_guard<std::mutex> lock(this_->wake_word_mutex_);
-                this_->wake_word_opus_.push_back(std::vector<uint8_t>());
-                this_->wake_word_cv_.notify_all();
+                opus.clear();
+                this_->PushWakeWordOpus(opus);
             }
             vTaskDelete(NULL);
         },
@@ -233,6 +182,7 @@ bool AfeWakeWord::GetWakeWordOpus(std::vector<uint8_t> &opus)
     std::unique_lock<std::mutex> lock(wake_word_mutex_);
     wake_word_cv_.wait(lock, [this]() { return !wake_word_opus_.empty(); });
     opus.swap(wake_word_opus_.front());
-    wake_word_opus_.pop_front();
+    // 节点中换入的是调用者原来的缓冲区，放回池中复用
+    wake_word_opus_pool_.splice(wake_word_opus_pool_.end(), wake_word_opus_, wake_word_opus_.begin());
     return !opus.empty();
 }
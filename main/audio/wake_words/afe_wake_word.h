@@ -17,6 +17,9 @@
 
 #include "audio_codec.h"
 #include "wake_word.h"
+#include "processors/afe_pipeline.h"
+#include "energy_gate.h"
+#include "pcm_ring_buffer.h"
 
 class AfeWakeWord : public WakeWord {
 public:
@@ -34,25 +37,24 @@ public:
     const std::string& GetLastDetectedWakeWord() const { return last_detected_wake_word_; }
 
 private:
-    esp_afe_sr_iface_t* afe_iface_ = nullptr;
-    esp_afe_sr_data_t* afe_data_ = nullptr;
-    char* wakenet_model_ = NULL;
-    std::vector<std::string> wake_words_;
-    EventGroupHandle_t event_group_;
     std::function<void(const std::string& wake_word)> wake_word_detected_callback_;
     AudioCodec* codec_ = nullptr;
     std::string last_detected_wake_word_;
+    EnergyGate energy_gate_;
 
     TaskHandle_t wake_word_encode_task_ = nullptr;
     StaticTask_t wake_word_encode_task_buffer_;
     StackType_t* wake_word_encode_task_stack_ = nullptr;
-    std::list<std::vector<int16_t>> wake_word_pcm_;
+    PcmRingBuffer wake_word_pcm_;   // 唤醒词前约 2 秒的音频，用于声纹识别
     std::list<std::vector<uint8_t>> wake_word_opus_;
+    std::list<std::vector<uint8_t>> wake_word_opus_pool_;   // 已取走的 Opus 帧节点，保留容量供下次复用
     std::mutex wake_word_mutex_;
     std::condition_variable wake_word_cv_;
 
     void StoreWakeWordData(const int16_t* data, size_t size);
-    void AudioDetectionTask();
+    void PushWakeWordOpus(std::vector<uint8_t>& opus);
+    void RecycleWakeWordOpus();
+    void OnFetch(afe_fetch_result_t* res);
 };
 
 #endif
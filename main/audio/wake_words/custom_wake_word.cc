@@ -17,10 +17,13 @@
 
 #define TAG "CustomWakeWord"
 
+// 保留唤醒词前约 2 秒的音频
+#define WAKE_WORD_PCM_SAMPLES (16000 * 2)
+
 
 CustomWakeWord::CustomWakeWord()
     : afe_data_(nullptr),
-      wake_word_pcm_(),
+      wake_word_pcm_(WAKE_WORD_PCM_SAMPLES, kMemoryPlacementPsram),
       wake_word_opus_() {
 
     event_group_ = xEventGroupCreate();
@@ -32,7 +35,7 @@ CustomWakeWord::~CustomWakeWord() {
     }
 
     if (wake_word_encode_task_stack_ != nullptr) {
-        heap_caps_free(wake_word_encode_task_stack_);
+        MemoryPolicy::GetInstance().Free(kMemoryTagAudio, wake_word_encode_task_stack_);
     }
 
     vEventGroupDelete(event_group_);
@@ -85,13 +88,21 @@ void CustomWakeWord::Stop() {
     if (afe_data_ != nullptr) {
         afe_iface_->reset_buffer(afe_data_);
     }
+    energy_gate_.Reset();
 }
 
 void CustomWakeWord::Feed(const std::vector<int16_t>& data) {
     if (afe_data_ == nullptr) {
         return;
     }
+#if CONFIG_WAKE_WORD_ENERGY_GATE
+    // 门控关闭时不送入 AFE，fetch 任务与 multinet 都处于空闲状态
+    energy_gate_.Process(data.data(), data.size(), codec_->input_channels(), [this](const int16_t* chunk, size_t samples) {
+        afe_iface_->feed(afe_data_, chunk);
+    });
+#else
     afe_iface_->feed(afe_data_, data.data());
+#endif
 }
 
 size_t CustomWakeWord::GetFeedSize() {
@@ -184,18 +195,35 @@ void CustomWakeWord::AudioDetectionTask() {
 }
 
 void CustomWakeWord::StoreWakeWordData(const int16_t* data, size_t samples) {
-    // store audio data to wake_word_pcm_
-    wake_word_pcm_.emplace_back(std::vector<int16_t>(data, data + samples));
-    // keep about 2 seconds of data, detect duration is 30ms (sample_rate == 16000, chunksize == 512)
-    while (wake_word_pcm_.size() > 2000 / 30) {
-        wake_word_pcm_.pop_front();
+    // 写满后覆盖最旧的数据
+    std::lock_guard<std::mutex> lock(wake_word_mutex_);
+    wake_word_pcm_.Write(data, samples);
+}
+
+// 调用者需持有 wake_word_mutex_。帧数据与池中节点的旧缓冲区交换，opus 换回的缓冲区可供下一帧输出使用
+void CustomWakeWord::PushWakeWordOpus(std::vector<uint8_t>& opus) {
+    if (wake_word_opus_pool_.empty()) {
+        wake_word_opus_.emplace_back();
+    } else {
+        wake_word_opus_.splice(wake_word_opus_.end(), wake_word_opus_pool_, wake_word_opus_pool_.begin());
     }
+    wake_word_opus_.back().swap(opus);
+    opus.clear();
+    wake_word_cv_.notify_all();
+}
+
+// 调用者需持有 wake_word_mutex_
+void CustomWakeWord::RecycleWakeWordOpus() {
+    wake_word_opus_pool_.splice(wake_word_opus_pool_.end(), wake_word_opus_);
 }
 
 void CustomWakeWord::EncodeWakeWordData() {
-    wake_word_opus_.clear();
+    {
+        std::lock_guard<std::mutex> lock(wake_word_mutex_);
+        RecycleWakeWordOpus();
+    }
     if (wake_word_encode_task_stack_ == nullptr) {
-        wake_word_encode_task_stack_ = (StackType_t*)heap_caps_malloc(4096 * 8, MALLOC_CAP_SPIRAM);
+        wake_word_encode_task_stack_ = (StackType_t*)MemoryPolicy::GetInstance().Allocate(kMemoryTagAudio, kMemoryPlacementPsram, 4096 * 8);
     }
     wake_word_encode_task_ = xTaskCreateStatic([](void* arg) {
         auto this_ = (CustomWakeWord*)arg;
@@ -204,23 +232,38 @@ void CustomWakeWord::EncodeWakeWordData() {
             auto encoder = std::make_unique<OpusEncoderWrapper>(16000, 1, OPUS_FRAME_DURATION_MS);
             encoder->SetComplexity(0); // 0 is the fastest
 
+            // 缓冲区留在原处按读游标逐帧取出，每次只在锁内拷贝一帧，编码期间到达的音频照常写入。
+            // 只编码开始时已有的整帧，之后写入的数据留给下一次唤醒
+            const size_t frame_samples = OPUS_FRAME_DURATION_MS * 16000 / 1000;
+            size_t frames;
+            {
+                std::lock_guard<std::mutex> lock(this_->wake_word_mutex_);
+                frames = this_->wake_word_pcm_.size() / frame_samples;
+            }
+
             int packets = 0;
-            for (auto& pcm: this_->wake_word_pcm_) {
-                encoder->Encode(std::move(pcm), [this_](std::vector<uint8_t>&& opus) {
+            std::vector<int16_t> pcm;
+            std::vector<uint8_t> opus;
+            for (size_t i = 0; i < frames; i++) {
+                {
+                    std::lock_guard<std::mutex> lock(this_->wake_word_mutex_);
+                    if (!this_->wake_word_pcm_.ReadFrame(pcm, frame_samples)) {
+                        break;
+                    }
+                }
+                if (encoder->Encode(std::move(pcm), opus)) {
                     std::lock_guard<std::mutex> lock(this_->wake_word_mutex_);
-                    this_->wake_word_opus_.emplace_back(std::move(opus));
-                    this_->wake_word_cv_.notify_all();
-                });
-                packets++;
+                    this_->PushWakeWordOpus(opus);
+                    packets++;
+                }
             }
-            this_->wake_word_pcm_.clear();
-
             auto end_time = esp_timer_get_time();
             ESP_LOGI(TAG, "Encode wake word opus %d packets in %ld ms", packets, (long)((end_time - start_time) / 1000));
 
+            // 空帧表示结束
             std::lock_guard<std::mutex> lock(this_->wake_word_mutex_);
-            this_->wake_word_opus_.push_back(std::vector<uint8_t>());
-            this_->wake_word_cv_.notify_all();
+            opus.clear();
+            this_->PushWakeWordOpus(opus);
         }
         vTaskDelete(NULL);
     }, "encode_detect_packets", 4096 * 8, this, 2, wake_word_encode_task_stack_, &wake_word_encode_task_buffer_);
@@ -232,6 +275,7 @@ bool CustomWakeWord::GetWakeWordOpus(std::vector<uint8_t>& opus) {
         return !wake_word_opus_.empty();
     });
     opus.swap(wake_word_opus_.front());
-    wake_word_opus_.pop_front();
+    // 节点中换入的是调用者原来的缓冲区，放回池中复用
+    wake_word_opus_pool_.splice(wake_word_opus_pool_.end(), wake_word_opus_, wake_word_opus_.begin());
     return !opus.empty();
 }
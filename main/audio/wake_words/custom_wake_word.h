@@ -22,6 +22,8 @@
 
 #include "audio_codec.h"
 #include "wake_word.h"
+#include "energy_gate.h"
+#include "pcm_ring_buffer.h"
 
 class CustomWakeWord : public WakeWord {
 public:
@@ -49,16 +51,20 @@ private:
     std::function<void(const std::string& wake_word)> wake_word_detected_callback_;
     AudioCodec* codec_ = nullptr;
     std::string last_detected_wake_word_;
+    EnergyGate energy_gate_;
 
     TaskHandle_t wake_word_encode_task_ = nullptr;
     StaticTask_t wake_word_encode_task_buffer_;
     StackType_t* wake_word_encode_task_stack_ = nullptr;
-    std::list<std::vector<int16_t>> wake_word_pcm_;
+    PcmRingBuffer wake_word_pcm_;   // 唤醒词前约 2 秒的音频
     std::list<std::vector<uint8_t>> wake_word_opus_;
+    std::list<std::vector<uint8_t>> wake_word_opus_pool_;   // 已取走的 Opus 帧节点，保留容量供下次复用
     std::mutex wake_word_mutex_;
     std::condition_variable wake_word_cv_;
 
     void StoreWakeWordData(const int16_t* data, size_t size);
+    void PushWakeWordOpus(std::vector<uint8_t>& opus);
+    void RecycleWakeWordOpus();
     void AudioDetectionTask();
 };
 
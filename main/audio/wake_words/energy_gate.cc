@@ -0,0 +1,86 @@
+#include "energy_gate.h"
+
+#include <esp_log.h>
+#include <esp_timer.h>
+#include <algorithm>
+#include <cmath>
+
+#define TAG "EnergyGate"
+
+// 能量需高于噪声底 4 倍（约 6dB），且不低于绝对门限（RMS 约 60），避免在极安静环境中被底噪触发
+#define ENERGY_GATE_RATIO 4.0f
+#define ENERGY_GATE_MIN_ENERGY (60.0f * 60.0f)
+
+void EnergyGate::Process(const int16_t* data, size_t samples, int channels, Forward forward) {
+    size_t frames = samples / channels;
+    if (frames == 0) {
+        return;
+    }
+    int duration_ms = frames * 1000 / 16000;
+    if (samples != chunk_samples_) {
+        // 块大小由检测器的 feed 大小决定，运行中不变，只在首次或切换检测器时重设容量
+        chunk_samples_ = samples;
+        size_t chunks = std::max(1, ENERGY_GATE_PREBUFFER_MS / std::max(1, duration_ms));
+        prebuffer_.SetCapacity(chunks * samples, kMemoryPlacementPsram);
+    }
+
+    float energy = 0;
+    for (size_t i = 0; i < samples; i += channels) {
+        energy += (float)data[i] * data[i];
+    }
+    energy /= frames;
+
+    // 噪声底快速跟随下降、缓慢跟随上升，持续的人声不会很快把门限抬高
+    if (noise_floor_ == 0 || energy < noise_floor_) {
+        noise_floor_ = energy;
+    } else {
+        noise_floor_ += (energy - noise_floor_) * 0.002f;
+    }
+
+    bool active = energy > noise_floor_ * ENERGY_GATE_RATIO && energy > ENERGY_GATE_MIN_ENERGY;
+    if (active) {
+        hangover_ms_ = ENERGY_GATE_HANGOVER_MS;
+    } else if (hangover_ms_ > 0) {
+        hangover_ms_ -= duration_ms;
+    }
+
+    report_total_ms_ += duration_ms;
+    if (active || hangover_ms_ > 0) {
+        int64_t start_time = esp_timer_get_time();
+        if (!open_) {
+            open_ = true;
+            report_openings_++;
+            while (prebuffer_.ReadFrame(chunk_, chunk_samples_)) {
+                forward(chunk_.data(), chunk_.size());
+            }
+        }
+        forward(data, samples);
+        report_forward_us_ += esp_timer_get_time() - start_time;
+        report_open_ms_ += duration_ms;
+    } else {
+        open_ = false;
+        // 容量是块大小的整数倍，写满时整块覆盖最旧的数据
+        prebuffer_.Write(data, samples);
+    }
+
+    if (report_total_ms_ >= ENERGY_GATE_REPORT_INTERVAL_MS) {
+        Report();
+    }
+}
+
+void EnergyGate::Reset() {
+    prebuffer_.Clear();
+    hangover_ms_ = 0;
+    open_ = false;
+}
+
+void EnergyGate::Report() {
+    // 检测器只在门控打开期间运行，占空比即为相对于不门控时的检测负载
+    ESP_LOGI(TAG, "Gate open %.1f%% of %lld s (%d openings), forward time %lld ms, noise floor rms %.0f",
+        report_open_ms_ * 100.0f / report_total_ms_, report_total_ms_ / 1000, report_openings_,
+        report_forward_us_ / 1000, std::sqrt(noise_floor_));
+    report_total_ms_ = 0;
+    report_open_ms_ = 0;
+    report_forward_us_ = 0;
+    report_openings_ = 0;
+}
@@ -0,0 +1,46 @@
+#ifndef ENERGY_GATE_H
+#define ENERGY_GATE_H
+
+#include <cstdint>
+#include <functional>
+#include <vector>
+
+#include "pcm_ring_buffer.h"
+
+#define ENERGY_GATE_PREBUFFER_MS 320          // 门控打开时补送的历史音频，覆盖唤醒词的起始部分
+#define ENERGY_GATE_HANGOVER_MS 2000          // 最后一次检测到声音后保持打开的时间
+#define ENERGY_GATE_REPORT_INTERVAL_MS 60000  // 占空比统计的输出间隔
+
+/*
+ * 唤醒词检测前的能量门控：
+ * 安静时只做一次均方能量计算，把音频块存进预缓冲区而不交给神经网络检测器；
+ * 能量超过自适应噪声底一定倍数时打开，先补送预缓冲区再送当前块，保证不漏掉唤醒词开头。
+ */
+class EnergyGate {
+public:
+    using Forward = std::function<void(const int16_t* data, size_t samples)>;
+
+    // channels 为交织的通道数，能量只按第一个（麦克风）通道计算
+    void Process(const int16_t* data, size_t samples, int channels, Forward forward);
+    void Reset();
+    bool is_open() const { return open_; }
+
+private:
+    // 容量为整数个音频块，首次写入时在 PSRAM 上一次性分配，之后只做 memcpy
+    PcmRingBuffer prebuffer_;
+    size_t chunk_samples_ = 0;
+    // 补送时按块读出，检测器每次 feed 要求完整的一块
+    std::vector<int16_t> chunk_;
+    float noise_floor_ = 0;
+    bool open_ = false;
+    int hangover_ms_ = 0;
+
+    int64_t report_total_ms_ = 0;
+    int64_t report_open_ms_ = 0;
+    int64_t report_forward_us_ = 0;
+    int report_openings_ = 0;
+
+    void Report();
+};
+
+#endif // ENERGY_GATE_H
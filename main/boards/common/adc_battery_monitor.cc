@@ -1,7 +1,23 @@
 #include "adc_battery_monitor.h"
 
-AdcBatteryMonitor::AdcBatteryMonitor(adc_unit_t adc_unit, adc_channel_t adc_channel, float upper_resistor, float lower_resistor, gpio_num_t charging_pin)
-    : charging_pin_(charging_pin) {
+#include <esp_log.h>
+#include <algorithm>
+#include <cmath>
+
+#define TAG "AdcBatteryMonitor"
+
+// 每隔多少次定时器回调（1 秒）采样一次电量
+#define BATTERY_SAMPLE_INTERVAL_TICKS 5
+// 充放电切换后电压会跳变，等待几次定时器回调（秒）稳定后再重新开始滤波
+#define BATTERY_CHARGING_SETTLE_TICKS 3
+// 连续播放时最多跳过的采样次数，之后以较小的权重接受，避免长时间播放时电量不更新
+#define BATTERY_MAX_SKIPPED_SAMPLES 12
+#define BATTERY_FILTER_ALPHA 0.2f
+#define BATTERY_FILTER_ALPHA_UNDER_LOAD 0.05f
+
+AdcBatteryMonitor::AdcBatteryMonitor(adc_unit_t adc_unit, adc_channel_t adc_channel, float upper_resistor, float lower_resistor,
+    gpio_num_t charging_pin, std::function<bool()> load_probe)
+    : charging_pin_(charging_pin), load_probe_(load_probe) {
     
     // Initialize charging pin
     gpio_config_t gpio_cfg = {
@@ -31,6 +47,13 @@ AdcBatteryMonitor::AdcBatteryMonitor(adc_unit_t adc_unit, adc_channel_t adc_chan
     adc_cfg.charging_detect_user_data = this;
     adc_battery_estimation_handle_ = adc_battery_estimation_create(&adc_cfg);
 
+    // 启动时音频尚未输出，直接用第一次读数作为初始值
+    float capacity = 0;
+    if (adc_battery_estimation_get_capacity(adc_battery_estimation_handle_, &capacity) == ESP_OK) {
+        filtered_capacity_ = capacity;
+        battery_level_ = std::max(0, std::min(100, (int)lroundf(capacity)));
+    }
+
     // Initialize timer
     esp_timer_create_args_t timer_cfg = {
         .callback = [](void *arg) {
@@ -45,6 +68,10 @@ AdcBatteryMonitor::AdcBatteryMonitor(adc_unit_t adc_unit, adc_channel_t adc_chan
 }
 
 AdcBatteryMonitor::~AdcBatteryMonitor() {
+    if (timer_handle_) {
+        esp_timer_stop(timer_handle_);
+        esp_timer_delete(timer_handle_);
+    }
     if (adc_battery_estimation_handle_) {
         ESP_ERROR_CHECK(adc_battery_estimation_destroy(adc_battery_estimation_handle_));
     }
@@ -61,9 +88,7 @@ bool AdcBatteryMonitor::IsDischarging() {
 }
 
 uint8_t AdcBatteryMonitor::GetBatteryLevel() {
-    float capacity = 0;
-    ESP_ERROR_CHECK(adc_battery_estimation_get_capacity(adc_battery_estimation_handle_, &capacity));
-    return capacity;
+    return battery_level_;
 }
 
 void AdcBatteryMonitor::OnChargingStatusChanged(std::function<void(bool)> callback) {
@@ -77,5 +102,52 @@ void AdcBatteryMonitor::CheckBatteryStatus() {
         if (on_charging_status_changed_) {
             on_charging_status_changed_(is_charging_);
         }
+        // 充放电切换时电压会跳变，推迟采样，稳定后丢弃旧的滤波值重新开始
+        settle_ticks_ = BATTERY_CHARGING_SETTLE_TICKS;
+        return;
+    }
+
+    if (settle_ticks_ > 0) {
+        if (--settle_ticks_ > 0) {
+            return;
+        }
+        filtered_capacity_ = -1;
+        skipped_samples_ = 0;
+        ticks_ = 0;
+    }
+
+    if (ticks_ % BATTERY_SAMPLE_INTERVAL_TICKS == 0) {
+        SampleCapacity();
+    }
+    ticks_++;
+}
+
+void AdcBatteryMonitor::SampleCapacity() {
+    bool under_load = load_probe_ ? load_probe_() : false;
+    if (under_load && filtered_capacity_ >= 0 && skipped_samples_ < BATTERY_MAX_SKIPPED_SAMPLES) {
+        skipped_samples_++;
+        return;
+    }
+
+    float capacity = 0;
+    if (adc_battery_estimation_get_capacity(adc_battery_estimation_handle_, &capacity) != ESP_OK) {
+        ESP_LOGW(TAG, "Failed to read battery capacity");
+        return;
+    }
+    skipped_samples_ = 0;
+
+    bool first_sample = filtered_capacity_ < 0;
+    if (first_sample) {
+        filtered_capacity_ = capacity;
+    } else {
+        float alpha = under_load ? BATTERY_FILTER_ALPHA_UNDER_LOAD : BATTERY_FILTER_ALPHA;
+        filtered_capacity_ += alpha * (capacity - filtered_capacity_);
     }
-}
\ No newline at end of file
+
+    // 放电时电量只降不升，充电时只升不降，避免负载变化引起图标来回跳动
+    int level = std::max(0, std::min(100, (int)lroundf(filtered_capacity_)));
+    int current = battery_level_;
+    if (first_sample || (is_charging_ && level > current) || (!is_charging_ && level < current)) {
+        battery_level_ = level;
+    }
+}
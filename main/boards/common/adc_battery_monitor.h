@@ -5,14 +5,18 @@
 #include <driver/gpio.h>
 #include <adc_battery_estimation.h>
 #include <esp_timer.h>
+#include <atomic>
 
 class AdcBatteryMonitor {
 public:
-    AdcBatteryMonitor(adc_unit_t adc_unit, adc_channel_t adc_channel, float upper_resistor, float lower_resistor, gpio_num_t charging_pin = GPIO_NUM_NC);
+    // load_probe 在定时器任务中调用，返回 true 表示扬声器等大负载正在工作，此时电池电压偏低、采样不可信
+    AdcBatteryMonitor(adc_unit_t adc_unit, adc_channel_t adc_channel, float upper_resistor, float lower_resistor,
+        gpio_num_t charging_pin = GPIO_NUM_NC, std::function<bool()> load_probe = nullptr);
     ~AdcBatteryMonitor();
 
     bool IsCharging();
     bool IsDischarging();
+    // 返回定时采样并滤波后的电量，不访问 ADC
     uint8_t GetBatteryLevel();
 
     void OnChargingStatusChanged(std::function<void(bool)> callback);
@@ -23,8 +27,17 @@ private:
     esp_timer_handle_t timer_handle_ = nullptr;
     bool is_charging_ = false;
     std::function<void(bool)> on_charging_status_changed_;
+    std::function<bool()> load_probe_;
+
+    // 以下由定时器回调维护
+    int ticks_ = 0;
+    int skipped_samples_ = 0;
+    int settle_ticks_ = 0;          // 充放电切换后等待电压稳定的剩余次数
+    float filtered_capacity_ = -1;
+    std::atomic<uint8_t> battery_level_ = 0;
 
     void CheckBatteryStatus();
+    void SampleCapacity();
 };
 
 #endif // ADC_BATTERY_MONITOR_H
@@ -11,99 +11,6 @@ namespace audio_wifi_config
 {
     static const char *kLogTag = "AUDIO_WIFI_CONFIG";
 
-    void ReceiveWifiCredentialsFromAudio(Application *app,
-                                       WifiConfigurationAp *wifi_ap)
-    {
-        const int kInputSampleRate = 16000;                                    // Input sampling rate
-        const float kDownsampleStep = static_cast<float>(kInputSampleRate) / static_cast<float>(kAudioSampleRate); // Downsampling step
-        std::vector<int16_t> audio_data;
-        AudioSignalProcessor signal_processor(kAudioSampleRate, kMarkFrequency, kSpaceFrequency, kBitRate, kWindowSize);
-        AudioDataBuffer data_buffer;
-
-        while (true)
-        {
-            // 检查Application状态，只有在WiFi配置模式下才处理音频
-            if (app->GetDeviceState() != kDeviceStateWifiConfiguring) {
-                // 不在WiFi配置状态，休眠100ms后再检查
-                vTaskDelay(pdMS_TO_TICKS(100));
-                continue;
-            }
-            
-            if (!app->GetAudioService().ReadAudioData(audio_data, 16000, 480)) { // 16kHz, 480 samples corresponds to 30ms data
-                // 读取音频失败，短暂延迟后重试
-                ESP_LOGI(kLogTag, "Failed to read audio data, retrying.");
-                vTaskDelay(pdMS_TO_TICKS(10));
-                continue;
-            }
-            
-            // Downsample the audio data
-            std::vector<float> downsampled_data;
-            size_t last_index = 0;
-
-            if (kDownsampleStep > 1.0f)
-            {
-                downsampled_data.reserve(audio_data.size() / static_cast<size_t>(kDownsampleStep));
-                for (size_t i = 0; i < audio_data.size(); ++i)
-                {
-                    size_t sample_index = static_cast<size_t>(i / kDownsampleStep);
-                    if ((sample_index + 1) > last_index)
-                    {
-                        downsampled_data.push_back(static_cast<float>(audio_data[i]));
-                        last_index = sample_index + 1;
-                    }
-                }
-            }
-            else
-            {
-                downsampled_data.reserve(audio_data.size());
-                for (int16_t sample : audio_data)
-                {
-                    downsampled_data.push_back(static_cast<float>(sample));
-                }
-            }
-            
-            // Process audio samples to get probability data
-            auto probabilities = signal_processor.ProcessAudioSamples(downsampled_data);
-            
-            // Feed probability data to the data buffer
-            if (data_buffer.ProcessProbabilityData(probabilities, 0.5f))
-            {
-                // If complete data was received, extract WiFi credentials
-                if (data_buffer.decoded_text.has_value())
-                {
-                    ESP_LOGI(kLogTag, "Received text data: %s", data_buffer.decoded_text->c_str());
-                    
-                    // Split SSID and password by newline character
-                    std::string wifi_ssid, wifi_password;
-                    size_t newline_position = data_buffer.decoded_text->find('\n');
-                    if (newline_position != std::string::npos)
-                    {
-                        wifi_ssid = data_buffer.decoded_text->substr(0, newline_position);
-                        wifi_password = data_buffer.decoded_text->substr(newline_position + 1);
-                        ESP_LOGI(kLogTag, "WiFi SSID: %s, Password: %s", wifi_ssid.c_str(), wifi_password.c_str());
-                    }
-                    else
-                    {
-                        ESP_LOGE(kLogTag, "Invalid data format, no newline character found");
-                        continue;
-                    }
-                    
-                    if (wifi_ap->ConnectToWifi(wifi_ssid, wifi_password))
-                    {
-                        wifi_ap->Save(wifi_ssid, wifi_password);  // Save WiFi credentials
-                        esp_restart();                            // Restart device to apply new WiFi configuration
-                    }
-                    else
-                    {
-                        ESP_LOGE(kLogTag, "Failed to connect to WiFi with received credentials");
-                    }
-                    data_buffer.decoded_text.reset();  // Clear processed data
-                }
-            }
-            vTaskDelay(pdMS_TO_TICKS(1));  // 1ms delay
-        }
-    }
-
     // Default start and end transmission identifiers
     // \x01\x02 = 00000001 00000010
     const std::vector<uint8_t> kDefaultStartTransmissionPattern = {
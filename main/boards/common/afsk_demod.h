@@ -1,13 +1,16 @@
 #pragma once
 
+#include <cstddef>
+#include <cstdint>
 #include <vector>
 #include <deque>
 #include <string>
 #include <memory>
 #include <optional>
 #include <cmath>
-#include "wifi_configuration_ap.h"
-#include "application.h"
+
+class Application;
+class WifiConfigurationAp;
 
 // Audio signal processing constants for WiFi configuration via audio
 const size_t kAudioSampleRate = 6400;
@@ -18,7 +21,7 @@ const size_t kWindowSize = 64;
 
 namespace audio_wifi_config
 {
-    // Main function to receive WiFi credentials through audio signal
+    // Main function to receive WiFi credentials through audio signal (audio_wifi_config.cc)
     void ReceiveWifiCredentialsFromAudio(Application *app, WifiConfigurationAp *wifi_ap);
 
     /**
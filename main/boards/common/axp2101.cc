@@ -6,11 +6,17 @@
 
 #define TAG "Axp2101"
 
+// 状态栏每秒查询一次充放电状态和电量，同一次查询中的多次读取共用一次突发读取
+#define AXP2101_STATUS_MAX_AGE_MS 500
+#define AXP2101_GAUGE_MAX_AGE_MS 5000
+
 Axp2101::Axp2101(i2c_master_bus_handle_t i2c_bus, uint8_t addr) : I2cDevice(i2c_bus, addr) {
+    AddCacheRange(0x00, 2, AXP2101_STATUS_MAX_AGE_MS);     // PMU 状态 1/2
+    AddCacheRange(0xA4, 2, AXP2101_GAUGE_MAX_AGE_MS);      // 电量百分比、温度
 }
 
 int Axp2101::GetBatteryCurrentDirection() {
-    return (ReadReg(0x01) & 0b01100000) >> 5;
+    return (ReadCachedReg(0x01) & 0b01100000) >> 5;
 }
 
 bool Axp2101::IsCharging() {
@@ -22,20 +28,18 @@ bool Axp2101::IsDischarging() {
 }
 
 bool Axp2101::IsChargingDone() {
-    uint8_t value = ReadReg(0x01);
+    uint8_t value = ReadCachedReg(0x01);
     return (value & 0b00000111) == 0b00000100;
 }
 
 int Axp2101::GetBatteryLevel() {
-    return ReadReg(0xA4);
+    return ReadCachedReg(0xA4);
 }
 
 float Axp2101::GetTemperature() {
-    return ReadReg(0xA5);
+    return ReadCachedReg(0xA5);
 }
 
 void Axp2101::PowerOff() {
-    uint8_t value = ReadReg(0x10);
-    value = value | 0x01;
-    WriteReg(0x10, value);
+    UpdateRegBits(0x10, 0x01, 0x01);
 }
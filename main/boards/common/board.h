@@ -6,6 +6,7 @@
 #include <mqtt.h>
 #include <udp.h>
 #include <string>
+#include <vector>
 #include <network_interface.h>
 
 #include "led/led.h"
@@ -43,6 +44,10 @@ public:
     virtual Display* GetDisplay();
     virtual Camera* GetCamera();
     virtual NetworkInterface* GetNetwork() = 0;
+    // 当前可用于建立连接的网络接口，首选在前；双网络板卡据此做连接竞速
+    virtual std::vector<NetworkInterface*> GetNetworks() { return { GetNetwork() }; }
+    // 切换到已就绪的备用网络，没有备用网络时返回 false
+    virtual bool FailoverNetwork() { return false; }
     virtual void StartNetwork() = 0;
     virtual const char* GetNetworkStateIcon() = 0;
     virtual bool GetBatteryLevel(int &level, bool& charging, bool& discharging);
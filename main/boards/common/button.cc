@@ -36,21 +36,49 @@ Button::Button(gpio_num_t gpio_num, bool active_high, uint16_t long_press_time,
 }
 
 Button::~Button() {
+    DetachInputSource();
     if (button_handle_ != NULL) {
         iot_button_delete(button_handle_);
     }
 }
 
+// 在 input 任务中执行，驱动回调只负责投递事件
+void Button::DispatchInputEvent(const InputEvent& event) {
+    std::function<void()>* callback = nullptr;
+    switch (event.type) {
+    case kInputEventPressDown:
+        callback = &on_press_down_;
+        break;
+    case kInputEventPressUp:
+        callback = &on_press_up_;
+        break;
+    case kInputEventLongPress:
+        callback = &on_long_press_;
+        break;
+    case kInputEventClick:
+        callback = &on_click_;
+        break;
+    case kInputEventDoubleClick:
+        callback = &on_double_click_;
+        break;
+    case kInputEventMultipleClick:
+        callback = &on_multiple_click_;
+        break;
+    default:
+        break;
+    }
+    if (callback != nullptr && *callback) {
+        (*callback)();
+    }
+}
+
 void Button::OnPressDown(std::function<void()> callback) {
     if (button_handle_ == nullptr) {
         return;
     }
     on_press_down_ = callback;
     iot_button_register_cb(button_handle_, BUTTON_PRESS_DOWN, nullptr, [](void* handle, void* usr_data) {
-        Button* button = static_cast<Button*>(usr_data);
-        if (button->on_press_down_) {
-            button->on_press_down_();
-        }
+        InputDispatcher::GetInstance().Post(static_cast<Button*>(usr_data), kInputEventPressDown);
     }, this);
 }
 
@@ -60,10 +88,7 @@ void Button::OnPressUp(std::function<void()> callback) {
     }
     on_press_up_ = callback;
     iot_button_register_cb(button_handle_, BUTTON_PRESS_UP, nullptr, [](void* handle, void* usr_data) {
-        Button* button = static_cast<Button*>(usr_data);
-        if (button->on_press_up_) {
-            button->on_press_up_();
-        }
+        InputDispatcher::GetInstance().Post(static_cast<Button*>(usr_data), kInputEventPressUp);
     }, this);
 }
 
@@ -73,10 +98,7 @@ void Button::OnLongPress(std::function<void()> callback) {
     }
     on_long_press_ = callback;
     iot_button_register_cb(button_handle_, BUTTON_LONG_PRESS_START, nullptr, [](void* handle, void* usr_data) {
-        Button* button = static_cast<Button*>(usr_data);
-        if (button->on_long_press_) {
-            button->on_long_press_();
-        }
+        InputDispatcher::GetInstance().Post(static_cast<Button*>(usr_data), kInputEventLongPress);
     }, this);
 }
 
@@ -86,10 +108,7 @@ void Button::OnClick(std::function<void()> callback) {
     }
     on_click_ = callback;
     iot_button_register_cb(button_handle_, BUTTON_SINGLE_CLICK, nullptr, [](void* handle, void* usr_data) {
-        Button* button = static_cast<Button*>(usr_data);
-        if (button->on_click_) {
-            button->on_click_();
-        }
+        InputDispatcher::GetInstance().Post(static_cast<Button*>(usr_data), kInputEventClick);
     }, this);
 }
 
@@ -99,10 +118,7 @@ void Button::OnDoubleClick(std::function<void()> callback) {
     }
     on_double_click_ = callback;
     iot_button_register_cb(button_handle_, BUTTON_DOUBLE_CLICK, nullptr, [](void* handle, void* usr_data) {
-        Button* button = static_cast<Button*>(usr_data);
-        if (button->on_double_click_) {
-            button->on_double_click_();
-        }
+        InputDispatcher::GetInstance().Post(static_cast<Button*>(usr_data), kInputEventDoubleClick);
     }, this);
 }
 
@@ -117,9 +133,6 @@ void Button::OnMultipleClick(std::function<void()> callback, uint8_t click_count
         }
     };
     iot_button_register_cb(button_handle_, BUTTON_MULTIPLE_CLICK, &event_args, [](void* handle, void* usr_data) {
-        Button* button = static_cast<Button*>(usr_data);
-        if (button->on_multiple_click_) {
-            button->on_multiple_click_();
-        }
+        InputDispatcher::GetInstance().Post(static_cast<Button*>(usr_data), kInputEventMultipleClick);
     }, this);
 }
\ No newline at end of file
@@ -8,7 +8,9 @@
 #include <button_gpio.h>
 #include <functional>
 
-class Button {
+#include "input_event.h"
+
+class Button : public InputSource {
 public:
     Button(button_handle_t button_handle);
     Button(gpio_num_t gpio_num, bool active_high = false, uint16_t long_press_time = 0, uint16_t short_press_time = 0, bool enable_power_save = false);
@@ -20,6 +22,7 @@ public:
     void OnClick(std::function<void()> callback);
     void OnDoubleClick(std::function<void()> callback);
     void OnMultipleClick(std::function<void()> callback, uint8_t click_count = 3);
+    void DispatchInputEvent(const InputEvent& event) override;
 
 protected:
     gpio_num_t gpio_num_;
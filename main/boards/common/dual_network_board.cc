@@ -4,6 +4,12 @@
 #include "assets/lang_config.h"
 #include "settings.h"
 #include <esp_log.h>
+#include <wifi_station.h>
+#include <ssid_manager.h>
+
+#define NETWORK_MONITOR_INTERVAL_MS 1000
+// 首选网络恢复并稳定这么多个检查周期后，在待命时切回
+#define NETWORK_FAILBACK_STABLE_TICKS 10
 
 static const char *TAG = "DualNetworkBoard";
 
@@ -18,6 +24,25 @@ DualNetworkBoard::DualNetworkBoard(gpio_num_t ml307_tx_pin, gpio_num_t ml307_rx_
     
     // 只初始化当前网络类型对应的板卡
     InitializeCurrentBoard();
+    active_network_type_ = network_type_;
+
+    esp_timer_create_args_t timer_args = {
+        .callback = [](void* arg) {
+            static_cast<DualNetworkBoard*>(arg)->CheckNetworkState();
+        },
+        .arg = this,
+        .dispatch_method = ESP_TIMER_TASK,
+        .name = "network_monitor",
+        .skip_unhandled_events = true,
+    };
+    esp_timer_create(&timer_args, &network_monitor_timer_);
+}
+
+DualNetworkBoard::~DualNetworkBoard() {
+    if (network_monitor_timer_ != nullptr) {
+        esp_timer_stop(network_monitor_timer_);
+        esp_timer_delete(network_monitor_timer_);
+    }
 }
 
 NetworkType DualNetworkBoard::LoadNetworkTypeFromSettings(int32_t default_net_type) {
@@ -70,14 +95,136 @@ void DualNetworkBoard::StartNetwork() {
         display->SetStatus(Lang::Strings::DETECTING_MODULE);
     }
     current_board_->StartNetwork();
+    active_network_was_ready_ = IsNetworkReady(network_type_);
+
+#if CONFIG_DUAL_NETWORK_FAILOVER
+    StartStandbyNetwork();
+#endif
+    esp_timer_start_periodic(network_monitor_timer_, NETWORK_MONITOR_INTERVAL_MS * 1000);
+}
+
+void DualNetworkBoard::StartStandbyNetwork() {
+    if (network_type_ == NetworkType::ML307) {
+        // 备用 WiFi 直接启动 WifiStation，不构造 WifiBoard：其构造函数会消费 NVS 中的 force_ap 标志
+        if (SsidManager::GetInstance().GetSsidList().empty()) {
+            ESP_LOGI(TAG, "No WiFi configured, standby WiFi disabled");
+            return;
+        }
+        standby_wifi_started_ = true;
+    } else {
+        standby_board_ = std::make_unique<Ml307Board>(ml307_tx_pin_, ml307_rx_pin_, ml307_dtr_pin_);
+    }
+
+    // 备用网络在后台启动，不阻塞首选网络上的业务
+    xTaskCreate([](void* arg) {
+        auto board = static_cast<DualNetworkBoard*>(arg);
+        bool ready = false;
+        if (board->network_type_ == NetworkType::ML307) {
+            auto& wifi_station = WifiStation::GetInstance();
+            wifi_station.Start();
+            ready = wifi_station.WaitForConnected(30 * 1000);
+        } else {
+            ready = static_cast<Ml307Board*>(board->standby_board_.get())->StartNetworkInBackground(5);
+        }
+        ESP_LOGI(TAG, "Standby %s network %s", board->network_type_ == NetworkType::ML307 ? "WiFi" : "ML307",
+            ready ? "is ready" : "is not available yet");
+        vTaskDelete(NULL);
+    }, "standby_network", 4096, this, 2, nullptr);
+}
+
+bool DualNetworkBoard::IsNetworkStarted(NetworkType type) const {
+    return type == network_type_ || (type == NetworkType::WIFI ? standby_wifi_started_ : standby_board_ != nullptr);
+}
+
+NetworkInterface* DualNetworkBoard::GetNetworkByType(NetworkType type) const {
+    if (type == network_type_) {
+        return current_board_->GetNetwork();
+    }
+    if (type == NetworkType::WIFI) {
+        return WifiBoard::GetWifiNetwork();
+    }
+    return standby_board_->GetNetwork();
+}
+
+bool DualNetworkBoard::IsNetworkReady(NetworkType type) const {
+    if (!IsNetworkStarted(type)) {
+        return false;
+    }
+    if (type == NetworkType::WIFI) {
+        return WifiStation::GetInstance().IsConnected();
+    }
+    auto board = type == network_type_ ? current_board_.get() : standby_board_.get();
+    return static_cast<Ml307Board*>(board)->IsNetworkReady();
+}
+
+bool DualNetworkBoard::FailoverNetwork() {
+    NetworkType target = active_network_type_ == NetworkType::WIFI ? NetworkType::ML307 : NetworkType::WIFI;
+    if (!IsNetworkReady(target)) {
+        return false;
+    }
+
+    ESP_LOGW(TAG, "Switching active network to %s", target == NetworkType::WIFI ? "WiFi" : "ML307");
+    active_network_type_ = target;
+    active_network_was_ready_ = true;
+    primary_ready_ticks_ = 0;
+    auto display = Board::GetInstance().GetDisplay();
+    display->ShowNotification(target == NetworkType::WIFI ? Lang::Strings::SWITCH_TO_WIFI_NETWORK : Lang::Strings::SWITCH_TO_4G_NETWORK);
+    return true;
+}
+
+void DualNetworkBoard::CheckNetworkState() {
+    auto& app = Application::GetInstance();
+    bool active_ready = IsNetworkReady(active_network_type_);
+
+    if (!active_ready && active_network_was_ready_) {
+        ESP_LOGE(TAG, "Active network is down");
+        if (FailoverNetwork()) {
+            // 在另一张网上重建音频通道，对话不中断
+            app.MigrateAudioChannel();
+            return;
+        }
+        auto device_state = app.GetDeviceState();
+        if (device_state == kDeviceStateListening || device_state == kDeviceStateSpeaking) {
+            app.Schedule([&app]() {
+                app.SetDeviceState(kDeviceStateIdle);
+            });
+        }
+    }
+    active_network_was_ready_ = active_ready;
+
+    // 首选网络恢复后，等其稳定且设备空闲时再切回
+    if (active_network_type_ != network_type_ && IsNetworkReady(network_type_)) {
+        if (++primary_ready_ticks_ >= NETWORK_FAILBACK_STABLE_TICKS && app.GetDeviceState() == kDeviceStateIdle) {
+            if (FailoverNetwork()) {
+                app.MigrateAudioChannel();
+            }
+        }
+    } else {
+        primary_ready_ticks_ = 0;
+    }
 }
 
 NetworkInterface* DualNetworkBoard::GetNetwork() {
-    return current_board_->GetNetwork();
+    return GetNetworkByType(active_network_type_);
+}
+
+std::vector<NetworkInterface*> DualNetworkBoard::GetNetworks() {
+    std::vector<NetworkInterface*> networks = { GetNetwork() };
+    NetworkType other = active_network_type_ == NetworkType::WIFI ? NetworkType::ML307 : NetworkType::WIFI;
+    if (IsNetworkReady(other)) {
+        networks.push_back(GetNetworkByType(other));
+    }
+    return networks;
 }
 
 const char* DualNetworkBoard::GetNetworkStateIcon() {
-    return current_board_->GetNetworkStateIcon();
+    if (active_network_type_ == network_type_) {
+        return current_board_->GetNetworkStateIcon();
+    }
+    if (active_network_type_ == NetworkType::WIFI) {
+        return WifiBoard::GetWifiStateIcon();
+    }
+    return standby_board_->GetNetworkStateIcon();
 }
 
 void DualNetworkBoard::SetPowerSaveMode(bool enabled) {
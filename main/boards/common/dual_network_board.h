@@ -5,6 +5,7 @@
 #include "wifi_board.h"
 #include "ml307_board.h"
 #include <memory>
+#include <esp_timer.h>
 
 //enum NetworkType
 enum class NetworkType {
@@ -13,11 +14,21 @@ enum class NetworkType {
 };
 
 // 双网络板卡类，可以在WiFi和ML307之间切换
+// 开启 CONFIG_DUAL_NETWORK_FAILOVER 后，备用网络在后台同时启动，首选网络掉线时在线切换，无需重启
 class DualNetworkBoard : public Board {
 private:
-    // 使用基类指针存储当前活动的板卡
+    // 使用基类指针存储首选（NVS 中保存的）网络对应的板卡
     std::unique_ptr<Board> current_board_;
+    // 备用 ML307 对应的板卡，仅在开启在线切换时创建
+    std::unique_ptr<Board> standby_board_;
+    // 备用 WiFi 不创建板卡，直接使用 WifiStation
+    bool standby_wifi_started_ = false;
     NetworkType network_type_ = NetworkType::ML307;  // Default to ML307
+    // 当前实际使用的网络，可能因在线切换而不同于 network_type_
+    volatile NetworkType active_network_type_ = NetworkType::ML307;
+    bool active_network_was_ready_ = false;
+    int primary_ready_ticks_ = 0;
+    esp_timer_handle_t network_monitor_timer_ = nullptr;
 
     // ML307的引脚配置
     gpio_num_t ml307_tx_pin_;
@@ -32,16 +43,23 @@ private:
 
     // 初始化当前网络类型对应的板卡
     void InitializeCurrentBoard();
+
+    bool IsNetworkStarted(NetworkType type) const;
+    NetworkInterface* GetNetworkByType(NetworkType type) const;
+    bool IsNetworkReady(NetworkType type) const;
+    void StartStandbyNetwork();
+    void CheckNetworkState();
  
 public:
     DualNetworkBoard(gpio_num_t ml307_tx_pin, gpio_num_t ml307_rx_pin, gpio_num_t ml307_dtr_pin = GPIO_NUM_NC, int32_t default_net_type = 1);
-    virtual ~DualNetworkBoard() = default;
+    virtual ~DualNetworkBoard();
  
     // 切换网络类型
     void SwitchNetworkType();
     
     // 获取当前网络类型
     NetworkType GetNetworkType() const { return network_type_; }
+    NetworkType GetActiveNetworkType() const { return active_network_type_; }
     
     // 获取当前活动的板卡引用
     Board& GetCurrentBoard() const { return *current_board_; }
@@ -50,6 +68,8 @@ public:
     virtual std::string GetBoardType() override;
     virtual void StartNetwork() override;
     virtual NetworkInterface* GetNetwork() override;
+    virtual std::vector<NetworkInterface*> GetNetworks() override;
+    virtual bool FailoverNetwork() override;
     virtual const char* GetNetworkStateIcon() override;
     virtual void SetPowerSaveMode(bool enabled) override;
     virtual std::string GetBoardJson() override;
@@ -2,6 +2,7 @@
 #include "board.h"
 #include "display.h"
 #include "mcp_server.h"
+#include "memory_policy.h"
 #include "system_info.h"
 
 #include <cstring>
@@ -64,7 +65,7 @@ Esp32Camera::Esp32Camera(const camera_config_t &config)
 
     preview_image_.header.stride = preview_image_.header.w * 2;
     preview_image_.data_size = preview_image_.header.w * preview_image_.header.h * 2;
-    preview_image_.data = (uint8_t *)heap_caps_malloc(preview_image_.data_size, MALLOC_CAP_SPIRAM);
+    preview_image_.data = (uint8_t *)MemoryPolicy::GetInstance().Allocate(kMemoryTagCamera, kMemoryPlacementPsram, preview_image_.data_size);
     if (preview_image_.data == nullptr)
     {
         ESP_LOGE(TAG, "Failed to allocate memory for preview image");
@@ -81,7 +82,7 @@ Esp32Camera::~Esp32Camera()
     }
     if (preview_image_.data)
     {
-        heap_caps_free((void *)preview_image_.data);
+        MemoryPolicy::GetInstance().Free(kMemoryTagCamera, (void *)preview_image_.data);
         preview_image_.data = nullptr;
     }
     esp_camera_deinit();
@@ -307,7 +308,7 @@ std::string Esp32Camera::Explain(const std::string &question)
                 [](void *arg, size_t index, const void *data, size_t len) -> unsigned int
                 {
                     auto jpeg_queue = (QueueHandle_t)arg;
-                    JpegChunk chunk = {.data = (uint8_t *)heap_caps_aligned_alloc(16, len, MALLOC_CAP_SPIRAM), .len = len};
+                    JpegChunk chunk = {.data = (uint8_t *)MemoryPolicy::GetInstance().Allocate(kMemoryTagCamera, kMemoryPlacementPsram, len, 16), .len = len};
                     memcpy(chunk.data, data, len);
                     xQueueSend(jpeg_queue, &chunk, portMAX_DELAY);
                     return len;
@@ -339,7 +340,7 @@ std::string Esp32Camera::Explain(const std::string &question)
         {
             if (chunk.data != nullptr)
             {
-                heap_caps_free(chunk.data);
+                MemoryPolicy::GetInstance().Free(kMemoryTagCamera, chunk.data);
             }
             else
             {
@@ -385,7 +386,7 @@ std::string Esp32Camera::Explain(const std::string &question)
         }
         http->Write((const char *)chunk.data, chunk.len);
         total_sent += chunk.len;
-        heap_caps_free(chunk.data);
+        MemoryPolicy::GetInstance().Free(kMemoryTagCamera, chunk.data);
     }
     // Wait for the encoder thread to finish
     encoder_thread_.join();
@@ -1,11 +1,16 @@
 #include "i2c_device.h"
 
 #include <esp_log.h>
+#include <esp_timer.h>
+#include <algorithm>
 
 #define TAG "I2cDevice"
 
+// 所有设备，用于汇总统计
+static std::mutex devices_mutex;
+static std::vector<I2cDevice*> devices;
 
-I2cDevice::I2cDevice(i2c_master_bus_handle_t i2c_bus, uint8_t addr) {
+I2cDevice::I2cDevice(i2c_master_bus_handle_t i2c_bus, uint8_t addr) : addr_(addr) {
     i2c_device_config_t i2c_device_cfg = {
         .dev_addr_length = I2C_ADDR_BIT_LEN_7,
         .device_address = addr,
@@ -17,19 +22,130 @@ I2cDevice::I2cDevice(i2c_master_bus_handle_t i2c_bus, uint8_t addr) {
     };
     ESP_ERROR_CHECK(i2c_master_bus_add_device(i2c_bus, &i2c_device_cfg, &i2c_device_));
     assert(i2c_device_ != NULL);
+
+    std::lock_guard<std::mutex> lock(devices_mutex);
+    devices.push_back(this);
+}
+
+I2cDevice::~I2cDevice() {
+    std::lock_guard<std::mutex> lock(devices_mutex);
+    devices.erase(std::remove(devices.begin(), devices.end(), this), devices.end());
+}
+
+void I2cDevice::CountTransaction(size_t bytes) {
+    counters_.transactions++;
+    counters_.bytes += bytes;
 }
 
 void I2cDevice::WriteReg(uint8_t reg, uint8_t value) {
     uint8_t buffer[2] = {reg, value};
     ESP_ERROR_CHECK(i2c_master_transmit(i2c_device_, buffer, 2, 100));
+    CountTransaction(2);
+
+    std::lock_guard<std::mutex> lock(cache_mutex_);
+    auto range = FindCacheRange(reg);
+    if (range != nullptr) {
+        range->values[reg - range->first_reg] = value;
+    }
 }
 
 uint8_t I2cDevice::ReadReg(uint8_t reg) {
     uint8_t buffer[1];
     ESP_ERROR_CHECK(i2c_master_transmit_receive(i2c_device_, &reg, 1, buffer, 1, 100));
+    CountTransaction(2);
     return buffer[0];
 }
 
 void I2cDevice::ReadRegs(uint8_t reg, uint8_t* buffer, size_t length) {
     ESP_ERROR_CHECK(i2c_master_transmit_receive(i2c_device_, &reg, 1, buffer, length, 100));
-}
\ No newline at end of file
+    CountTransaction(1 + length);
+}
+
+void I2cDevice::AddCacheRange(uint8_t first_reg, uint8_t count, int max_age_ms) {
+    std::lock_guard<std::mutex> lock(cache_mutex_);
+    CacheRange range;
+    range.first_reg = first_reg;
+    range.count = count;
+    range.max_age_ms = max_age_ms;
+    range.values.resize(count);
+    cache_ranges_.push_back(std::move(range));
+}
+
+// 调用者需持有 cache_mutex_
+I2cDevice::CacheRange* I2cDevice::FindCacheRange(uint8_t reg) {
+    for (auto& range : cache_ranges_) {
+        if (reg >= range.first_reg && reg < range.first_reg + range.count) {
+            return &range;
+        }
+    }
+    return nullptr;
+}
+
+uint8_t I2cDevice::ReadCachedReg(uint8_t reg) {
+    std::lock_guard<std::mutex> lock(cache_mutex_);
+    auto range = FindCacheRange(reg);
+    if (range == nullptr) {
+        return ReadReg(reg);
+    }
+    auto now = esp_timer_get_time();
+    if (!range->valid || (now - range->refresh_time_us) / 1000 >= range->max_age_ms) {
+        ReadRegs(range->first_reg, range->values.data(), range->count);
+        range->refresh_time_us = now;
+        range->valid = true;
+        counters_.refreshes++;
+    } else {
+        counters_.cache_hits++;
+    }
+    return range->values[reg - range->first_reg];
+}
+
+void I2cDevice::UpdateRegBits(uint8_t reg, uint8_t mask, uint8_t bits) {
+    uint8_t value = ReadCachedReg(reg);
+    uint8_t new_value = (value & ~mask) | (bits & mask);
+    if (new_value == value) {
+        counters_.skipped_writes++;
+        return;
+    }
+    WriteReg(reg, new_value);
+}
+
+void I2cDevice::InvalidateCache() {
+    std::lock_guard<std::mutex> lock(cache_mutex_);
+    for (auto& range : cache_ranges_) {
+        range.valid = false;
+    }
+}
+
+I2cStatistics I2cDevice::GetTotalStatistics() {
+    std::lock_guard<std::mutex> lock(devices_mutex);
+    I2cStatistics stats;
+    for (auto device : devices) {
+        auto& counters = device->counters_;
+        stats.transactions += counters.transactions;
+        stats.bytes += counters.bytes;
+        stats.cache_hits += counters.cache_hits;
+        stats.refreshes += counters.refreshes;
+        stats.skipped_writes += counters.skipped_writes;
+    }
+    return stats;
+}
+
+std::string I2cDevice::GetStatisticsJson() {
+    auto total = GetTotalStatistics();
+    std::lock_guard<std::mutex> lock(devices_mutex);
+    std::string json = "{\"transactions\":" + std::to_string(total.transactions) +
+        ",\"bytes\":" + std::to_string(total.bytes) + ",\"cache_hits\":" + std::to_string(total.cache_hits) +
+        ",\"refreshes\":" + std::to_string(total.refreshes) + ",\"skipped_writes\":" + std::to_string(total.skipped_writes) +
+        ",\"devices\":[";
+    for (size_t i = 0; i < devices.size(); i++) {
+        auto& counters = devices[i]->counters_;
+        char addr[8];
+        snprintf(addr, sizeof(addr), "0x%02x", devices[i]->addr_);
+        if (i > 0) {
+            json += ",";
+        }
+        json += "{\"addr\":\"" + std::string(addr) + "\",\"transactions\":" + std::to_string(counters.transactions) +
+            ",\"cache_hits\":" + std::to_string(counters.cache_hits) + "}";
+    }
+    return json + "]}";
+}
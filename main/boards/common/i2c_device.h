@@ -3,9 +3,27 @@
 
 #include <driver/i2c_master.h>
 
+#include <atomic>
+#include <mutex>
+#include <string>
+#include <vector>
+
+struct I2cStatistics {
+    uint32_t transactions = 0;      // 实际发生的总线传输
+    uint32_t bytes = 0;
+    uint32_t cache_hits = 0;        // 由寄存器缓存直接返回的读取
+    uint32_t refreshes = 0;         // 缓存过期后的突发读取
+    uint32_t skipped_writes = 0;    // 值未变化而省略的写入
+};
+
 class I2cDevice {
 public:
     I2cDevice(i2c_master_bus_handle_t i2c_bus, uint8_t addr);
+    virtual ~I2cDevice();
+
+    // 所有 I2cDevice 的汇总统计及按地址的明细
+    static I2cStatistics GetTotalStatistics();
+    static std::string GetStatisticsJson();
 
 protected:
     i2c_master_dev_handle_t i2c_device_;
@@ -13,6 +31,45 @@ protected:
     void WriteReg(uint8_t reg, uint8_t value);
     uint8_t ReadReg(uint8_t reg);
     void ReadRegs(uint8_t reg, uint8_t* buffer, size_t length);
+
+    /*
+     * 寄存器缓存：对频繁轮询的状态寄存器，把一段连续寄存器用一次突发读取整体刷新，
+     * 超过 max_age_ms 后才重新读取。WriteReg 会同步更新缓存中的值。
+     * 芯片需要支持连续读取时地址自动递增。
+     */
+    void AddCacheRange(uint8_t first_reg, uint8_t count, int max_age_ms);
+    // 不在缓存范围内的寄存器直接读取
+    uint8_t ReadCachedReg(uint8_t reg);
+    // 读-改-写，只修改 mask 中的位；缓存有效时不读取，值不变时不写入
+    void UpdateRegBits(uint8_t reg, uint8_t mask, uint8_t bits);
+    // 让所有缓存过期，例如芯片复位之后
+    void InvalidateCache();
+
+private:
+    struct CacheRange {
+        uint8_t first_reg;
+        uint8_t count;
+        int max_age_ms;
+        int64_t refresh_time_us = 0;
+        bool valid = false;
+        std::vector<uint8_t> values;
+    };
+
+    struct Counters {
+        std::atomic<uint32_t> transactions = 0;
+        std::atomic<uint32_t> bytes = 0;
+        std::atomic<uint32_t> cache_hits = 0;
+        std::atomic<uint32_t> refreshes = 0;
+        std::atomic<uint32_t> skipped_writes = 0;
+    };
+
+    uint8_t addr_;
+    std::mutex cache_mutex_;
+    std::vector<CacheRange> cache_ranges_;
+    Counters counters_;
+
+    CacheRange* FindCacheRange(uint8_t reg);
+    void CountTransaction(size_t bytes);
 };
 
 #endif // I2C_DEVICE_H
@@ -0,0 +1,97 @@
+#include "input_event.h"
+
+#include <esp_log.h>
+#include <esp_timer.h>
+
+#define TAG "InputEvent"
+
+#define INPUT_TASK_STACK_SIZE 4096
+// 派发耗时超过该值时打印警告，说明回调中做了太多工作
+#define INPUT_SLOW_DISPATCH_US 50000
+
+InputDispatcher::InputDispatcher() {
+    xTaskCreate([](void* arg) {
+        auto this_ = (InputDispatcher*)arg;
+        this_->DispatchTask();
+        vTaskDelete(NULL);
+    }, "input", INPUT_TASK_STACK_SIZE, this, 5, &task_handle_);
+}
+
+InputSource::InputSource() : input_source_id_(InputDispatcher::GetInstance().AddSource(this)) {
+}
+
+InputSource::~InputSource() {
+    DetachInputSource();
+}
+
+void InputSource::DetachInputSource() {
+    InputDispatcher::GetInstance().RemoveSource(input_source_id_);
+}
+
+uint32_t InputDispatcher::AddSource(InputSource* source) {
+    std::lock_guard<std::recursive_mutex> lock(sources_mutex_);
+    uint32_t id = next_source_id_++;
+    sources_.emplace_back(id, source);
+    return id;
+}
+
+void InputDispatcher::RemoveSource(uint32_t id) {
+    std::lock_guard<std::recursive_mutex> lock(sources_mutex_);
+    for (auto it = sources_.begin(); it != sources_.end(); ++it) {
+        if (it->first == id) {
+            sources_.erase(it);
+            return;
+        }
+    }
+}
+
+bool InputDispatcher::Post(const InputSource* source, InputEventType type) {
+    InputEvent event = {
+        .source_id = source->input_source_id(),
+        .type = type,
+        .timestamp_us = esp_timer_get_time(),
+    };
+    if (!queue_.Push(event)) {
+        dropped_++;
+        return false;
+    }
+    if (xPortInIsrContext()) {
+        BaseType_t higher_priority_task_woken = pdFALSE;
+        vTaskNotifyGiveFromISR(task_handle_, &higher_priority_task_woken);
+        portYIELD_FROM_ISR(higher_priority_task_woken);
+    } else {
+        xTaskNotifyGive(task_handle_);
+    }
+    return true;
+}
+
+void InputDispatcher::DispatchTask() {
+    InputEvent event;
+    while (true) {
+        ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+        uint32_t dropped = dropped_.exchange(0);
+        if (dropped > 0) {
+            ESP_LOGW(TAG, "Input queue full, dropped %lu events", dropped);
+        }
+        while (queue_.Pop(event)) {
+            std::lock_guard<std::recursive_mutex> lock(sources_mutex_);
+            InputSource* source = nullptr;
+            for (auto& entry : sources_) {
+                if (entry.first == event.source_id) {
+                    source = entry.second;
+                    break;
+                }
+            }
+            if (source == nullptr) {
+                continue;
+            }
+            auto start_time = esp_timer_get_time();
+            source->DispatchInputEvent(event);
+            auto end_time = esp_timer_get_time();
+            if (end_time - start_time > INPUT_SLOW_DISPATCH_US) {
+                ESP_LOGW(TAG, "Slow input handler: type %d took %lld us, queued %lld us",
+                    event.type, end_time - start_time, start_time - event.timestamp_us);
+            }
+        }
+    }
+}
@@ -0,0 +1,159 @@
+#ifndef INPUT_EVENT_H_
+#define INPUT_EVENT_H_
+
+#include <freertos/FreeRTOS.h>
+#include <freertos/task.h>
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <utility>
+#include <vector>
+
+enum InputEventType : uint8_t {
+    kInputEventPressDown,
+    kInputEventPressUp,
+    kInputEventLongPress,
+    kInputEventClick,
+    kInputEventDoubleClick,
+    kInputEventMultipleClick,
+    kInputEventKnobRotate,      // 旋钮步数累积在 Knob 中，队列里只放一个通知
+};
+
+class InputSource;
+
+struct InputEvent {
+    uint32_t source_id;         // 按编号查找输入源，源已销毁时丢弃事件，不会访问悬空指针
+    InputEventType type;
+    int64_t timestamp_us;       // 驱动回调发生的时刻
+};
+
+// 按键、旋钮等输入设备，事件在 input 任务中回调
+class InputSource {
+public:
+    InputSource();
+    virtual ~InputSource();
+    InputSource(const InputSource&) = delete;
+    InputSource& operator=(const InputSource&) = delete;
+
+    uint32_t input_source_id() const { return input_source_id_; }
+    virtual void DispatchInputEvent(const InputEvent& event) = 0;
+
+protected:
+    // 派生类析构时先调用，等待正在进行的派发结束，之后队列中剩余的事件都会被丢弃
+    void DetachInputSource();
+
+private:
+    const uint32_t input_source_id_;
+};
+
+/*
+ * 有界的多生产者多消费者无锁队列（Dmitry Vyukov 的算法），
+ * 入队和出队都只有原子操作，可以在驱动回调或中断中使用。N 必须是 2 的幂。
+ */
+template <typename T, size_t N>
+class LockFreeQueue {
+    static_assert((N & (N - 1)) == 0, "N must be a power of 2");
+
+public:
+    LockFreeQueue() {
+        for (size_t i = 0; i < N; i++) {
+            cells_[i].sequence.store(i, std::memory_order_relaxed);
+        }
+    }
+
+    // 队列满时返回 false
+    bool Push(const T& data) {
+        size_t pos = enqueue_pos_.load(std::memory_order_relaxed);
+        Cell* cell;
+        while (true) {
+            cell = &cells_[pos & (N - 1)];
+            size_t sequence = cell->sequence.load(std::memory_order_acquire);
+            intptr_t diff = (intptr_t)sequence - (intptr_t)pos;
+            if (diff == 0) {
+                if (enqueue_pos_.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+                    break;
+                }
+            } else if (diff < 0) {
+                return false;
+            } else {
+                pos = enqueue_pos_.load(std::memory_order_relaxed);
+            }
+        }
+        cell->data = data;
+        cell->sequence.store(pos + 1, std::memory_order_release);
+        return true;
+    }
+
+    // 队列空时返回 false
+    bool Pop(T& data) {
+        size_t pos = dequeue_pos_.load(std::memory_order_relaxed);
+        Cell* cell;
+        while (true) {
+            cell = &cells_[pos & (N - 1)];
+            size_t sequence = cell->sequence.load(std::memory_order_acquire);
+            intptr_t diff = (intptr_t)sequence - (intptr_t)(pos + 1);
+            if (diff == 0) {
+                if (dequeue_pos_.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+                    break;
+                }
+            } else if (diff < 0) {
+                return false;
+            } else {
+                pos = dequeue_pos_.load(std::memory_order_relaxed);
+            }
+        }
+        data = cell->data;
+        cell->sequence.store(pos + N, std::memory_order_release);
+        return true;
+    }
+
+private:
+    struct Cell {
+        std::atomic<size_t> sequence;
+        T data;
+    };
+
+    Cell cells_[N];
+    std::atomic<size_t> enqueue_pos_ = 0;
+    std::atomic<size_t> dequeue_pos_ = 0;
+};
+
+/*
+ * 输入事件层：按键和旋钮的驱动回调（esp_timer 任务或中断）只把带时间戳的事件放进无锁队列，
+ * 由 input 任务按顺序回调，板级代码中的音量调整、显示更新等不再在驱动回调中执行。
+ */
+class InputDispatcher {
+public:
+    static InputDispatcher& GetInstance() {
+        static InputDispatcher instance;
+        return instance;
+    }
+    InputDispatcher(const InputDispatcher&) = delete;
+    InputDispatcher& operator=(const InputDispatcher&) = delete;
+
+    // 不加锁、不阻塞，队列满时丢弃并返回 false
+    bool Post(const InputSource* source, InputEventType type);
+
+private:
+    friend class InputSource;
+
+    LockFreeQueue<InputEvent, 32> queue_;
+    TaskHandle_t task_handle_ = nullptr;
+    std::atomic<uint32_t> dropped_ = 0;
+    // 派发期间持有，注销源时等待派发结束；回调中销毁输入源时同一任务会再次加锁
+    std::recursive_mutex sources_mutex_;
+    std::vector<std::pair<uint32_t, InputSource*>> sources_;
+    uint32_t next_source_id_ = 1;
+
+    uint32_t AddSource(InputSource* source);
+    void RemoveSource(uint32_t id);
+
+    InputDispatcher();
+    ~InputDispatcher() = default;
+
+    void DispatchTask();
+};
+
+#endif // INPUT_EVENT_H_
@@ -1,8 +1,21 @@
 #include "knob.h"
 
+#include <esp_timer.h>
+
 static const char* TAG = "Knob";
 
 Knob::Knob(gpio_num_t pin_a, gpio_num_t pin_b) {
+    esp_timer_create_args_t timer_args = {
+        .callback = [](void* arg) {
+            InputDispatcher::GetInstance().Post(static_cast<Knob*>(arg), kInputEventKnobRotate);
+        },
+        .arg = this,
+        .dispatch_method = ESP_TIMER_TASK,
+        .name = "knob_interval",
+        .skip_unhandled_events = true,
+    };
+    ESP_ERROR_CHECK(esp_timer_create(&timer_args, &interval_timer_));
+
     knob_config_t config = {
         .default_direction = 0,
         .gpio_encoder_a = static_cast<uint8_t>(pin_a),
@@ -32,6 +45,11 @@ Knob::Knob(gpio_num_t pin_a, gpio_num_t pin_b) {
 }
 
 Knob::~Knob() {
+    DetachInputSource();
+    if (interval_timer_ != nullptr) {
+        esp_timer_stop(interval_timer_);
+        esp_timer_delete(interval_timer_);
+    }
     if (knob_handle_ != NULL) {
         iot_knob_delete(knob_handle_);
         knob_handle_ = NULL;
@@ -42,11 +60,47 @@ void Knob::OnRotate(std::function<void(bool)> callback) {
     on_rotate_ = callback;
 }
 
+// 在驱动回调中只累积步数，第一步时投递一次通知
 void Knob::knob_callback(void* arg, void* data) {
     Knob* knob = static_cast<Knob*>(data);
     knob_event_t event = iot_knob_get_event(arg);
-    
-    if (knob->on_rotate_) {
-        knob->on_rotate_(event == KNOB_RIGHT);
+
+    knob->pending_steps_ += (event == KNOB_RIGHT) ? 1 : -1;
+    if (!knob->event_pending_.exchange(true)) {
+        InputDispatcher::GetInstance().Post(knob, kInputEventKnobRotate);
     }
-}
\ No newline at end of file
+}
+
+void Knob::OnRotateSteps(std::function<void(int)> callback) {
+    on_rotate_steps_ = callback;
+}
+
+// 在 input 任务中执行
+void Knob::DispatchInputEvent(const InputEvent& event) {
+    // 按时间戳限制回调频率：间隔未到时不阻塞 input 任务，由定时器在间隔结束时重新投递，
+    // 期间继续转动的步数合并到那一次，标志保持置位，驱动回调不会重复投递
+    int64_t now = esp_timer_get_time();
+    int64_t wait_us = last_dispatch_time_us_ + CONFIG_INPUT_KNOB_INTERVAL_MS * 1000 - now;
+    if (wait_us > 0) {
+        esp_timer_stop(interval_timer_);
+        esp_timer_start_once(interval_timer_, wait_us);
+        return;
+    }
+    // 先清除标志再取步数，之后的转动会重新投递通知
+    event_pending_ = false;
+    int steps = pending_steps_.exchange(0);
+    last_dispatch_time_us_ = now;
+    if (steps == 0) {
+        return;
+    }
+
+    ESP_LOGD(TAG, "Rotate %d steps, %lld us after notification", steps, last_dispatch_time_us_ - event.timestamp_us);
+    if (on_rotate_steps_) {
+        on_rotate_steps_(steps);
+    }
+    if (on_rotate_) {
+        for (int i = 0; i < (steps > 0 ? steps : -steps); i++) {
+            on_rotate_(steps > 0);
+        }
+    }
+}
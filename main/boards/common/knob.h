@@ -4,14 +4,24 @@
 #include <driver/gpio.h>
 #include <functional>
 #include <esp_log.h>
+#include <esp_timer.h>
 #include <iot_knob.h>
 
-class Knob {
+#include <atomic>
+
+#include "input_event.h"
+
+class Knob : public InputSource {
 public:
     Knob(gpio_num_t pin_a, gpio_num_t pin_b);
     ~Knob();
 
+    // 每一步回调一次
     void OnRotate(std::function<void(bool)> callback);
+    // 快速旋转时合并为一次回调，steps 为期间的净步数（顺时针为正），
+    // 两次回调至少间隔 CONFIG_INPUT_KNOB_INTERVAL_MS
+    void OnRotateSteps(std::function<void(int)> callback);
+    void DispatchInputEvent(const InputEvent& event) override;
 
 private:
     static void knob_callback(void* arg, void* data);
@@ -20,6 +30,12 @@ private:
     gpio_num_t pin_a_;
     gpio_num_t pin_b_;
     std::function<void(bool)> on_rotate_;
+    std::function<void(int)> on_rotate_steps_;
+
+    std::atomic<int> pending_steps_ = 0;
+    std::atomic<bool> event_pending_ = false;   // 队列中已有未处理的旋转通知，或在等待间隔结束
+    int64_t last_dispatch_time_us_ = 0;
+    esp_timer_handle_t interval_timer_ = nullptr;   // 间隔未到时延后重新投递通知
 };
 
-#endif // KNOB_H_
\ No newline at end of file
+#endif // KNOB_H_
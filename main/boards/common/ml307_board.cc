@@ -36,6 +36,10 @@ void Ml307Board::StartNetwork() {
             ESP_LOGI(TAG, "Network is ready");
         } else {
             ESP_LOGE(TAG, "Network is down");
+            // 由双网络板卡管理时，断网后的切换与迁移由 DualNetworkBoard 处理
+            if (&Board::GetInstance() != this) {
+                return;
+            }
             auto device_state = application.GetDeviceState();
             if (device_state == kDeviceStateListening || device_state == kDeviceStateSpeaking) {
                 application.Schedule([this, &application]() {
@@ -68,6 +72,28 @@ void Ml307Board::StartNetwork() {
     ESP_LOGI(TAG, "ML307 ICCID: %s", iccid.c_str());
 }
 
+// 作为双网络板卡的备用网络在后台启动：不更新界面，不弹出告警
+bool Ml307Board::StartNetworkInBackground(int detect_retries) {
+    for (int i = 0; i < detect_retries && modem_ == nullptr; i++) {
+        modem_ = AtModem::Detect(tx_pin_, rx_pin_, dtr_pin_, 921600);
+        if (modem_ == nullptr) {
+            vTaskDelay(pdMS_TO_TICKS(1000));
+        }
+    }
+    if (modem_ == nullptr) {
+        ESP_LOGW(TAG, "ML307 modem not detected");
+        return false;
+    }
+
+    auto result = modem_->WaitForNetworkReady();
+    if (result != NetworkStatus::Ready) {
+        ESP_LOGW(TAG, "ML307 network not ready: %d", (int)result);
+        return false;
+    }
+    ESP_LOGI(TAG, "ML307 standby network is ready");
+    return true;
+}
+
 NetworkInterface* Ml307Board::GetNetwork() {
     return modem_.get();
 }
@@ -19,6 +19,8 @@ public:
     Ml307Board(gpio_num_t tx_pin, gpio_num_t rx_pin, gpio_num_t dtr_pin = GPIO_NUM_NC);
     virtual std::string GetBoardType() override;
     virtual void StartNetwork() override;
+    bool StartNetworkInBackground(int detect_retries);
+    bool IsNetworkReady() const { return modem_ != nullptr && modem_->network_ready(); }
     virtual NetworkInterface* GetNetwork() override;
     virtual const char* GetNetworkStateIcon() override;
     virtual void SetPowerSaveMode(bool enabled) override;
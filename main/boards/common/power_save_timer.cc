@@ -1,5 +1,6 @@
 #include "power_save_timer.h"
 #include "application.h"
+#include "power_governor.h"
 
 #include <esp_log.h>
 
@@ -67,14 +68,7 @@ void PowerSaveTimer::PowerSaveCheck() {
                 on_enter_sleep_mode_();
             }
 
-            if (cpu_max_freq_ != -1) {
-                esp_pm_config_t pm_config = {
-                    .max_freq_mhz = cpu_max_freq_,
-                    .min_freq_mhz = 40,
-                    .light_sleep_enable = true,
-                };
-                esp_pm_configure(&pm_config);
-            }
+            PowerGovernor::GetInstance().EnterSleepMode(cpu_max_freq_);
         }
     }
     if (seconds_to_shutdown_ != -1 && ticks_ >= seconds_to_shutdown_ && on_shutdown_request_) {
@@ -87,14 +81,7 @@ void PowerSaveTimer::WakeUp() {
     if (in_sleep_mode_) {
         in_sleep_mode_ = false;
 
-        if (cpu_max_freq_ != -1) {
-            esp_pm_config_t pm_config = {
-                .max_freq_mhz = cpu_max_freq_,
-                .min_freq_mhz = cpu_max_freq_,
-                .light_sleep_enable = false,
-            };
-            esp_pm_configure(&pm_config);
-        }
+        PowerGovernor::GetInstance().ExitSleepMode(cpu_max_freq_);
 
         if (on_exit_sleep_mode_) {
             on_exit_sleep_mode_();
@@ -6,11 +6,21 @@
 
 #define TAG "Sy6970"
 
+// 状态栏每秒查询一次充电状态和电量，同一次查询中对同一寄存器的多次读取只访问一次总线
+#define SY6970_STATUS_MAX_AGE_MS 500
+// 充电目标电压只由本机配置，写入时同步更新缓存
+#define SY6970_CONFIG_MAX_AGE_MS 60000
+
 Sy6970::Sy6970(i2c_master_bus_handle_t i2c_bus, uint8_t addr) : I2cDevice(i2c_bus, addr) {
+    // 用到的寄存器互不相邻：0x0B 和 0x0E 之间隔着读取即清除锁存故障的 0x0C，
+    // 不能合并成一次突发读取，每个寄存器单独缓存，只省去重复读取
+    AddCacheRange(0x06, 1, SY6970_CONFIG_MAX_AGE_MS);      // 充电电压限制
+    AddCacheRange(0x0B, 1, SY6970_STATUS_MAX_AGE_MS);      // 系统状态
+    AddCacheRange(0x0E, 1, SY6970_STATUS_MAX_AGE_MS);      // 电池电压
 }
 
 int Sy6970::GetChangingStatus() {
-    return (ReadReg(0x0B) >> 3) & 0x03;
+    return (ReadCachedReg(0x0B) >> 3) & 0x03;
 }
 
 bool Sy6970::IsCharging() {
@@ -18,7 +28,7 @@ bool Sy6970::IsCharging() {
 }
 
 bool Sy6970::IsPowerGood() {
-    return (ReadReg(0x0B) & 0x04) != 0;
+    return (ReadCachedReg(0x0B) & 0x04) != 0;
 }
 
 bool Sy6970::IsChargingDone() {
@@ -26,7 +36,7 @@ bool Sy6970::IsChargingDone() {
 }
 
 int Sy6970::GetBatteryVoltage() {
-    uint8_t value = ReadReg(0x0E);
+    uint8_t value = ReadCachedReg(0x0E);
     value &= 0x7F;
     if (value == 0) {
         return 0;
@@ -35,7 +45,7 @@ int Sy6970::GetBatteryVoltage() {
 }
 
 int Sy6970::GetChargeTargetVoltage() {
-    uint8_t value = ReadReg(0x06);
+    uint8_t value = ReadCachedReg(0x06);
     value = (value & 0xFC) >> 2;
     if (value > 0x30) {
         return 4608;
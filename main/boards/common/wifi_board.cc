@@ -11,6 +11,11 @@
 #include <freertos/task.h>
 #include <esp_network.h>
 #include <esp_log.h>
+#include <esp_timer.h>
+#include <esp_wifi.h>
+
+#include <cstdio>
+#include <cstring>
 
 #include <wifi_station.h>
 #include <wifi_configuration_ap.h>
@@ -65,6 +70,8 @@ void WifiBoard::EnterWifiConfigMode() {
 }
 
 void WifiBoard::StartNetwork() {
+    network_start_time_us_ = esp_timer_get_time();
+
     // User can press BOOT button while starting to enter WiFi configuration mode
     if (wifi_config_mode_) {
         EnterWifiConfigMode();
@@ -80,6 +87,26 @@ void WifiBoard::StartNetwork() {
         return;
     }
 
+    // Try to connect to WiFi, if failed, launch the WiFi configuration AP
+    if (!StartStation(60 * 1000)) {
+        WifiStation::GetInstance().Stop();
+        wifi_config_mode_ = true;
+        EnterWifiConfigMode();
+        return;
+    }
+}
+
+// 启动 STA 并等待获取 IP，不进入配网模式；双网络板卡的后台备用网络也走这里
+bool WifiBoard::StartStation(int timeout_ms) {
+    if (network_start_time_us_ == 0) {
+        network_start_time_us_ = esp_timer_get_time();
+    }
+
+    // 有缓存时在 WifiStation 启动扫描前直接关联上次的 AP
+    if (LoadFastConnectCache()) {
+        RegisterFastConnectHandlers();
+    }
+
     auto& wifi_station = WifiStation::GetInstance();
     wifi_station.OnScanBegin([this]() {
         auto display = Board::GetInstance().GetDisplay();
@@ -95,21 +122,142 @@ void WifiBoard::StartNetwork() {
     wifi_station.OnConnected([this](const std::string& ssid) {
         auto display = Board::GetInstance().GetDisplay();
         std::string notification = Lang::Strings::CONNECTED_TO;
-        notification += ssid;
+        notification += ssid.empty() ? GetConnectedSsid() : ssid;
         display->ShowNotification(notification.c_str(), 30000);
     });
     wifi_station.Start();
 
-    // Try to connect to WiFi, if failed, launch the WiFi configuration AP
-    if (!wifi_station.WaitForConnected(60 * 1000)) {
-        wifi_station.Stop();
-        wifi_config_mode_ = true;
-        EnterWifiConfigMode();
+    if (!wifi_station.WaitForConnected(timeout_ms)) {
+        UnregisterFastConnectHandlers();
+        return false;
+    }
+
+    bool fast_connected = fast_connect_pending_;
+    UnregisterFastConnectHandlers();
+    time_to_ip_ms_ = (esp_timer_get_time() - network_start_time_us_) / 1000;
+    ESP_LOGI(TAG, "Time to IP: %d ms (%s)", time_to_ip_ms_, fast_connected ? "cached BSSID" : "scan");
+    SaveFastConnectCache();
+    return true;
+}
+
+bool WifiBoard::LoadFastConnectCache() {
+    Settings settings("wifi", false);
+    fast_connect_cache_.ssid = settings.GetString("fc_ssid");
+    std::string bssid = settings.GetString("fc_bssid");
+    fast_connect_cache_.channel = settings.GetInt("fc_channel", 0);
+    if (fast_connect_cache_.ssid.empty() || fast_connect_cache_.channel == 0 || bssid.size() != 17) {
+        return false;
+    }
+    if (sscanf(bssid.c_str(), "%hhx:%hhx:%hhx:%hhx:%hhx:%hhx",
+            &fast_connect_cache_.bssid[0], &fast_connect_cache_.bssid[1], &fast_connect_cache_.bssid[2],
+            &fast_connect_cache_.bssid[3], &fast_connect_cache_.bssid[4], &fast_connect_cache_.bssid[5]) != 6) {
+        return false;
+    }
+
+    // 缓存的 SSID 必须仍在已保存列表中，密码以 SsidManager 为准
+    auto ssid_list = SsidManager::GetInstance().GetSsidList();
+    for (auto& item : ssid_list) {
+        if (item.ssid == fast_connect_cache_.ssid) {
+            fast_connect_cache_.password = item.password;
+            ESP_LOGI(TAG, "Fast connect cache: %s %s ch%d", fast_connect_cache_.ssid.c_str(), bssid.c_str(),
+                fast_connect_cache_.channel);
+            return true;
+        }
+    }
+    return false;
+}
+
+void WifiBoard::SaveFastConnectCache() {
+    wifi_ap_record_t ap_info;
+    if (esp_wifi_sta_get_ap_info(&ap_info) != ESP_OK) {
         return;
     }
+    char bssid[18];
+    snprintf(bssid, sizeof(bssid), "%02x:%02x:%02x:%02x:%02x:%02x",
+        ap_info.bssid[0], ap_info.bssid[1], ap_info.bssid[2], ap_info.bssid[3], ap_info.bssid[4], ap_info.bssid[5]);
+    std::string ssid = (const char*)ap_info.ssid;
+
+    // 与缓存一致时不写 NVS，避免每次启动都擦写 flash
+    if (ssid == fast_connect_cache_.ssid && ap_info.primary == fast_connect_cache_.channel &&
+        memcmp(ap_info.bssid, fast_connect_cache_.bssid, sizeof(ap_info.bssid)) == 0) {
+        return;
+    }
+
+    Settings settings("wifi", true);
+    settings.SetString("fc_ssid", ssid);
+    settings.SetString("fc_bssid", bssid);
+    settings.SetInt("fc_channel", ap_info.primary);
+    ESP_LOGI(TAG, "Fast connect cache updated: %s %s ch%d", ssid.c_str(), bssid, ap_info.primary);
+}
+
+void WifiBoard::RegisterFastConnectHandlers() {
+    // WifiStation 以 (WIFI_EVENT, ESP_EVENT_ANY_ID) 注册，在 STA_START 时立即发起扫描。
+    // esp_event 按级别派发：(ANY_BASE, ANY_ID) 的处理函数先于指定 base 的执行，与注册顺序无关，
+    // 因此在这一级注册可以保证先发起缓存连接，再轮到 WifiStation 的扫描逻辑
+    esp_event_handler_instance_register(ESP_EVENT_ANY_BASE, ESP_EVENT_ANY_ID,
+        &WifiBoard::FastConnectEventHandler, this, &fast_connect_handler_);
+}
+
+void WifiBoard::UnregisterFastConnectHandlers() {
+    if (fast_connect_handler_ != nullptr) {
+        esp_event_handler_instance_unregister(ESP_EVENT_ANY_BASE, ESP_EVENT_ANY_ID, fast_connect_handler_);
+        fast_connect_handler_ = nullptr;
+    }
+    fast_connect_pending_ = false;
+}
+
+void WifiBoard::FastConnectEventHandler(void* arg, esp_event_base_t event_base, int32_t event_id, void* event_data) {
+    if (event_base != WIFI_EVENT) {
+        return;
+    }
+    auto board = static_cast<WifiBoard*>(arg);
+    auto& cache = board->fast_connect_cache_;
+
+    if (event_id == WIFI_EVENT_STA_START) {
+        wifi_config_t wifi_config = {};
+        strncpy((char*)wifi_config.sta.ssid, cache.ssid.c_str(), sizeof(wifi_config.sta.ssid));
+        strncpy((char*)wifi_config.sta.password, cache.password.c_str(), sizeof(wifi_config.sta.password));
+        memcpy(wifi_config.sta.bssid, cache.bssid, sizeof(wifi_config.sta.bssid));
+        wifi_config.sta.bssid_set = true;
+        wifi_config.sta.channel = cache.channel;
+        wifi_config.sta.scan_method = WIFI_FAST_SCAN;
+        if (esp_wifi_set_config(WIFI_IF_STA, &wifi_config) == ESP_OK && esp_wifi_connect() == ESP_OK) {
+            board->fast_connect_pending_ = true;
+            ESP_LOGI(TAG, "Fast connect to %s on channel %d", cache.ssid.c_str(), cache.channel);
+        }
+    } else if (event_id == WIFI_EVENT_SCAN_DONE && board->fast_connect_pending_) {
+        // WifiStation 的扫描仍然完成了，它会按扫描结果重新配置并连接，快速重连让位给常规流程
+        ESP_LOGW(TAG, "Scan completed during fast connect, using scan result");
+        board->fast_connect_pending_ = false;
+    } else if (event_id == WIFI_EVENT_STA_DISCONNECTED && board->fast_connect_pending_) {
+        // AP 已换信道或下线：去掉 BSSID/信道锁定，之后的重连和扫描走常规流程
+        auto event = static_cast<wifi_event_sta_disconnected_t*>(event_data);
+        ESP_LOGW(TAG, "Fast connect failed, reason %d, falling back to scan", event->reason);
+        board->fast_connect_pending_ = false;
+        wifi_config_t wifi_config = {};
+        if (esp_wifi_get_config(WIFI_IF_STA, &wifi_config) == ESP_OK) {
+            wifi_config.sta.bssid_set = false;
+            wifi_config.sta.channel = 0;
+            wifi_config.sta.scan_method = WIFI_ALL_CHANNEL_SCAN;
+            esp_wifi_set_config(WIFI_IF_STA, &wifi_config);
+        }
+    }
+}
+
+std::string WifiBoard::GetConnectedSsid() {
+    // 快速重连不经过 WifiStation 的扫描流程，以驱动记录的 AP 信息为准
+    wifi_ap_record_t ap_info;
+    if (esp_wifi_sta_get_ap_info(&ap_info) == ESP_OK) {
+        return (const char*)ap_info.ssid;
+    }
+    return WifiStation::GetInstance().GetSsid();
 }
 
 NetworkInterface* WifiBoard::GetNetwork() {
+    return GetWifiNetwork();
+}
+
+NetworkInterface* WifiBoard::GetWifiNetwork() {
     static EspNetwork network;
     return &network;
 }
@@ -118,6 +266,10 @@ const char* WifiBoard::GetNetworkStateIcon() {
     if (wifi_config_mode_) {
         return FONT_AWESOME_WIFI;
     }
+    return GetWifiStateIcon();
+}
+
+const char* WifiBoard::GetWifiStateIcon() {
     auto& wifi_station = WifiStation::GetInstance();
     if (!wifi_station.IsConnected()) {
         return FONT_AWESOME_WIFI_OFF;
@@ -139,10 +291,11 @@ std::string WifiBoard::GetBoardJson() {
     board_json += R"("type":")" + std::string(BOARD_TYPE) + R"(",)";
     board_json += R"("name":")" + std::string(BOARD_NAME) + R"(",)";
     if (!wifi_config_mode_) {
-        board_json += R"("ssid":")" + wifi_station.GetSsid() + R"(",)";
+        board_json += R"("ssid":")" + GetConnectedSsid() + R"(",)";
         board_json += R"("rssi":)" + std::to_string(wifi_station.GetRssi()) + R"(,)";
         board_json += R"("channel":)" + std::to_string(wifi_station.GetChannel()) + R"(,)";
         board_json += R"("ip":")" + wifi_station.GetIpAddress() + R"(",)";
+        board_json += R"("time_to_ip_ms":)" + std::to_string(time_to_ip_ms_) + R"(,)";
     }
     board_json += R"("mac":")" + SystemInfo::GetMacAddress() + R"(")";
     board_json += R"(})";
@@ -231,7 +384,7 @@ std::string WifiBoard::GetDeviceStatusJson() {
     auto network = cJSON_CreateObject();
     auto& wifi_station = WifiStation::GetInstance();
     cJSON_AddStringToObject(network, "type", "wifi");
-    cJSON_AddStringToObject(network, "ssid", wifi_station.GetSsid().c_str());
+    cJSON_AddStringToObject(network, "ssid", GetConnectedSsid().c_str());
     int rssi = wifi_station.GetRssi();
     if (rssi >= -60) {
         cJSON_AddStringToObject(network, "signal", "strong");
@@ -3,22 +3,51 @@
 
 #include "board.h"
 
+#include <esp_event.h>
+#include <esp_wifi_types.h>
+
 class WifiBoard : public Board {
 protected:
     bool wifi_config_mode_ = false;
     void EnterWifiConfigMode();
     virtual std::string GetBoardJson() override;
 
+    // 快速重连：缓存上次成功连接的 BSSID / 信道，启动时先直连，失败再扫描。
+    // IP 由 LWIP_DHCP_RESTORE_LAST_IP 恢复上次的租约，不在这里缓存
+    struct FastConnectCache {
+        std::string ssid;
+        std::string password;
+        uint8_t bssid[6] = {0};
+        uint8_t channel = 0;
+    };
+    FastConnectCache fast_connect_cache_;
+    volatile bool fast_connect_pending_ = false;
+    int64_t network_start_time_us_ = 0;
+    int time_to_ip_ms_ = -1;
+    esp_event_handler_instance_t fast_connect_handler_ = nullptr;
+
+    bool LoadFastConnectCache();
+    void SaveFastConnectCache();
+    void RegisterFastConnectHandlers();
+    void UnregisterFastConnectHandlers();
+    static void FastConnectEventHandler(void* arg, esp_event_base_t event_base, int32_t event_id, void* event_data);
+    std::string GetConnectedSsid();
+
 public:
     WifiBoard();
     virtual std::string GetBoardType() override;
     virtual void StartNetwork() override;
+    bool StartStation(int timeout_ms);
     virtual NetworkInterface* GetNetwork() override;
     virtual const char* GetNetworkStateIcon() override;
+    // 不依赖 WifiBoard 实例，供双网络板卡的备用 WiFi 使用
+    static NetworkInterface* GetWifiNetwork();
+    static const char* GetWifiStateIcon();
     virtual void SetPowerSaveMode(bool enabled) override;
     virtual void ResetWifiConfiguration();
     virtual AudioCodec* GetAudioCodec() override { return nullptr; }
     virtual std::string GetDeviceStatusJson() override;
+    int GetTimeToIpMs() const { return time_to_ip_ms_; }
 };
 
 #endif // WIFI_BOARD_H
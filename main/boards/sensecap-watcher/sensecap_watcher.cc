@@ -197,10 +197,11 @@ private:
         assert(ret == ESP_OK);
     }
 
-    void OnKnobRotate(bool clockwise) {
+    // 快速旋转时多步合并为一次音量调整和一次通知
+    void OnKnobRotate(int steps) {
         auto codec = GetAudioCodec();
         int current_volume = codec->output_volume();
-        int new_volume = current_volume + (clockwise ? -5 : 5); 
+        int new_volume = current_volume - steps * 5;
 
         // 确保音量在有效范围内
         if (new_volume > 100) {
@@ -225,9 +226,9 @@ private:
 
     void InitializeKnob() {
         knob_ = std::make_unique<Knob>(BSP_KNOB_A_PIN, BSP_KNOB_B_PIN);
-        knob_->OnRotate([this](bool clockwise) {
-            ESP_LOGD(TAG, "Knob rotation detected. Clockwise:%s", clockwise ? "true" : "false");
-            OnKnobRotate(clockwise);
+        knob_->OnRotateSteps([this](int steps) {
+            ESP_LOGD(TAG, "Knob rotation detected. Steps:%d", steps);
+            OnKnobRotate(steps);
         });
         ESP_LOGI(TAG, "Knob initialized with pins A:%d B:%d", BSP_KNOB_A_PIN, BSP_KNOB_B_PIN);
     }
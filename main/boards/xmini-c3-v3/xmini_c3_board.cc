@@ -36,7 +36,10 @@ private:
     AdcBatteryMonitor* adc_battery_monitor_ = nullptr;
 
     void InitializePowerManager() {
-        adc_battery_monitor_ = new AdcBatteryMonitor(ADC_UNIT_1, ADC_CHANNEL_3, 100000, 100000, GPIO_NUM_12);
+        // 扬声器输出高于 -40dBFS 时电池电压被负载拉低，电量采样不可信
+        adc_battery_monitor_ = new AdcBatteryMonitor(ADC_UNIT_1, ADC_CHANNEL_3, 100000, 100000, GPIO_NUM_12, []() {
+            return Application::GetInstance().GetAudioService().GetAudioLevels().output.RmsDbfs() > -40.0f;
+        });
         adc_battery_monitor_->OnChargingStatusChanged([this](bool is_charging) {
             if (is_charging) {
                 sleep_timer_->SetEnabled(false);
@@ -7,6 +7,7 @@
 #include "display.h"
 #include "board.h"
 #include "application.h"
+#include "power_governor.h"
 #include "font_awesome_symbols.h"
 #include "audio_codec.h"
 #include "settings.h"
@@ -29,14 +30,6 @@ Display::Display() {
         .skip_unhandled_events = false,
     };
     ESP_ERROR_CHECK(esp_timer_create(&notification_timer_args, &notification_timer_));
-
-    // Create a power management lock
-    auto ret = esp_pm_lock_create(ESP_PM_APB_FREQ_MAX, 0, "display_update", &pm_lock_);
-    if (ret == ESP_ERR_NOT_SUPPORTED) {
-        ESP_LOGI(TAG, "Power management not supported");
-    } else {
-        ESP_ERROR_CHECK(ret);
-    }
 }
 
 Display::~Display() {
@@ -56,9 +49,6 @@ Display::~Display() {
     if( low_battery_popup_ != nullptr ) {
         lv_obj_del(low_battery_popup_);
     }
-    if (pm_lock_ != nullptr) {
-        esp_pm_lock_delete(pm_lock_);
-    }
 }
 
 void Display::SetStatus(const char* status) {
@@ -129,12 +119,21 @@ void Display::UpdateStatusBar(bool update_all) {
         }
     }
 
-    esp_pm_lock_acquire(pm_lock_);
+    PowerGovernor::GetInstance().Acquire(kPowerLockApbMax);
     // 更新电池图标
     int battery_level;
     bool charging, discharging;
     const char* icon = nullptr;
     if (board.GetBatteryLevel(battery_level, charging, discharging)) {
+        if (battery_level != last_battery_level_ || charging != last_battery_charging_) {
+            last_battery_level_ = battery_level;
+            last_battery_charging_ = charging;
+            DeviceEvent event(kDeviceEventBatteryChanged);
+            event.battery.level = battery_level;
+            event.battery.charging = charging;
+            event.battery.discharging = discharging;
+            EventBus::GetInstance().Post(event);
+        }
         if (charging) {
             icon = FONT_AWESOME_BATTERY_CHARGING;
         } else {
@@ -183,6 +182,15 @@ void Display::UpdateStatusBar(bool update_all) {
         };
         if (std::find(allowed_states.begin(), allowed_states.end(), device_state) != allowed_states.end()) {
             icon = board.GetNetworkStateIcon();
+            // 会话中链路质量差（高 RTT/丢包）时，即使信号强度正常也显示为弱信号
+            if (icon != nullptr && Application::GetInstance().GetLinkQualityLevel() == kLinkQualityPoor) {
+                if (strcmp(icon, FONT_AWESOME_WIFI) == 0 || strcmp(icon, FONT_AWESOME_WIFI_FAIR) == 0) {
+                    icon = FONT_AWESOME_WIFI_WEAK;
+                } else if (strcmp(icon, FONT_AWESOME_SIGNAL_2) == 0 || strcmp(icon, FONT_AWESOME_SIGNAL_3) == 0 ||
+                           strcmp(icon, FONT_AWESOME_SIGNAL_4) == 0) {
+                    icon = FONT_AWESOME_SIGNAL_1;
+                }
+            }
             if (network_label_ != nullptr && icon != nullptr && network_icon_ != icon) {
                 DisplayLockGuard lock(this);
                 network_icon_ = icon;
@@ -191,9 +199,16 @@ void Display::UpdateStatusBar(bool update_all) {
         }
     }
 
-    esp_pm_lock_release(pm_lock_);
+    PowerGovernor::GetInstance().Release(kPowerLockApbMax);
 }
 
+void Display::DropImageCache() {
+    if (display_ == nullptr) {
+        return;
+    }
+    DisplayLockGuard lock(this);
+    lv_image_cache_drop(nullptr);
+}
 
 void Display::SetEmotion(const char* emotion) {
     struct Emotion {
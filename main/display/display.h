@@ -31,6 +31,10 @@ public:
     virtual std::string GetTheme() { return current_theme_name_; }
     virtual void UpdateStatusBar(bool update_all = false);
     virtual void ShowStandbyScreen(bool show);
+    // 内存紧张时删除较早的聊天记录，只保留最近 keep 条
+    virtual void TrimChatHistory(int keep) {}
+    // 丢弃 LVGL 已解码图片的缓存，下次显示时重新解码
+    void DropImageCache();
 
     inline int width() const { return width_; }
     inline int height() const { return height_; }
@@ -39,7 +43,6 @@ protected:
     int width_ = 0;
     int height_ = 0;
     
-    esp_pm_lock_handle_t pm_lock_ = nullptr;
     lv_display_t *display_ = nullptr;
 
     lv_obj_t *emotion_label_ = nullptr;
@@ -53,6 +56,8 @@ protected:
     lv_obj_t* low_battery_label_ = nullptr;
     
     const char* battery_icon_ = nullptr;
+    int last_battery_level_ = -1;
+    bool last_battery_charging_ = false;
     const char* network_icon_ = nullptr;
     bool muted_ = false;
     std::string current_theme_name_;
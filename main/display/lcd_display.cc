@@ -10,6 +10,7 @@
 #include "assets/lang_config.h"
 #include <cstring>
 #include "settings.h"
+#include "memory_policy.h"
 
 #include "board.h"
 
@@ -601,6 +602,23 @@ void LcdDisplay::SetChatMessage(const char* role, const char* content) {
     chat_message_label_ = msg_text;
 }
 
+void LcdDisplay::TrimChatHistory(int keep) {
+    DisplayLockGuard lock(this);
+    if (content_ == nullptr) {
+        return;
+    }
+    // 至少保留最新一条，chat_message_label_ 指向它
+    keep = std::max(keep, 1);
+    uint32_t child_count = lv_obj_get_child_cnt(content_);
+    if (child_count <= (uint32_t)keep) {
+        return;
+    }
+    for (uint32_t i = keep; i < child_count; i++) {
+        lv_obj_del(lv_obj_get_child(content_, 0));
+    }
+    ESP_LOGI(TAG, "Trimmed chat history from %lu to %d messages", child_count, keep);
+}
+
 void LcdDisplay::SetPreviewImage(const lv_img_dsc_t* img_dsc) {
     DisplayLockGuard lock(this);
     if (content_ == nullptr) {
@@ -626,7 +644,7 @@ void LcdDisplay::SetPreviewImage(const lv_img_dsc_t* img_dsc) {
         lv_obj_t* preview_image = lv_image_create(img_bubble);
         
         // Copy the image descriptor and data to avoid source data changes
-        lv_img_dsc_t* copied_img_dsc = (lv_img_dsc_t*)heap_caps_malloc(sizeof(lv_img_dsc_t), MALLOC_CAP_8BIT);
+        lv_img_dsc_t* copied_img_dsc = (lv_img_dsc_t*)MemoryPolicy::GetInstance().Allocate(kMemoryTagUi, kMemoryPlacementInternal, sizeof(lv_img_dsc_t));
         if (copied_img_dsc == nullptr) {
             ESP_LOGE(TAG, "Failed to allocate memory for image descriptor");
             lv_obj_del(img_bubble);
@@ -638,14 +656,10 @@ void LcdDisplay::SetPreviewImage(const lv_img_dsc_t* img_dsc) {
         copied_img_dsc->data_size = img_dsc->data_size;
         
         // Copy the image data
-        uint8_t* copied_data = (uint8_t*)heap_caps_malloc(img_dsc->data_size, MALLOC_CAP_SPIRAM | MALLOC_CAP_8BIT);
-        if (copied_data == nullptr) {
-            // Fallback to internal RAM if SPIRAM allocation fails
-            copied_data = (uint8_t*)heap_caps_malloc(img_dsc->data_size, MALLOC_CAP_8BIT);
-        }
+        uint8_t* copied_data = (uint8_t*)MemoryPolicy::GetInstance().Allocate(kMemoryTagUi, kMemoryPlacementPsram, img_dsc->data_size);
         if (copied_data == nullptr) {
             ESP_LOGE(TAG, "Failed to allocate memory for image data (size: %lu bytes)", img_dsc->data_size);
-            heap_caps_free(copied_img_dsc);
+            MemoryPolicy::GetInstance().Free(kMemoryTagUi, copied_img_dsc);
             lv_obj_del(img_bubble);
             return;
         }
@@ -676,8 +690,8 @@ void LcdDisplay::SetPreviewImage(const lv_img_dsc_t* img_dsc) {
         lv_obj_add_event_cb(preview_image, [](lv_event_t* e) {
             lv_img_dsc_t* copied_img_dsc = (lv_img_dsc_t*)lv_event_get_user_data(e);
             if (copied_img_dsc != nullptr) {
-                heap_caps_free((void*)copied_img_dsc->data);
-                heap_caps_free(copied_img_dsc);
+                MemoryPolicy::GetInstance().Free(kMemoryTagUi, (void*)copied_img_dsc->data);
+                MemoryPolicy::GetInstance().Free(kMemoryTagUi, copied_img_dsc);
             }
         }, LV_EVENT_DELETE, (void*)copied_img_dsc);
         
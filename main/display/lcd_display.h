@@ -53,6 +53,7 @@ public:
     virtual void SetPreviewImage(const lv_img_dsc_t* img_dsc) override;
 #if CONFIG_USE_WECHAT_MESSAGE_STYLE
     virtual void SetChatMessage(const char* role, const char* content) override; 
+    virtual void TrimChatHistory(int keep) override;
 #endif  
 
     // Add theme switching function
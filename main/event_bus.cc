@@ -0,0 +1,169 @@
+#include "event_bus.h"
+
+#include <esp_log.h>
+#include <esp_timer.h>
+#include <freertos/task.h>
+#include <type_traits>
+
+#define TAG "EventBus"
+
+#define EVENT_BUS_QUEUE_SIZE 32
+#define EVENT_BUS_TASK_STACK_SIZE 4096
+
+static const char* const kEventTypeNames[kDeviceEventTypeCount] = {
+    "state", "vad", "wake_word", "network", "battery", "audio_level",
+};
+
+EventBus::EventBus() {
+    for (auto& subscribers : subscribers_) {
+        subscribers = new SubscriberList();
+    }
+    queue_ = xQueueCreate(EVENT_BUS_QUEUE_SIZE, sizeof(DeviceEvent));
+    if (queue_ == nullptr) {
+        ESP_LOGE(TAG, "Failed to create event queue");
+        return;
+    }
+    auto ret = xTaskCreate([](void* arg) {
+        auto this_ = (EventBus*)arg;
+        this_->DispatchTask();
+        vTaskDelete(NULL);
+    }, "event_bus", EVENT_BUS_TASK_STACK_SIZE, this, 3, NULL);
+    if (ret != pdPASS) {
+        // 没有分发任务时队列只会被填满，释放后 Post 直接返回失败
+        ESP_LOGE(TAG, "Failed to create event bus task");
+        vQueueDelete(queue_);
+        queue_ = nullptr;
+    }
+}
+
+EventBus::~EventBus() {
+    for (auto& subscribers : subscribers_) {
+        delete subscribers.load();
+    }
+    for (auto list : retired_) {
+        delete list;
+    }
+    if (queue_ != nullptr) {
+        vQueueDelete(queue_);
+    }
+}
+
+const char* EventBus::GetTypeName(DeviceEventType type) {
+    return type < kDeviceEventTypeCount ? kEventTypeNames[type] : "unknown";
+}
+
+// 调用者需持有 mutex_
+void EventBus::ReplaceSubscribers(DeviceEventType type, SubscriberList* list) {
+    auto old_list = subscribers_[type].exchange(list);
+    // 分发任务可能仍在遍历旧列表，留到它处理完当前事件后再释放
+    retired_.push_back(old_list);
+    has_retired_ = true;
+}
+
+int EventBus::Subscribe(DeviceEventType type, std::function<void(const DeviceEvent&)> callback) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto list = new SubscriberList(*subscribers_[type].load());
+    int id = next_id_++;
+    list->push_back({id, std::move(callback)});
+    ReplaceSubscribers(type, list);
+    return id;
+}
+
+void EventBus::Unsubscribe(int id) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    for (int type = 0; type < kDeviceEventTypeCount; type++) {
+        auto current = subscribers_[type].load();
+        for (size_t i = 0; i < current->size(); i++) {
+            if ((*current)[i].id == id) {
+                auto list = new SubscriberList(*current);
+                list->erase(list->begin() + i);
+                ReplaceSubscribers((DeviceEventType)type, list);
+                return;
+            }
+        }
+    }
+}
+
+bool EventBus::Post(DeviceEvent event) {
+    auto& counters = counters_[event.type];
+    counters.posted++;
+    if (queue_ == nullptr) {
+        counters.dropped++;
+        return false;
+    }
+    event.post_time_us = esp_timer_get_time();
+    if (xQueueSend(queue_, &event, 0) != pdTRUE) {
+        if (counters.dropped++ % 10 == 0) {
+            ESP_LOGW(TAG, "Queue full, dropped %s event", GetTypeName(event.type));
+        }
+        return false;
+    }
+    return true;
+}
+
+void EventBus::DispatchTask() {
+    // 队列元素按字节拷贝，DeviceEvent 不能有析构函数
+    static_assert(std::is_trivially_copyable<DeviceEvent>::value, "DeviceEvent must be trivially copyable");
+    DeviceEvent event(kDeviceEventStateChanged);
+    while (true) {
+        if (xQueueReceive(queue_, &event, portMAX_DELAY) != pdTRUE) {
+            continue;
+        }
+        auto start_time = esp_timer_get_time();
+        uint32_t latency_us = start_time - event.post_time_us;
+
+        auto subscribers = subscribers_[event.type].load();
+        for (auto& subscriber : *subscribers) {
+            subscriber.callback(event);
+        }
+
+        auto& counters = counters_[event.type];
+        uint32_t handler_us = esp_timer_get_time() - start_time;
+        counters.last_latency_us = latency_us;
+        counters.total_latency_us += latency_us;
+        if (latency_us > counters.max_latency_us) {
+            counters.max_latency_us = latency_us;
+        }
+        if (handler_us > counters.max_handler_us) {
+            counters.max_handler_us = handler_us;
+        }
+
+        if (has_retired_) {
+            std::lock_guard<std::mutex> lock(mutex_);
+            for (auto list : retired_) {
+                delete list;
+            }
+            retired_.clear();
+            has_retired_ = false;
+        }
+    }
+}
+
+EventBusStatistics EventBus::GetStatistics(DeviceEventType type) {
+    auto& counters = counters_[type];
+    EventBusStatistics stats;
+    stats.posted = counters.posted;
+    stats.dropped = counters.dropped;
+    stats.last_latency_us = counters.last_latency_us;
+    stats.max_latency_us = counters.max_latency_us;
+    stats.total_latency_us = counters.total_latency_us;
+    stats.max_handler_us = counters.max_handler_us;
+    return stats;
+}
+
+std::string EventBus::GetStatisticsJson() {
+    std::string json = "{";
+    for (int type = 0; type < kDeviceEventTypeCount; type++) {
+        auto stats = GetStatistics((DeviceEventType)type);
+        uint32_t delivered = stats.posted - stats.dropped;
+        uint32_t avg_latency_us = delivered > 0 ? stats.total_latency_us / delivered : 0;
+        if (type > 0) {
+            json += ",";
+        }
+        json += "\"" + std::string(kEventTypeNames[type]) + "\":{\"posted\":" + std::to_string(stats.posted) +
+            ",\"dropped\":" + std::to_string(stats.dropped) + ",\"avg_latency_us\":" + std::to_string(avg_latency_us) +
+            ",\"max_latency_us\":" + std::to_string(stats.max_latency_us) +
+            ",\"max_handler_us\":" + std::to_string(stats.max_handler_us) + "}";
+    }
+    return json + "}";
+}
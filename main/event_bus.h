@@ -0,0 +1,126 @@
+#ifndef _EVENT_BUS_H_
+#define _EVENT_BUS_H_
+
+#include <freertos/FreeRTOS.h>
+#include <freertos/queue.h>
+
+#include <atomic>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "device_state.h"
+
+enum DeviceEventType {
+    kDeviceEventStateChanged,
+    kDeviceEventVadChanged,
+    kDeviceEventWakeWordDetected,
+    kDeviceEventNetworkChanged,
+    kDeviceEventBatteryChanged,
+    kDeviceEventAudioLevel,
+    kDeviceEventTypeCount,
+};
+
+enum NetworkChangeReason {
+    kNetworkChangeLinkQuality,      // 链路质量等级变化
+    kNetworkChangeFailover,         // 切换到备用网络
+};
+
+// 事件按值放入队列，只能包含平凡类型
+struct DeviceEvent {
+    DeviceEventType type;
+    int64_t post_time_us = 0;       // 由 Post 填写
+    union {
+        struct {
+            DeviceState previous;
+            DeviceState current;
+        } state;
+        struct {
+            bool speaking;
+        } vad;
+        struct {
+            NetworkChangeReason reason;
+            int link_quality;       // LinkQualityLevel
+        } network;
+        struct {
+            int level;
+            bool charging;
+            bool discharging;
+        } battery;
+        struct {
+            int16_t input_dbfs;
+            int16_t output_dbfs;
+        } audio_level;
+    };
+
+    explicit DeviceEvent(DeviceEventType type) : type(type), state() {}
+};
+
+struct EventBusStatistics {
+    uint32_t posted = 0;
+    uint32_t dropped = 0;           // 队列满时丢弃
+    uint32_t last_latency_us = 0;   // 从投递到开始分发
+    uint32_t max_latency_us = 0;
+    uint64_t total_latency_us = 0;
+    uint32_t max_handler_us = 0;    // 单次分发中所有订阅者的耗时
+};
+
+/*
+ * 类型化的发布/订阅事件总线，替代原来基于默认 esp_event 循环的 DeviceStateEventManager。
+ * Post 只把事件拷贝进 FreeRTOS 队列，不等待、不加锁，可在任意任务中调用；
+ * 订阅者在 event_bus 任务中按投递顺序回调，回调中不应长时间阻塞。
+ * 订阅者列表写时复制：订阅和退订生成新列表后原子替换，分发时无需加锁或拷贝，
+ * 旧列表由分发任务在当前事件处理完后释放。
+ */
+class EventBus {
+public:
+    static EventBus& GetInstance() {
+        static EventBus instance;
+        return instance;
+    }
+    EventBus(const EventBus&) = delete;
+    EventBus& operator=(const EventBus&) = delete;
+
+    // 返回订阅 ID，用于退订
+    int Subscribe(DeviceEventType type, std::function<void(const DeviceEvent&)> callback);
+    void Unsubscribe(int id);
+    // 队列满时丢弃并返回 false
+    bool Post(DeviceEvent event);
+
+    EventBusStatistics GetStatistics(DeviceEventType type);
+    std::string GetStatisticsJson();
+    static const char* GetTypeName(DeviceEventType type);
+
+private:
+    struct Subscriber {
+        int id;
+        std::function<void(const DeviceEvent&)> callback;
+    };
+    typedef std::vector<Subscriber> SubscriberList;
+
+    struct Counters {
+        std::atomic<uint32_t> posted = 0;
+        std::atomic<uint32_t> dropped = 0;
+        std::atomic<uint32_t> last_latency_us = 0;
+        std::atomic<uint32_t> max_latency_us = 0;
+        std::atomic<uint64_t> total_latency_us = 0;
+        std::atomic<uint32_t> max_handler_us = 0;
+    };
+
+    QueueHandle_t queue_ = nullptr;
+    std::atomic<SubscriberList*> subscribers_[kDeviceEventTypeCount];
+    Counters counters_[kDeviceEventTypeCount];
+    std::mutex mutex_;                  // 只在修改订阅者列表时使用
+    std::vector<SubscriberList*> retired_;
+    std::atomic<bool> has_retired_ = false;
+    int next_id_ = 1;
+
+    EventBus();
+    ~EventBus();
+
+    void DispatchTask();
+    void ReplaceSubscribers(DeviceEventType type, SubscriberList* list);
+};
+
+#endif // _EVENT_BUS_H_
@@ -0,0 +1,154 @@
+#include "heap_guard.h"
+#include "memory_policy.h"
+
+#include <esp_heap_caps.h>
+#include <esp_log.h>
+#include <esp_timer.h>
+#include <algorithm>
+
+#define TAG "HeapGuard"
+
+// 两次压缩之间的最短间隔，避免内存持续紧张时反复清理
+#define HEAP_GUARD_COOLDOWN_MS 60000
+
+static const char* const kHeapNames[kHeapGuardHeapCount] = {
+    "internal", "dma", "psram",
+};
+
+static const uint32_t kHeapCaps[kHeapGuardHeapCount] = {
+    MALLOC_CAP_INTERNAL | MALLOC_CAP_8BIT,
+    MALLOC_CAP_DMA,
+    MALLOC_CAP_SPIRAM,
+};
+
+void HeapGuard::AddCompactionPoint(const char* name, std::function<void()> compact) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    compaction_points_.push_back({name, std::move(compact)});
+}
+
+HeapSnapshot HeapGuard::GetSnapshot(HeapGuardHeap heap) {
+    HeapSnapshot snapshot;
+    snapshot.free_bytes = heap_caps_get_free_size(kHeapCaps[heap]);
+    snapshot.largest_block = heap_caps_get_largest_free_block(kHeapCaps[heap]);
+    snapshot.minimum_free = heap_caps_get_minimum_free_size(kHeapCaps[heap]);
+    return snapshot;
+}
+
+void HeapGuard::Check(bool idle) {
+    std::unique_lock<std::mutex> lock(mutex_);
+    if (compacting_) {
+        return;
+    }
+    for (int heap = 0; heap < kHeapGuardHeapCount; heap++) {
+        auto& trend = trends_[heap];
+        trend.last = GetSnapshot((HeapGuardHeap)heap);
+        trend.min_largest_block = std::min(trend.min_largest_block, trend.last.largest_block);
+    }
+
+    uint32_t largest_block = trends_[kHeapGuardInternal].last.largest_block;
+    if (history_count_ == HEAP_GUARD_HISTORY_SIZE) {
+        std::copy(history_ + 1, history_ + HEAP_GUARD_HISTORY_SIZE, history_);
+        history_count_--;
+    }
+    history_[history_count_++] = largest_block;
+    trends_[kHeapGuardInternal].largest_block_change = (int32_t)largest_block - (int32_t)history_[0];
+
+    if (!IsDegraded()) {
+        return;
+    }
+    degraded_checks_++;
+    if (!idle || (esp_timer_get_time() - last_compaction_time_us_) / 1000 < HEAP_GUARD_COOLDOWN_MS) {
+        return;
+    }
+    Compact(lock);
+}
+
+// 调用者需持有 mutex_
+bool HeapGuard::IsDegraded() {
+    const uint32_t threshold = CONFIG_HEAP_GUARD_MIN_LARGEST_BLOCK_KB * 1024;
+    uint32_t largest_block = history_[history_count_ - 1];
+    if (largest_block < threshold) {
+        return true;
+    }
+    if (largest_block >= threshold * 2 || history_count_ < HEAP_GUARD_HISTORY_SIZE) {
+        return false;
+    }
+    // 接近阈值时，整个窗口内持续缩小也视为恶化，提前整理
+    for (int i = 1; i < history_count_; i++) {
+        if (history_[i] >= history_[i - 1]) {
+            return false;
+        }
+    }
+    return true;
+}
+
+// 调用者需持有 mutex_。压缩点可能长时间等待其他任务（如解码器池最多等待 500ms），
+// 执行期间释放锁，不阻塞 GetStatusJson 等调用
+void HeapGuard::Compact(std::unique_lock<std::mutex>& lock) {
+    const uint32_t threshold = CONFIG_HEAP_GUARD_MIN_LARGEST_BLOCK_KB * 1024;
+    auto& internal = trends_[kHeapGuardInternal].last;
+    ESP_LOGW(TAG, "Internal heap fragmented: free %lu, largest block %lu (%d%%), change %ld in %d s",
+        internal.free_bytes, internal.largest_block, internal.Fragmentation(),
+        trends_[kHeapGuardInternal].largest_block_change, history_count_ * CONFIG_HEAP_GUARD_CHECK_INTERVAL_SECONDS);
+    for (int tag = 0; tag < kMemoryTagCount; tag++) {
+        auto stats = MemoryPolicy::GetInstance().GetStatistics((MemoryTag)tag);
+        ESP_LOGW(TAG, "  %s: internal %lu, psram %lu, peak %lu", MemoryPolicy::GetTagName((MemoryTag)tag),
+            stats.internal_bytes, stats.psram_bytes, stats.peak_bytes);
+    }
+
+    compactions_++;
+    last_compaction_time_us_ = esp_timer_get_time();
+    compacting_ = true;
+    // 压缩点只会追加，按下标回写统计
+    for (size_t i = 0; i < compaction_points_.size(); i++) {
+        const char* name = compaction_points_[i].name;
+        auto compact = compaction_points_[i].compact;
+        lock.unlock();
+        auto before = GetSnapshot(kHeapGuardInternal);
+        compact();
+        auto after = GetSnapshot(kHeapGuardInternal);
+        ESP_LOGW(TAG, "Compaction %s: largest block %lu -> %lu, free %lu -> %lu", name,
+            before.largest_block, after.largest_block, before.free_bytes, after.free_bytes);
+        lock.lock();
+        auto& point = compaction_points_[i];
+        point.runs++;
+        point.reclaimed += (int32_t)after.largest_block - (int32_t)before.largest_block;
+        if (after.largest_block >= threshold * 2) {
+            break;
+        }
+    }
+    compacting_ = false;
+
+    // 压缩后重新开始记录趋势
+    trends_[kHeapGuardInternal].last = GetSnapshot(kHeapGuardInternal);
+    history_[0] = trends_[kHeapGuardInternal].last.largest_block;
+    history_count_ = 1;
+}
+
+std::string HeapGuard::GetStatusJson() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    std::string json = "{\"heaps\":{";
+    for (int heap = 0; heap < kHeapGuardHeapCount; heap++) {
+        auto& trend = trends_[heap];
+        if (heap > 0) {
+            json += ",";
+        }
+        json += "\"" + std::string(kHeapNames[heap]) + "\":{\"free\":" + std::to_string(trend.last.free_bytes) +
+            ",\"largest_block\":" + std::to_string(trend.last.largest_block) +
+            ",\"min_largest_block\":" + std::to_string(trend.min_largest_block == UINT32_MAX ? 0 : trend.min_largest_block) +
+            ",\"minimum_free\":" + std::to_string(trend.last.minimum_free) +
+            ",\"fragmentation\":" + std::to_string(trend.last.Fragmentation()) + "}";
+    }
+    json += "},\"largest_block_change\":" + std::to_string(trends_[kHeapGuardInternal].largest_block_change) +
+        ",\"degraded_checks\":" + std::to_string(degraded_checks_) +
+        ",\"compactions\":" + std::to_string(compactions_) + ",\"points\":[";
+    for (size_t i = 0; i < compaction_points_.size(); i++) {
+        auto& point = compaction_points_[i];
+        if (i > 0) {
+            json += ",";
+        }
+        json += "{\"name\":\"" + std::string(point.name) + "\",\"runs\":" + std::to_string(point.runs) +
+            ",\"reclaimed\":" + std::to_string(point.reclaimed) + "}";
+    }
+    return json + "]}";
+}
@@ -0,0 +1,82 @@
+#ifndef _HEAP_GUARD_H_
+#define _HEAP_GUARD_H_
+
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#define HEAP_GUARD_HISTORY_SIZE 6
+
+enum HeapGuardHeap {
+    kHeapGuardInternal,
+    kHeapGuardDma,
+    kHeapGuardPsram,
+    kHeapGuardHeapCount,
+};
+
+struct HeapSnapshot {
+    uint32_t free_bytes = 0;
+    uint32_t largest_block = 0;
+    uint32_t minimum_free = 0;
+
+    // 0 表示空闲内存是一整块，越接近 100 碎片越严重
+    int Fragmentation() const { return free_bytes > 0 ? 100 - (uint64_t)largest_block * 100 / free_bytes : 0; }
+};
+
+struct HeapTrend {
+    HeapSnapshot last;
+    uint32_t min_largest_block = UINT32_MAX;
+    int32_t largest_block_change = 0;   // 最近一个窗口内最大空闲块的变化
+};
+
+/*
+ * 堆碎片监控：周期采样各个堆的空闲总量和最大空闲块，记录最大空闲块的变化趋势。
+ * 内部 RAM 的最大空闲块低于 CONFIG_HEAP_GUARD_MIN_LARGEST_BLOCK_KB，或低于两倍阈值且在整个窗口内持续缩小时，
+ * 在待命状态下按注册顺序执行压缩点（释放池、裁剪聊天记录、丢弃缓存），恢复后即停止。
+ * 每次干预都会记录日志和前后的内存变化。
+ */
+class HeapGuard {
+public:
+    static HeapGuard& GetInstance() {
+        static HeapGuard instance;
+        return instance;
+    }
+    HeapGuard(const HeapGuard&) = delete;
+    HeapGuard& operator=(const HeapGuard&) = delete;
+
+    // 按代价从低到高注册
+    void AddCompactionPoint(const char* name, std::function<void()> compact);
+    // 在主任务中周期调用，idle 为 false 时只采样不干预
+    void Check(bool idle);
+
+    HeapSnapshot GetSnapshot(HeapGuardHeap heap);
+    std::string GetStatusJson();
+
+private:
+    struct CompactionPoint {
+        const char* name;
+        std::function<void()> compact;
+        uint32_t runs = 0;
+        int32_t reclaimed = 0;          // 累计使最大空闲块增加的字节数
+    };
+
+    std::mutex mutex_;
+    std::vector<CompactionPoint> compaction_points_;
+    HeapTrend trends_[kHeapGuardHeapCount];
+    uint32_t history_[HEAP_GUARD_HISTORY_SIZE] = {};   // 内部 RAM 最大空闲块
+    int history_count_ = 0;
+    int64_t last_compaction_time_us_ = 0;
+    uint32_t degraded_checks_ = 0;
+    uint32_t compactions_ = 0;
+    bool compacting_ = false;
+
+    HeapGuard() = default;
+    ~HeapGuard() = default;
+
+    bool IsDegraded();
+    void Compact(std::unique_lock<std::mutex>& lock);
+};
+
+#endif // _HEAP_GUARD_H_
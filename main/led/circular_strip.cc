@@ -1,10 +1,17 @@
 #include "circular_strip.h"
 #include "application.h"
 #include <esp_log.h>
+#include <esp_timer.h>
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
 
 #define TAG "CircularStrip"
 
-#define BLINK_INFINITE -1
+#define STRIP_TASK_STACK_SIZE 3072
+#define STRIP_TASK_PRIORITY 2
+// 呼吸灯亮度曲线的 gamma，使人眼感觉到的亮度变化均匀
+#define BREATHE_GAMMA 2.2f
 
 CircularStrip::CircularStrip(gpio_num_t gpio, uint8_t max_leds) : max_leds_(max_leds) {
     // If the gpio is not connected, you should use NoLed class
@@ -20,160 +27,235 @@ CircularStrip::CircularStrip(gpio_num_t gpio, uint8_t max_leds) : max_leds_(max_
 
     led_strip_rmt_config_t rmt_config = {};
     rmt_config.resolution_hz = 10 * 1000 * 1000; // 10MHz
+#ifdef CONFIG_LED_STRIP_USE_RMT_DMA
+    // 使用 DMA 发送，整条灯带一次写入，不需要 CPU 在 RMT 中断里分段填充
+    rmt_config.mem_block_symbols = 1024;
+    rmt_config.flags.with_dma = true;
+#endif
 
     ESP_ERROR_CHECK(led_strip_new_rmt_device(&strip_config, &rmt_config, &led_strip_));
     led_strip_clear(led_strip_);
 
-    esp_timer_create_args_t strip_timer_args = {
-        .callback = [](void *arg) {
-            auto strip = static_cast<CircularStrip*>(arg);
-            std::lock_guard<std::mutex> lock(strip->mutex_);
-            if (strip->strip_callback_ != nullptr) {
-                strip->strip_callback_();
-            }
-        },
-        .arg = this,
-        .dispatch_method = ESP_TIMER_TASK,
-        .name = "strip_timer",
-        .skip_unhandled_events = false,
-    };
-    ESP_ERROR_CHECK(esp_timer_create(&strip_timer_args, &strip_timer_));
+    xTaskCreate([](void* arg) {
+        auto strip = static_cast<CircularStrip*>(arg);
+        strip->StripTask();
+        strip->task_exited_ = true;
+        vTaskDelete(NULL);
+    }, "led_strip", STRIP_TASK_STACK_SIZE, this, STRIP_TASK_PRIORITY, &strip_task_);
 }
 
 CircularStrip::~CircularStrip() {
-    esp_timer_stop(strip_timer_);
+    if (strip_task_ != nullptr) {
+        stopping_ = true;
+        xTaskNotifyGive(strip_task_);
+        while (!task_exited_) {
+            vTaskDelay(pdMS_TO_TICKS(10));
+        }
+    }
     if (led_strip_ != nullptr) {
         led_strip_del(led_strip_);
     }
 }
 
+void CircularStrip::Play(std::unique_ptr<StripAnimation> animation) {
+    if (led_strip_ == nullptr || strip_task_ == nullptr) {
+        return;
+    }
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        pending_ = std::move(animation);
+    }
+    xTaskNotifyGive(strip_task_);
+}
+
+void CircularStrip::StripTask() {
+    std::unique_ptr<StripAnimation> animation;
+    int frame = 0;
+    TickType_t wait_ticks = portMAX_DELAY;
 
-void CircularStrip::SetAllColor(StripColor color) {
-    std::lock_guard<std::mutex> lock(mutex_);
-    esp_timer_stop(strip_timer_);
+    while (!stopping_) {
+        ulTaskNotifyTake(pdTRUE, wait_ticks);
+        if (stopping_) {
+            break;
+        }
+
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            if (pending_ != nullptr) {
+                animation = std::move(pending_);
+                frame = 0;
+            }
+        }
+        if (animation == nullptr) {
+            wait_ticks = portMAX_DELAY;
+            continue;
+        }
+
+        auto start_time = esp_timer_get_time();
+        ShowFrame(*animation, frame);
+
+        frame++;
+        if (frame >= animation->frame_count) {
+            if (!animation->loop) {
+                // 停在最后一帧，等待下一个动画
+                animation.reset();
+                wait_ticks = portMAX_DELAY;
+                continue;
+            }
+            frame = 0;
+        }
+        // 扣除本帧发送所用的时间，使帧间隔不受灯带长度影响
+        int elapsed_ms = (esp_timer_get_time() - start_time) / 1000;
+        int remaining_ms = std::max(animation->interval_ms - elapsed_ms, 1);
+        wait_ticks = std::max<TickType_t>(pdMS_TO_TICKS(remaining_ms), 1);
+    }
+}
+
+void CircularStrip::ShowFrame(const StripAnimation& animation, int frame) {
+    const StripColor* pixels = animation.frames.data() + (animation.uniform ? frame : frame * max_leds_);
+    bool changed = false;
+    bool all_off = true;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        for (int i = 0; i < max_leds_; i++) {
+            const StripColor& color = animation.uniform ? pixels[0] : pixels[i];
+            if (colors_[i] != color) {
+                colors_[i] = color;
+                changed = true;
+            }
+            if (color.red != 0 || color.green != 0 || color.blue != 0) {
+                all_off = false;
+            }
+        }
+    }
+    // 与正在显示的帧相同，不重新发送
+    if (!changed) {
+        return;
+    }
+
+    if (all_off) {
+        led_strip_clear(led_strip_);
+        return;
+    }
     for (int i = 0; i < max_leds_; i++) {
-        colors_[i] = color;
+        const StripColor& color = animation.uniform ? pixels[0] : pixels[i];
         led_strip_set_pixel(led_strip_, i, color.red, color.green, color.blue);
     }
     led_strip_refresh(led_strip_);
 }
 
-void CircularStrip::SetSingleColor(uint8_t index, StripColor color) {
-    std::lock_guard<std::mutex> lock(mutex_);
-    esp_timer_stop(strip_timer_);
-    colors_[index] = color;
-    led_strip_set_pixel(led_strip_, index, color.red, color.green, color.blue);
-    led_strip_refresh(led_strip_);
+void CircularStrip::SetAllColor(StripColor color) {
+    auto animation = std::make_unique<StripAnimation>();
+    animation->frames.push_back(color);
+    animation->frame_count = 1;
+    animation->uniform = true;
+    animation->loop = false;
+    Play(std::move(animation));
 }
 
-void CircularStrip::Blink(StripColor color, int interval_ms) {
-    for (int i = 0; i < max_leds_; i++) {
-        colors_[i] = color;
+void CircularStrip::SetSingleColor(uint8_t index, StripColor color) {
+    if (index >= max_leds_) {
+        return;
     }
-    StartStripTask(interval_ms, [this]() {
-        static bool on = true;
-        if (on) {
-            for (int i = 0; i < max_leds_; i++) {
-                led_strip_set_pixel(led_strip_, i, colors_[i].red, colors_[i].green, colors_[i].blue);
+    auto animation = std::make_unique<StripAnimation>();
+    animation->frame_count = 1;
+    animation->loop = false;
+    {
+        // 在尚未显示的静态帧上继续修改，连续调用时不会丢失前面设置的颜色
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (pending_ != nullptr && pending_->frame_count == 1) {
+            if (pending_->uniform) {
+                animation->frames.assign(max_leds_, pending_->frames[0]);
+            } else {
+                animation->frames = pending_->frames;
             }
-            led_strip_refresh(led_strip_);
         } else {
-            led_strip_clear(led_strip_);
+            animation->frames = colors_;
         }
-        on = !on;
-    });
+    }
+    animation->frames[index] = color;
+    Play(std::move(animation));
+}
+
+void CircularStrip::Blink(StripColor color, int interval_ms) {
+    auto animation = std::make_unique<StripAnimation>();
+    animation->frames = { color, StripColor() };
+    animation->frame_count = 2;
+    animation->interval_ms = interval_ms;
+    animation->uniform = true;
+    Play(std::move(animation));
 }
 
 void CircularStrip::FadeOut(int interval_ms) {
-    StartStripTask(interval_ms, [this]() {
-        bool all_off = true;
-        for (int i = 0; i < max_leds_; i++) {
-            colors_[i].red /= 2;
-            colors_[i].green /= 2;
-            colors_[i].blue /= 2;
-            if (colors_[i].red != 0 || colors_[i].green != 0 || colors_[i].blue != 0) {
+    std::vector<StripColor> colors;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        colors = colors_;
+    }
+
+    // 每帧亮度减半，直到全部熄灭
+    auto animation = std::make_unique<StripAnimation>();
+    animation->interval_ms = interval_ms;
+    animation->loop = false;
+    bool all_off = false;
+    while (!all_off) {
+        all_off = true;
+        for (auto& color : colors) {
+            color.red /= 2;
+            color.green /= 2;
+            color.blue /= 2;
+            if (color.red != 0 || color.green != 0 || color.blue != 0) {
                 all_off = false;
             }
-            led_strip_set_pixel(led_strip_, i, colors_[i].red, colors_[i].green, colors_[i].blue);
         }
-        if (all_off) {
-            led_strip_clear(led_strip_);
-            esp_timer_stop(strip_timer_);
-        } else {
-            led_strip_refresh(led_strip_);
-        }
-    });
+        animation->frames.insert(animation->frames.end(), colors.begin(), colors.end());
+        animation->frame_count++;
+    }
+    Play(std::move(animation));
 }
 
 void CircularStrip::Breathe(StripColor low, StripColor high, int interval_ms) {
-    StartStripTask(interval_ms, [this, low, high]() {
-        static bool increase = true;
-        static StripColor color = low;
-        if (increase) {
-            if (color.red < high.red) {
-                color.red++;
-            }
-            if (color.green < high.green) {
-                color.green++;
-            }
-            if (color.blue < high.blue) {
-                color.blue++;
-            }
-            if (color.red == high.red && color.green == high.green && color.blue == high.blue) {
-                increase = false;
-            }
-        } else {
-            if (color.red > low.red) {
-                color.red--;
-            }
-            if (color.green > low.green) {
-                color.green--;
-            }
-            if (color.blue > low.blue) {
-                color.blue--;
-            }
-            if (color.red == low.red && color.green == low.green && color.blue == low.blue) {
-                increase = true;
-            }
-        }
-        for (int i = 0; i < max_leds_; i++) {
-            led_strip_set_pixel(led_strip_, i, color.red, color.green, color.blue);
+    // 与逐级加一的步数相同，保持原有的呼吸周期
+    int steps = std::max({ std::abs(high.red - low.red), std::abs(high.green - low.green),
+        std::abs(high.blue - low.blue) });
+    if (steps == 0) {
+        SetAllColor(low);
+        return;
+    }
+
+    auto animation = std::make_unique<StripAnimation>();
+    animation->frame_count = steps * 2;
+    animation->frames.resize(animation->frame_count);
+    animation->interval_ms = interval_ms;
+    animation->uniform = true;
+    for (int i = 0; i <= steps; i++) {
+        float level = powf((float)i / steps, BREATHE_GAMMA);
+        StripColor color = {
+            (uint8_t)lroundf(low.red + (high.red - low.red) * level),
+            (uint8_t)lroundf(low.green + (high.green - low.green) * level),
+            (uint8_t)lroundf(low.blue + (high.blue - low.blue) * level),
+        };
+        // 由暗到亮再由亮到暗，两端各只出现一次
+        animation->frames[i] = color;
+        if (i > 0 && i < steps) {
+            animation->frames[steps * 2 - i] = color;
         }
-        led_strip_refresh(led_strip_);
-    });
+    }
+    Play(std::move(animation));
 }
 
 void CircularStrip::Scroll(StripColor low, StripColor high, int length, int interval_ms) {
-    for (int i = 0; i < max_leds_; i++) {
-        colors_[i] = low;
-    }
-    StartStripTask(interval_ms, [this, low, high, length]() {
-        static int offset = 0;
-        for (int i = 0; i < max_leds_; i++) {
-            colors_[i] = low;
-        }
+    auto animation = std::make_unique<StripAnimation>();
+    animation->frame_count = max_leds_;
+    animation->frames.assign(max_leds_ * max_leds_, low);
+    animation->interval_ms = interval_ms;
+    for (int offset = 0; offset < max_leds_; offset++) {
+        auto frame = animation->frames.begin() + offset * max_leds_;
         for (int j = 0; j < length; j++) {
-            int i = (offset + j) % max_leds_;
-            colors_[i] = high;
-        }
-        for (int i = 0; i < max_leds_; i++) {
-            led_strip_set_pixel(led_strip_, i, colors_[i].red, colors_[i].green, colors_[i].blue);
+            frame[(offset + j) % max_leds_] = high;
         }
-        led_strip_refresh(led_strip_);
-        offset = (offset + 1) % max_leds_;
-    });
-}
-
-void CircularStrip::StartStripTask(int interval_ms, std::function<void()> cb) {
-    if (led_strip_ == nullptr) {
-        return;
     }
-
-    std::lock_guard<std::mutex> lock(mutex_);
-    esp_timer_stop(strip_timer_);
-    
-    strip_callback_ = cb;
-    esp_timer_start_periodic(strip_timer_, interval_ms * 1000);
+    Play(std::move(animation));
 }
 
 void CircularStrip::SetBrightness(uint8_t default_brightness, uint8_t low_brightness) {
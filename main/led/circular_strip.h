@@ -4,8 +4,10 @@
 #include "led.h"
 #include <driver/gpio.h>
 #include <led_strip.h>
-#include <esp_timer.h>
+#include <freertos/FreeRTOS.h>
+#include <freertos/task.h>
 #include <atomic>
+#include <memory>
 #include <mutex>
 #include <vector>
 
@@ -14,8 +16,27 @@
 
 struct StripColor {
     uint8_t red = 0, green = 0, blue = 0;
+
+    bool operator==(const StripColor& other) const {
+        return red == other.red && green == other.green && blue == other.blue;
+    }
+    bool operator!=(const StripColor& other) const { return !(*this == other); }
+};
+
+// 预先计算好的关键帧表，播放时只按间隔逐帧输出
+struct StripAnimation {
+    std::vector<StripColor> frames;     // uniform 时每帧一个颜色，否则每帧 max_leds 个
+    int frame_count = 0;
+    int interval_ms = 0;
+    bool uniform = false;               // 所有 LED 同色
+    bool loop = true;                   // 不循环时停在最后一帧
 };
 
+/*
+ * 动画在创建时一次性生成关键帧表，由低优先级的 led_strip 任务按帧间隔输出，
+ * 不再占用 esp_timer 任务计算颜色和等待 RMT 发送完成。
+ * 与上一帧（已发送的前台缓冲）相同的帧不会重新发送。
+ */
 class CircularStrip : public Led {
 public:
     CircularStrip(gpio_num_t gpio, uint8_t max_leds);
@@ -30,21 +51,21 @@ public:
     void Scroll(StripColor low, StripColor high, int length, int interval_ms);
 
 private:
-    std::mutex mutex_;
-    TaskHandle_t blink_task_ = nullptr;
+    std::mutex mutex_;                  // 保护 pending_ 和 colors_
+    TaskHandle_t strip_task_ = nullptr;
     led_strip_handle_t led_strip_ = nullptr;
     int max_leds_ = 0;
-    std::vector<StripColor> colors_;
-    int blink_counter_ = 0;
-    int blink_interval_ms_ = 0;
-    esp_timer_handle_t strip_timer_ = nullptr;
-    std::function<void()> strip_callback_ = nullptr;
+    std::vector<StripColor> colors_;    // 当前显示的颜色（前台缓冲）
+    std::unique_ptr<StripAnimation> pending_;
+    std::atomic<bool> stopping_ = false;
+    std::atomic<bool> task_exited_ = false;
 
     uint8_t default_brightness_ = DEFAULT_BRIGHTNESS;
     uint8_t low_brightness_ = LOW_BRIGHTNESS;
 
-    void StartStripTask(int interval_ms, std::function<void()> cb);
-    void Rainbow(StripColor low, StripColor high, int interval_ms);
+    void Play(std::unique_ptr<StripAnimation> animation);
+    void StripTask();
+    void ShowFrame(const StripAnimation& animation, int frame);
     void FadeOut(int interval_ms);
 };
 
@@ -7,11 +7,15 @@
 
 #include "application.h"
 #include "system_info.h"
+#include "memory_policy.h"
 
 #define TAG "main"
 
 extern "C" void app_main(void)
 {
+    // cJSON 的分配在第一次使用前切换到内存策略
+    MemoryPolicy::GetInstance().InstallCJsonHooks();
+
     // Initialize the default event loop
     ESP_ERROR_CHECK(esp_event_loop_create_default());
 
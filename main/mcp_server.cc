@@ -16,6 +16,10 @@
 #include "application.h"
 #include "board.h"
 #include "display.h"
+#include "heap_guard.h"
+#include "i2c_device.h"
+#include "memory_policy.h"
+#include "power_governor.h"
 #include "protocol.h"
 
 #define TAG "MCP"
@@ -208,6 +212,73 @@ void McpServer::AddCommonTools()
                 return true;
             });
 
+    AddTool("self.network.get_link_stats",
+            "Get the link quality statistics of the current conversation session, including RTT, jitter, packet loss and send blocking time.\n"
+            "Use this tool when the user asks about the network quality or why the voice is lagging.",
+            PropertyList(), [](const PropertyList &properties) -> ReturnValue { return Application::GetInstance().GetLinkQuality().ToJson(); });
+
+    AddTool("self.audio.get_tts_cache_stats",
+            "Get the statistics of the on-device TTS audio cache, including hit rate, downlink bytes saved and flash usage.",
+            PropertyList(), [](const PropertyList &properties) -> ReturnValue { return Application::GetInstance().GetTtsCacheStatistics().ToJson(); });
+
+    AddTool("self.audio.get_barge_in_latency", "Get the latency from interrupting the assistant (wake word or stop command) until the speaker goes silent.", PropertyList(),
+            [](const PropertyList &properties) -> ReturnValue
+            {
+                auto stats = Application::GetInstance().GetAudioService().GetBargeInStatistics();
+                uint32_t avg = stats.count > 0 ? stats.total_latency_ms / stats.count : 0;
+                return "{\"count\":" + std::to_string(stats.count) + ",\"last_ms\":" + std::to_string(stats.last_latency_ms) + ",\"avg_ms\":" + std::to_string(avg) +
+                       ",\"max_ms\":" + std::to_string(stats.max_latency_ms) + "}";
+            });
+
+    AddTool("self.get_event_bus_stats", "Get per event type statistics of the internal event bus: posted and dropped counts, dispatch latency and subscriber handling time.", PropertyList(),
+            [](const PropertyList &properties) -> ReturnValue { return EventBus::GetInstance().GetStatisticsJson(); });
+
+    AddTool("self.get_power_stats", "Get CPU power governor statistics: time spent in sleep, idle and active (max frequency) mode per device state, and the latency from wake word detection to frequency boost.", PropertyList(),
+            [](const PropertyList &properties) -> ReturnValue { return PowerGovernor::GetInstance().GetStatisticsJson(); });
+
+    AddTool("self.get_memory_stats", "Get heap usage per subsystem (audio, network, ui, camera): bytes in internal RAM and PSRAM, peak, allocation failures and placement fallbacks, plus free internal RAM and PSRAM.", PropertyList(),
+            [](const PropertyList &properties) -> ReturnValue { return MemoryPolicy::GetInstance().GetStatisticsJson(); });
+
+    AddTool("self.get_i2c_stats", "Get I2C traffic statistics of PMIC, charger and other register devices: bus transactions, bytes, reads served from the register cache, cache refreshes and skipped unchanged writes.", PropertyList(),
+            [](const PropertyList &properties) -> ReturnValue { return I2cDevice::GetStatisticsJson(); });
+
+    AddTool("self.get_heap_status", "Get heap fragmentation status: free size, largest free block and fragmentation per heap, largest block trend, and how often each compaction point (decoder_pool, image_cache, chat_history) ran and what it reclaimed.", PropertyList(),
+            [](const PropertyList &properties) -> ReturnValue { return HeapGuard::GetInstance().GetStatusJson(); });
+
+    AddTool("self.audio.get_dma_profile_stats", "Get the I2S DMA buffer profiles (low_latency, balanced, low_power): buffer latency, time spent and measured DMA interrupts per second.", PropertyList(),
+            [](const PropertyList &properties) -> ReturnValue
+            {
+                static const char *const names[] = {"low_latency", "balanced", "low_power"};
+                auto stats = Application::GetInstance().GetAudioService().GetDmaProfileStatistics();
+                std::string json = "{";
+                for (size_t i = 0; i < stats.size(); i++)
+                {
+                    if (i > 0)
+                    {
+                        json += ",";
+                    }
+                    json += "\"" + std::string(names[i]) + "\":{\"switches\":" + std::to_string(stats[i].switches) +
+                            ",\"buffer_ms\":" + std::to_string(stats[i].buffer_latency_ms) + ",\"active_ms\":" + std::to_string(stats[i].active_ms) +
+                            ",\"irq_per_sec\":" + std::to_string(stats[i].InterruptsPerSecond()) + "}";
+                }
+                return json + "}";
+            });
+
+#if CONFIG_USE_AUDIO_DEBUGGER
+    AddTool("self.audio.set_debug_taps",
+            "Select which audio debug streams are sent to the UDP debug server.\n"
+            "Args:\n"
+            "  `taps`: comma separated list of mic, reference, afe_output, downlink, playback, or `all`; empty to stop.\n"
+            "  `codec`: `pcm` or `adpcm` (4:1 compressed).",
+            PropertyList({Property("taps", kPropertyTypeString), Property("codec", kPropertyTypeString, "adpcm")}),
+            [](const PropertyList &properties) -> ReturnValue
+            {
+                auto &audio_service = Application::GetInstance().GetAudioService();
+                audio_service.ConfigureAudioDebugger(properties["taps"].value<std::string>(), properties["codec"].value<std::string>());
+                return audio_service.GetAudioDebuggerStatus();
+            });
+#endif
+
     auto backlight = board.GetBacklight();
     if (backlight)
     {
@@ -0,0 +1,135 @@
+#include "memory_policy.h"
+
+#include <esp_log.h>
+#include <esp_memory_utils.h>
+#include <cJSON.h>
+
+#define TAG "MemoryPolicy"
+
+#define INTERNAL_CAPS (MALLOC_CAP_INTERNAL | MALLOC_CAP_8BIT)
+
+static const char* const kTagNames[kMemoryTagCount] = {
+    "audio", "network", "ui", "camera",
+};
+
+const char* MemoryPolicy::GetTagName(MemoryTag tag) {
+    return tag < kMemoryTagCount ? kTagNames[tag] : "unknown";
+}
+
+void* MemoryPolicy::AllocateCaps(size_t size, size_t alignment, uint32_t caps) {
+    if (alignment > 0) {
+        return heap_caps_aligned_alloc(alignment, size, caps);
+    }
+    return heap_caps_malloc(size, caps);
+}
+
+void* MemoryPolicy::Allocate(MemoryTag tag, MemoryPlacement placement, size_t size, size_t alignment) {
+    auto& counters = counters_[tag];
+    void* ptr = nullptr;
+    bool fallback = false;
+    switch (placement) {
+    case kMemoryPlacementDma:
+        ptr = AllocateCaps(size, alignment, MALLOC_CAP_DMA | INTERNAL_CAPS);
+        break;
+    case kMemoryPlacementInternal:
+        ptr = AllocateCaps(size, alignment, INTERNAL_CAPS);
+        if (ptr == nullptr) {
+            ptr = AllocateCaps(size, alignment, MALLOC_CAP_8BIT);
+            fallback = true;
+        }
+        break;
+    case kMemoryPlacementPsram:
+#if CONFIG_SPIRAM
+        ptr = AllocateCaps(size, alignment, MALLOC_CAP_SPIRAM | MALLOC_CAP_8BIT);
+        if (ptr == nullptr) {
+            // PSRAM 不足时退回内部 RAM，但要给 DMA 和任务栈留出余量
+            size_t free_internal = heap_caps_get_free_size(INTERNAL_CAPS);
+            if (free_internal > size + CONFIG_MEMORY_POLICY_INTERNAL_RESERVE_KB * 1024) {
+                ptr = AllocateCaps(size, alignment, INTERNAL_CAPS);
+            }
+            fallback = true;
+        }
+#else
+        ptr = AllocateCaps(size, alignment, INTERNAL_CAPS);
+#endif
+        break;
+    }
+
+    if (ptr == nullptr) {
+        if (counters.failures++ % 10 == 0) {
+            ESP_LOGW(TAG, "Failed to allocate %u bytes for %s", size, GetTagName(tag));
+        }
+        return nullptr;
+    }
+    if (fallback) {
+        counters.fallbacks++;
+    }
+    counters.allocations++;
+    size_t allocated = heap_caps_get_allocated_size(ptr);
+    uint32_t total;
+    if (esp_ptr_external_ram(ptr)) {
+        total = (counters.psram_bytes += allocated) + counters.internal_bytes;
+    } else {
+        total = (counters.internal_bytes += allocated) + counters.psram_bytes;
+    }
+    uint32_t peak = counters.peak_bytes;
+    while (total > peak && !counters.peak_bytes.compare_exchange_weak(peak, total)) {
+    }
+    return ptr;
+}
+
+void MemoryPolicy::Free(MemoryTag tag, void* ptr) {
+    if (ptr == nullptr) {
+        return;
+    }
+    auto& counters = counters_[tag];
+    size_t allocated = heap_caps_get_allocated_size(ptr);
+    if (esp_ptr_external_ram(ptr)) {
+        counters.psram_bytes -= allocated;
+    } else {
+        counters.internal_bytes -= allocated;
+    }
+    heap_caps_free(ptr);
+}
+
+void MemoryPolicy::InstallCJsonHooks() {
+    cJSON_Hooks hooks = {
+        .malloc_fn = [](size_t size) -> void* {
+            // 小块（节点、键名）访问频繁，放内部 RAM；大块（长字符串、打印缓冲）放 PSRAM
+            auto placement = size < CONFIG_MEMORY_POLICY_CJSON_PSRAM_THRESHOLD ? kMemoryPlacementInternal : kMemoryPlacementPsram;
+            return MemoryPolicy::GetInstance().Allocate(kMemoryTagNetwork, placement, size);
+        },
+        .free_fn = [](void* ptr) {
+            MemoryPolicy::GetInstance().Free(kMemoryTagNetwork, ptr);
+        },
+    };
+    cJSON_InitHooks(&hooks);
+}
+
+MemoryTagStatistics MemoryPolicy::GetStatistics(MemoryTag tag) {
+    auto& counters = counters_[tag];
+    MemoryTagStatistics stats;
+    stats.internal_bytes = counters.internal_bytes;
+    stats.psram_bytes = counters.psram_bytes;
+    stats.peak_bytes = counters.peak_bytes;
+    stats.allocations = counters.allocations;
+    stats.failures = counters.failures;
+    stats.fallbacks = counters.fallbacks;
+    return stats;
+}
+
+std::string MemoryPolicy::GetStatisticsJson() {
+    std::string json = "{\"free_internal\":" + std::to_string(heap_caps_get_free_size(INTERNAL_CAPS)) +
+        ",\"free_psram\":" + std::to_string(heap_caps_get_free_size(MALLOC_CAP_SPIRAM)) + ",\"tags\":{";
+    for (int tag = 0; tag < kMemoryTagCount; tag++) {
+        auto stats = GetStatistics((MemoryTag)tag);
+        if (tag > 0) {
+            json += ",";
+        }
+        json += "\"" + std::string(kTagNames[tag]) + "\":{\"internal_bytes\":" + std::to_string(stats.internal_bytes) +
+            ",\"psram_bytes\":" + std::to_string(stats.psram_bytes) + ",\"peak_bytes\":" + std::to_string(stats.peak_bytes) +
+            ",\"allocations\":" + std::to_string(stats.allocations) + ",\"failures\":" + std::to_string(stats.failures) +
+            ",\"fallbacks\":" + std::to_string(stats.fallbacks) + "}";
+    }
+    return json + "}}";
+}
@@ -0,0 +1,119 @@
+#ifndef _MEMORY_POLICY_H_
+#define _MEMORY_POLICY_H_
+
+#include <esp_heap_caps.h>
+
+#include <atomic>
+#include <cstddef>
+#include <new>
+#include <string>
+#include <vector>
+
+enum MemoryTag {
+    kMemoryTagAudio,
+    kMemoryTagNetwork,      // 协议、cJSON 等
+    kMemoryTagUi,
+    kMemoryTagCamera,
+    kMemoryTagCount,
+};
+
+enum MemoryPlacement {
+    kMemoryPlacementDma,        // 外设 DMA 直接访问，只能在内部 RAM
+    kMemoryPlacementInternal,   // 频繁访问的热数据，内部 RAM 不足时才放 PSRAM
+    kMemoryPlacementPsram,      // 大块、访问不频繁的数据，优先 PSRAM
+};
+
+struct MemoryTagStatistics {
+    uint32_t internal_bytes = 0;
+    uint32_t psram_bytes = 0;
+    uint32_t peak_bytes = 0;
+    uint32_t allocations = 0;
+    uint32_t failures = 0;
+    uint32_t fallbacks = 0;     // 未能放在期望位置的分配次数
+};
+
+/*
+ * 按子系统标记的内存分配策略。
+ * 放置位置由 MemoryPlacement 集中决定：有 PSRAM 的板子上大块数据放 PSRAM，
+ * 内部 RAM 留给 DMA 和任务栈；PSRAM 不足退回内部 RAM 时保留 CONFIG_MEMORY_POLICY_INTERNAL_RESERVE_KB。
+ * 每个标记统计当前占用（按实际块大小）、峰值和失败次数。
+ */
+class MemoryPolicy {
+public:
+    static MemoryPolicy& GetInstance() {
+        static MemoryPolicy instance;
+        return instance;
+    }
+    MemoryPolicy(const MemoryPolicy&) = delete;
+    MemoryPolicy& operator=(const MemoryPolicy&) = delete;
+
+    // alignment 为 0 时不要求对齐，失败返回 nullptr
+    void* Allocate(MemoryTag tag, MemoryPlacement placement, size_t size, size_t alignment = 0);
+    void Free(MemoryTag tag, void* ptr);
+    // 让 cJSON 的分配走网络标记：小于 CONFIG_MEMORY_POLICY_CJSON_PSRAM_THRESHOLD 的放内部 RAM，
+    // 其余放 PSRAM。需在第一次使用 cJSON 之前调用
+    void InstallCJsonHooks();
+
+    MemoryTagStatistics GetStatistics(MemoryTag tag);
+    std::string GetStatisticsJson();
+    static const char* GetTagName(MemoryTag tag);
+
+private:
+    struct Counters {
+        std::atomic<uint32_t> internal_bytes = 0;
+        std::atomic<uint32_t> psram_bytes = 0;
+        std::atomic<uint32_t> peak_bytes = 0;
+        std::atomic<uint32_t> allocations = 0;
+        std::atomic<uint32_t> failures = 0;
+        std::atomic<uint32_t> fallbacks = 0;
+    };
+    Counters counters_[kMemoryTagCount];
+
+    MemoryPolicy() = default;
+    ~MemoryPolicy() = default;
+
+    void* AllocateCaps(size_t size, size_t alignment, uint32_t caps);
+};
+
+// STL 兼容的分配器，例如 std::vector<int16_t, TaggedAllocator<int16_t, kMemoryTagAudio, kMemoryPlacementPsram>>
+template <typename T, MemoryTag Tag, MemoryPlacement Placement>
+class TaggedAllocator {
+public:
+    typedef T value_type;
+
+    template <typename U>
+    struct rebind {
+        typedef TaggedAllocator<U, Tag, Placement> other;
+    };
+
+    TaggedAllocator() noexcept = default;
+    template <typename U>
+    TaggedAllocator(const TaggedAllocator<U, Tag, Placement>&) noexcept {}
+
+    T* allocate(size_t n) {
+        auto ptr = MemoryPolicy::GetInstance().Allocate(Tag, Placement, n * sizeof(T));
+        if (ptr == nullptr) {
+            throw std::bad_alloc();
+        }
+        return static_cast<T*>(ptr);
+    }
+
+    void deallocate(T* ptr, size_t) noexcept {
+        MemoryPolicy::GetInstance().Free(Tag, ptr);
+    }
+};
+
+template <typename T, typename U, MemoryTag Tag, MemoryPlacement Placement>
+bool operator==(const TaggedAllocator<T, Tag, Placement>&, const TaggedAllocator<U, Tag, Placement>&) {
+    return true;
+}
+
+template <typename T, typename U, MemoryTag Tag, MemoryPlacement Placement>
+bool operator!=(const TaggedAllocator<T, Tag, Placement>&, const TaggedAllocator<U, Tag, Placement>&) {
+    return false;
+}
+
+template <typename T, MemoryTag Tag, MemoryPlacement Placement>
+using TaggedVector = std::vector<T, TaggedAllocator<T, Tag, Placement>>;
+
+#endif // _MEMORY_POLICY_H_
@@ -0,0 +1,237 @@
+#include "power_governor.h"
+#include "event_bus.h"
+
+#include <esp_log.h>
+#include <algorithm>
+
+#define TAG "PowerGovernor"
+
+#define POWER_GOVERNOR_CHECK_INTERVAL_MS 500
+// 唤醒词触发升频后如果没有进入对话（如被忽略），超时后恢复
+#define POWER_GOVERNOR_WAKE_BOOST_TIMEOUT_MS 3000
+
+static const char* const kStateNames[POWER_GOVERNOR_STATE_COUNT] = {
+    "unknown", "starting", "configuring", "idle", "connecting", "listening", "speaking",
+    "upgrading", "activating", "audio_testing", "fatal_error", "login",
+};
+
+static const char* const kModeNames[kPowerModeCount] = {
+    "sleep", "idle", "active",
+};
+
+static esp_pm_lock_handle_t CreateLock(esp_pm_lock_type_t type, const char* name) {
+    esp_pm_lock_handle_t lock = nullptr;
+    auto ret = esp_pm_lock_create(type, 0, name, &lock);
+    if (ret == ESP_ERR_NOT_SUPPORTED) {
+        return nullptr;
+    }
+    ESP_ERROR_CHECK(ret);
+    return lock;
+}
+
+PowerGovernor::PowerGovernor() {
+    cpu_max_lock_ = CreateLock(ESP_PM_CPU_FREQ_MAX, "gov_cpu_max");
+    no_sleep_lock_ = CreateLock(ESP_PM_NO_LIGHT_SLEEP, "gov_no_sleep");
+    locks_[kPowerLockApbMax] = CreateLock(ESP_PM_APB_FREQ_MAX, "gov_apb_max");
+    if (cpu_max_lock_ == nullptr) {
+        ESP_LOGI(TAG, "Power management not supported");
+    }
+    max_freq_mhz_ = CONFIG_ESP_DEFAULT_CPU_FREQ_MHZ;
+    mode_start_time_us_ = esp_timer_get_time();
+}
+
+PowerGovernor::~PowerGovernor() {
+    if (load_timer_ != nullptr) {
+        esp_timer_stop(load_timer_);
+        esp_timer_delete(load_timer_);
+    }
+    for (auto lock : { cpu_max_lock_, no_sleep_lock_, locks_[kPowerLockApbMax] }) {
+        if (lock != nullptr) {
+            esp_pm_lock_delete(lock);
+        }
+    }
+}
+
+void PowerGovernor::Initialize(std::function<bool()> load_probe) {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        load_probe_ = load_probe;
+        // 不在这里配置 DFS：只有开发板通过 PowerSaveTimer 指定了 CPU 最高频率才算启用，
+        // 否则保持 sdkconfig 和开发板自己的 esp_pm 配置
+        UpdateMode();
+    }
+
+    EventBus::GetInstance().Subscribe(kDeviceEventStateChanged, [this](const DeviceEvent& event) {
+        OnStateChanged(event.state.current);
+    });
+
+    esp_timer_create_args_t timer_args = {
+        .callback = [](void* arg) {
+            static_cast<PowerGovernor*>(arg)->CheckLoad();
+        },
+        .arg = this,
+        .dispatch_method = ESP_TIMER_TASK,
+        .name = "power_governor",
+        .skip_unhandled_events = true,
+    };
+    ESP_ERROR_CHECK(esp_timer_create(&timer_args, &load_timer_));
+    ESP_ERROR_CHECK(esp_timer_start_periodic(load_timer_, POWER_GOVERNOR_CHECK_INTERVAL_MS * 1000));
+}
+
+// 调用者需持有 mutex_
+void PowerGovernor::ConfigureDfs(int max_freq_mhz, int min_freq_mhz, bool light_sleep) {
+#if CONFIG_PM_ENABLE
+    esp_pm_config_t pm_config = {
+        .max_freq_mhz = max_freq_mhz,
+        .min_freq_mhz = min_freq_mhz,
+        .light_sleep_enable = light_sleep,
+    };
+    auto ret = esp_pm_configure(&pm_config);
+    if (ret != ESP_OK) {
+        ESP_LOGW(TAG, "Failed to configure DFS %d-%d MHz: %s", min_freq_mhz, max_freq_mhz, esp_err_to_name(ret));
+        return;
+    }
+    ESP_LOGI(TAG, "DFS %d-%d MHz, light sleep %s", min_freq_mhz, max_freq_mhz, light_sleep ? "on" : "off");
+#endif
+}
+
+// 调用者需持有 mutex_。先把当前状态和模式的时长记入统计，再按新条件切换
+void PowerGovernor::UpdateMode() {
+    auto now = esp_timer_get_time();
+    statistics_.residency_ms[state_][mode_] += (now - mode_start_time_us_) / 1000;
+    mode_start_time_us_ = now;
+
+    bool active_state = state_ != kDeviceStateIdle && state_ != kDeviceStateUnknown &&
+        state_ != kDeviceStateFatalError && state_ != kDeviceStateLogin;
+    PowerMode mode;
+    if (active_state || wake_boost_ || load_boost_) {
+        mode = kPowerModeActive;
+    } else if (sleeping_) {
+        mode = kPowerModeSleep;
+    } else {
+        mode = kPowerModeIdle;
+    }
+    if (mode == mode_) {
+        return;
+    }
+
+    if (mode == kPowerModeActive) {
+        if (cpu_max_lock_ != nullptr) {
+            esp_pm_lock_acquire(cpu_max_lock_);
+            esp_pm_lock_acquire(no_sleep_lock_);
+        }
+        statistics_.boosts++;
+    } else if (mode_ == kPowerModeActive) {
+        if (cpu_max_lock_ != nullptr) {
+            esp_pm_lock_release(cpu_max_lock_);
+            esp_pm_lock_release(no_sleep_lock_);
+        }
+    }
+    ESP_LOGI(TAG, "Mode %s -> %s in state %s", kModeNames[mode_], kModeNames[mode], kStateNames[state_]);
+    mode_ = mode;
+}
+
+void PowerGovernor::OnStateChanged(DeviceState state) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (state >= POWER_GOVERNOR_STATE_COUNT) {
+        return;
+    }
+    // 先以旧状态结算，再切换
+    UpdateMode();
+    state_ = state;
+    wake_boost_ = false;
+    UpdateMode();
+}
+
+void PowerGovernor::OnWakeWordDetected(int64_t detect_time_us) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    wake_boost_ = true;
+    UpdateMode();
+    wake_boost_time_us_ = esp_timer_get_time();
+    if (detect_time_us > 0) {
+        uint32_t latency_us = wake_boost_time_us_ - detect_time_us;
+        statistics_.wake_boost_count++;
+        statistics_.last_wake_boost_us = latency_us;
+        statistics_.max_wake_boost_us = std::max(statistics_.max_wake_boost_us, latency_us);
+        statistics_.total_wake_boost_us += latency_us;
+    }
+}
+
+void PowerGovernor::CheckLoad() {
+    bool load = load_probe_ ? load_probe_() : false;
+    std::lock_guard<std::mutex> lock(mutex_);
+    load_boost_ = load;
+    if (wake_boost_ && (esp_timer_get_time() - wake_boost_time_us_) / 1000 > POWER_GOVERNOR_WAKE_BOOST_TIMEOUT_MS) {
+        wake_boost_ = false;
+    }
+    UpdateMode();
+}
+
+void PowerGovernor::EnterSleepMode(int cpu_max_freq) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (cpu_max_freq != -1) {
+        max_freq_mhz_ = cpu_max_freq;
+        ConfigureDfs(max_freq_mhz_, 40, true);
+    }
+    sleeping_ = true;
+    UpdateMode();
+}
+
+void PowerGovernor::ExitSleepMode(int cpu_max_freq) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (cpu_max_freq != -1) {
+        max_freq_mhz_ = cpu_max_freq;
+        ConfigureDfs(max_freq_mhz_, std::min(CONFIG_PM_GOVERNOR_IDLE_FREQ_MHZ, max_freq_mhz_), false);
+    }
+    sleeping_ = false;
+    UpdateMode();
+}
+
+void PowerGovernor::Acquire(PowerLockType type) {
+    if (locks_[type] != nullptr) {
+        esp_pm_lock_acquire(locks_[type]);
+    }
+}
+
+void PowerGovernor::Release(PowerLockType type) {
+    if (locks_[type] != nullptr) {
+        esp_pm_lock_release(locks_[type]);
+    }
+}
+
+PowerMode PowerGovernor::mode() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return mode_;
+}
+
+PowerGovernorStatistics PowerGovernor::GetStatistics() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    UpdateMode();
+    return statistics_;
+}
+
+std::string PowerGovernor::GetStatisticsJson() {
+    auto stats = GetStatistics();
+    std::string json = "{\"residency_ms\":{";
+    bool first = true;
+    for (int state = 0; state < POWER_GOVERNOR_STATE_COUNT; state++) {
+        auto& residency = stats.residency_ms[state];
+        if (residency[kPowerModeSleep] + residency[kPowerModeIdle] + residency[kPowerModeActive] == 0) {
+            continue;
+        }
+        json += first ? "\"" : ",\"";
+        json += std::string(kStateNames[state]) + "\":{";
+        for (int mode = 0; mode < kPowerModeCount; mode++) {
+            json += (mode > 0 ? ",\"" : "\"") + std::string(kModeNames[mode]) + "\":" + std::to_string(residency[mode]);
+        }
+        json += "}";
+        first = false;
+    }
+    uint32_t avg_wake_boost_us = stats.wake_boost_count > 0 ? stats.total_wake_boost_us / stats.wake_boost_count : 0;
+    json += "},\"boosts\":" + std::to_string(stats.boosts) +
+        ",\"wake_boost\":{\"count\":" + std::to_string(stats.wake_boost_count) +
+        ",\"last_us\":" + std::to_string(stats.last_wake_boost_us) +
+        ",\"avg_us\":" + std::to_string(avg_wake_boost_us) +
+        ",\"max_us\":" + std::to_string(stats.max_wake_boost_us) + "}}";
+    return json;
+}
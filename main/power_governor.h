@@ -0,0 +1,92 @@
+#ifndef _POWER_GOVERNOR_H_
+#define _POWER_GOVERNOR_H_
+
+#include <esp_pm.h>
+#include <esp_timer.h>
+
+#include <functional>
+#include <mutex>
+#include <string>
+
+#include "device_state.h"
+
+#define POWER_GOVERNOR_STATE_COUNT (kDeviceStateLogin + 1)
+
+enum PowerMode {
+    kPowerModeSleep,        // 省电模式：允许自动 light sleep，频率可降到 40MHz
+    kPowerModeIdle,         // 待命：释放锁，DFS 在 [待命最低频率, 最高频率] 之间调节
+    kPowerModeActive,       // 对话等：持有 CPU 最高频率和禁止 light sleep 的锁
+    kPowerModeCount,
+};
+
+enum PowerLockType {
+    kPowerLockApbMax,       // 屏幕刷新等需要 APB 最高频率的短时操作
+    kPowerLockCount,
+};
+
+struct PowerGovernorStatistics {
+    uint64_t residency_ms[POWER_GOVERNOR_STATE_COUNT][kPowerModeCount] = {};
+    uint32_t boosts = 0;
+    uint32_t wake_boost_count = 0;
+    uint32_t last_wake_boost_us = 0;    // 从检测到唤醒词到升频的延迟
+    uint32_t max_wake_boost_us = 0;
+    uint64_t total_wake_boost_us = 0;
+};
+
+/*
+ * 统一管理电源锁和 DFS 频率范围。
+ * 根据设备状态（经事件总线）、唤醒词和音频负载决定 CPU 是否升到最高频率，
+ * PowerSaveTimer 进入/退出省电模式也由这里配置 esp_pm，其他模块不再直接调用 esp_pm。
+ * DFS 频率范围只在开发板给 PowerSaveTimer 指定了 CPU 最高频率时才会修改。
+ * 未开启 CONFIG_PM_ENABLE 时只做统计。
+ */
+class PowerGovernor {
+public:
+    static PowerGovernor& GetInstance() {
+        static PowerGovernor instance;
+        return instance;
+    }
+    PowerGovernor(const PowerGovernor&) = delete;
+    PowerGovernor& operator=(const PowerGovernor&) = delete;
+
+    // load_probe 返回 true 表示音频仍在处理（如待命时播放提示音），需要保持升频
+    void Initialize(std::function<bool()> load_probe);
+    // 唤醒词检测后立即升频，不等待状态切换；detect_time_us 为检测时刻
+    void OnWakeWordDetected(int64_t detect_time_us);
+    void EnterSleepMode(int cpu_max_freq);
+    void ExitSleepMode(int cpu_max_freq);
+    void Acquire(PowerLockType type);
+    void Release(PowerLockType type);
+
+    PowerMode mode();
+    PowerGovernorStatistics GetStatistics();
+    std::string GetStatisticsJson();
+
+private:
+    std::mutex mutex_;
+    std::function<bool()> load_probe_;
+    esp_timer_handle_t load_timer_ = nullptr;
+    esp_pm_lock_handle_t cpu_max_lock_ = nullptr;
+    esp_pm_lock_handle_t no_sleep_lock_ = nullptr;
+    esp_pm_lock_handle_t locks_[kPowerLockCount] = {};
+
+    DeviceState state_ = kDeviceStateUnknown;
+    PowerMode mode_ = kPowerModeIdle;
+    bool sleeping_ = false;
+    bool wake_boost_ = false;       // 唤醒词触发的升频，进入下一个状态后由状态决定
+    bool load_boost_ = false;
+    int max_freq_mhz_ = 0;
+    int64_t wake_boost_time_us_ = 0;
+    int64_t mode_start_time_us_ = 0;
+    PowerGovernorStatistics statistics_;
+
+    PowerGovernor();
+    ~PowerGovernor();
+
+    void OnStateChanged(DeviceState state);
+    void CheckLoad();
+    void UpdateMode();
+    void ConfigureDfs(int max_freq_mhz, int min_freq_mhz, bool light_sleep);
+};
+
+#endif // _POWER_GOVERNOR_H_
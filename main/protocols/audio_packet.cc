@@ -0,0 +1,77 @@
+#include "audio_packet.h"
+
+#include <arpa/inet.h>
+#include <cstring>
+
+std::string_view SerializeAudioPacket(int version, const AudioStreamPacket &packet, std::string &buffer)
+{
+    if (version == 2)
+    {
+        buffer.resize(sizeof(BinaryProtocol2) + packet.payload.size());
+        auto bp2 = (BinaryProtocol2 *)buffer.data();
+        bp2->version = htons(version);
+        bp2->type = 0;
+        bp2->reserved = 0;
+        bp2->timestamp = htonl(packet.timestamp);
+        bp2->payload_size = htonl(packet.payload.size());
+        memcpy(bp2->payload, packet.payload.data(), packet.payload.size());
+    }
+    else if (version == 3)
+    {
+        buffer.resize(sizeof(BinaryProtocol3) + packet.payload.size());
+        auto bp3 = (BinaryProtocol3 *)buffer.data();
+        bp3->type = 0;
+        bp3->reserved = 0;
+        bp3->payload_size = htons(packet.payload.size());
+        memcpy(bp3->payload, packet.payload.data(), packet.payload.size());
+    }
+    else
+    {
+        return std::string_view((const char *)packet.payload.data(), packet.payload.size());
+    }
+    return buffer;
+}
+
+std::unique_ptr<AudioStreamPacket> ParseAudioPacket(int version, const char *data, size_t length, int sample_rate, int frame_duration)
+{
+    auto packet = std::make_unique<AudioStreamPacket>();
+    packet->sample_rate = sample_rate;
+    packet->frame_duration = frame_duration;
+
+    // 帧头按字节拷贝出来，不修改接收缓冲区，也不要求对齐
+    auto payload = (const uint8_t *)data;
+    size_t payload_size = length;
+    if (version == 2)
+    {
+        BinaryProtocol2 bp2;
+        if (length < sizeof(bp2))
+        {
+            return nullptr;
+        }
+        memcpy(&bp2, data, sizeof(bp2));
+        packet->timestamp = ntohl(bp2.timestamp);
+        payload_size = ntohl(bp2.payload_size);
+        payload += sizeof(bp2);
+        if (payload_size > length - sizeof(bp2))
+        {
+            return nullptr;
+        }
+    }
+    else if (version == 3)
+    {
+        BinaryProtocol3 bp3;
+        if (length < sizeof(bp3))
+        {
+            return nullptr;
+        }
+        memcpy(&bp3, data, sizeof(bp3));
+        payload_size = ntohs(bp3.payload_size);
+        payload += sizeof(bp3);
+        if (payload_size > length - sizeof(bp3))
+        {
+            return nullptr;
+        }
+    }
+    packet->payload.assign(payload, payload + payload_size);
+    return packet;
+}
@@ -0,0 +1,46 @@
+#ifndef AUDIO_PACKET_H
+#define AUDIO_PACKET_H
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <vector>
+
+struct AudioStreamPacket
+{
+    int sample_rate = 0;
+    int frame_duration = 0;
+    uint32_t timestamp = 0;
+    std::vector<uint8_t> payload;
+};
+
+struct BinaryProtocol2
+{
+    uint16_t version;
+    uint16_t type;         // Message type (0: OPUS, 1: JSON)
+    uint32_t reserved;     // Reserved for future use
+    uint32_t timestamp;    // Timestamp in milliseconds (used for server-side AEC)
+    uint32_t payload_size; // Payload size in bytes
+    uint8_t payload[];     // Payload data
+} __attribute__((packed));
+
+struct BinaryProtocol3
+{
+    uint8_t type;
+    uint8_t reserved;
+    uint16_t payload_size;
+    uint8_t payload[];
+} __attribute__((packed));
+
+/*
+ * WebSocket 二进制音频帧的打包和解析。版本 1 为裸 OPUS 数据，版本 2、3 带帧头，字段为网络字节序。
+ * 不依赖 ESP-IDF，可以在主机上编译做基准测试
+ */
+// 返回待发送的数据：版本 1 直接指向 packet.payload，不做拷贝；版本 2、3 将帧头和负载写入 buffer 并指向它
+std::string_view SerializeAudioPacket(int version, const AudioStreamPacket &packet, std::string &buffer);
+// 帧头不完整或 payload_size 超出数据长度时返回 nullptr
+std::unique_ptr<AudioStreamPacket> ParseAudioPacket(int version, const char *data, size_t length, int sample_rate, int frame_duration);
+
+#endif // AUDIO_PACKET_H
@@ -0,0 +1,128 @@
+#ifndef CONNECTION_RACE_H
+#define CONNECTION_RACE_H
+
+#include <network_interface.h>
+#include <freertos/FreeRTOS.h>
+#include <freertos/task.h>
+#include <esp_log.h>
+
+#include <condition_variable>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+#define CONNECTION_RACE_STAGGER_MS 300
+#define CONNECTION_RACE_TASK_STACK_SIZE (4096 * 2)
+
+/*
+ * Happy-eyeballs 风格的连接竞速：
+ * 首选网络先发起连接，若 stagger 时间内未成功，则在下一个网络上并发发起，先连上者胜出。
+ * 落败的连接在各自的任务中释放，因此 attempt 必须按值捕获，不能引用调用者的栈。
+ * attempt 应在 Connect 之前注册回调，避免连上后、返回前到达的数据或断开事件丢失；
+ * 落败的连接在释放前先交给 discard 清除回调，防止其关闭时触发调用者的断开处理。
+ * 只有一个网络时直接在调用线程中连接，不额外创建任务。
+ */
+template <typename T>
+class ConnectionRace {
+public:
+    using Attempt = std::function<T*(NetworkInterface* network)>;
+    using Discard = std::function<void(T* connection)>;
+
+    static T* Run(const std::vector<NetworkInterface*>& networks, Attempt attempt, Discard discard,
+                  NetworkInterface** winner_network = nullptr, int stagger_ms = CONNECTION_RACE_STAGGER_MS) {
+        if (networks.empty()) {
+            return nullptr;
+        }
+        if (networks.size() == 1) {
+            T* connection = attempt(networks[0]);
+            if (connection != nullptr && winner_network != nullptr) {
+                *winner_network = networks[0];
+            }
+            return connection;
+        }
+
+        auto state = std::make_shared<State>();
+        state->attempt = std::move(attempt);
+        state->discard = std::move(discard);
+
+        std::unique_lock<std::mutex> lock(state->mutex);
+        for (size_t i = 0; i < networks.size(); i++) {
+            if (i > 0) {
+                state->cv.wait_for(lock, std::chrono::milliseconds(stagger_ms), [&state]() {
+                    return state->winner != nullptr || state->pending == 0;
+                });
+                if (state->winner != nullptr) {
+                    break;
+                }
+            }
+            if (networks[i] == nullptr) {
+                continue;
+            }
+            auto job = new Job{state, networks[i], i};
+            state->pending++;
+            if (xTaskCreate(AttemptTask, "conn_race", CONNECTION_RACE_TASK_STACK_SIZE, job, 5, nullptr) != pdPASS) {
+                ESP_LOGE("ConnectionRace", "Failed to create attempt task for network %u", i);
+                state->pending--;
+                delete job;
+            }
+        }
+
+        state->cv.wait(lock, [&state]() { return state->winner != nullptr || state->pending == 0; });
+        state->finished = true;
+        if (state->winner != nullptr && winner_network != nullptr) {
+            *winner_network = state->winner_network;
+        }
+        if (state->winner != nullptr) {
+            ESP_LOGI("ConnectionRace", "Network %u won the connection race", state->winner_index);
+        }
+        return state->winner;
+    }
+
+private:
+    struct State {
+        std::mutex mutex;
+        std::condition_variable cv;
+        Attempt attempt;
+        Discard discard;
+        T* winner = nullptr;
+        NetworkInterface* winner_network = nullptr;
+        size_t winner_index = 0;
+        int pending = 0;
+        bool finished = false;
+    };
+
+    struct Job {
+        std::shared_ptr<State> state;
+        NetworkInterface* network;
+        size_t index;
+    };
+
+    static void AttemptTask(void* arg) {
+        auto job = static_cast<Job*>(arg);
+        auto& state = job->state;
+        T* connection = state->attempt(job->network);
+        {
+            std::lock_guard<std::mutex> lock(state->mutex);
+            if (connection != nullptr && state->winner == nullptr && !state->finished) {
+                state->winner = connection;
+                state->winner_network = job->network;
+                state->winner_index = job->index;
+                connection = nullptr;
+            }
+            state->pending--;
+            state->cv.notify_all();
+        }
+        // 落败者或在调用者放弃后才连上的连接，先清除回调再释放
+        if (connection != nullptr) {
+            if (state->discard) {
+                state->discard(connection);
+            }
+            delete connection;
+        }
+        delete job;
+        vTaskDelete(NULL);
+    }
+};
+
+#endif // CONNECTION_RACE_H
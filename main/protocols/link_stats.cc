@@ -0,0 +1,131 @@
+#include "link_stats.h"
+
+#include <esp_timer.h>
+#include <cJSON.h>
+#include <cmath>
+
+// RTT 与抖动均按 1/16 的系数做指数平滑，与 RFC 3550 的抖动估计一致
+#define LINK_STATS_SMOOTHING 16
+
+float LinkQuality::LossRate() const {
+    uint32_t expected = packets_received + packets_lost;
+    if (expected == 0) {
+        return 0;
+    }
+    return (float)packets_lost / expected;
+}
+
+LinkQualityLevel LinkQuality::Level() const {
+    if (rtt_samples == 0 && packets_received == 0 && packets_sent == 0) {
+        return kLinkQualityUnknown;
+    }
+    float loss = LossRate();
+    uint32_t attempts = packets_sent + send_failures;
+    float send_failure_rate = attempts > 0 ? (float)send_failures / attempts : 0;
+    if (rtt_ms > 400 || loss > 0.05f || jitter_ms > 80 || send_failure_rate > 0.05f) {
+        return kLinkQualityPoor;
+    }
+    if (rtt_ms > 150 || loss > 0.01f || jitter_ms > 30 || send_block_avg_us > 20000) {
+        return kLinkQualityFair;
+    }
+    return kLinkQualityGood;
+}
+
+std::string LinkQuality::ToJson() const {
+    static const char* const levels[] = { "unknown", "poor", "fair", "good" };
+    cJSON* root = cJSON_CreateObject();
+    cJSON_AddStringToObject(root, "quality", levels[Level()]);
+    cJSON_AddNumberToObject(root, "duration_s", duration_s);
+    cJSON_AddNumberToObject(root, "rtt_ms", rtt_ms);
+    cJSON_AddNumberToObject(root, "rtt_max_ms", rtt_max_ms);
+    cJSON_AddNumberToObject(root, "rtt_samples", rtt_samples);
+    cJSON_AddNumberToObject(root, "send_block_avg_us", send_block_avg_us);
+    cJSON_AddNumberToObject(root, "send_block_max_us", send_block_max_us);
+    cJSON_AddNumberToObject(root, "packets_sent", packets_sent);
+    cJSON_AddNumberToObject(root, "send_failures", send_failures);
+    cJSON_AddNumberToObject(root, "packets_received", packets_received);
+    cJSON_AddNumberToObject(root, "packets_lost", packets_lost);
+    cJSON_AddNumberToObject(root, "packets_reordered", packets_reordered);
+    cJSON_AddNumberToObject(root, "jitter_ms", std::round(jitter_ms * 10) / 10);
+    auto json_str = cJSON_PrintUnformatted(root);
+    std::string json(json_str);
+    cJSON_free(json_str);
+    cJSON_Delete(root);
+    return json;
+}
+
+void LinkStats::Reset() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    quality_ = LinkQuality();
+    session_start_us_ = esp_timer_get_time();
+    last_arrival_us_ = 0;
+    send_block_total_us_ = 0;
+    highest_sequence_ = 0;
+}
+
+void LinkStats::OnRttSample(int rtt_ms) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (quality_.rtt_samples == 0) {
+        quality_.rtt_ms = rtt_ms;
+    } else {
+        quality_.rtt_ms += (rtt_ms - quality_.rtt_ms) / LINK_STATS_SMOOTHING;
+    }
+    if (rtt_ms > quality_.rtt_max_ms) {
+        quality_.rtt_max_ms = rtt_ms;
+    }
+    quality_.rtt_samples++;
+}
+
+void LinkStats::OnPacketSent(int64_t block_us, bool success) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (!success) {
+        quality_.send_failures++;
+        return;
+    }
+    quality_.packets_sent++;
+    send_block_total_us_ += block_us;
+    quality_.send_block_avg_us = send_block_total_us_ / quality_.packets_sent;
+    if (block_us > quality_.send_block_max_us) {
+        quality_.send_block_max_us = block_us;
+    }
+}
+
+void LinkStats::OnPacketReceived(int frame_duration_ms) {
+    int64_t now = esp_timer_get_time();
+    std::lock_guard<std::mutex> lock(mutex_);
+    quality_.packets_received++;
+    if (last_arrival_us_ != 0) {
+        // 到达间隔相对帧长的偏差，超过 1 秒视为新的一段语音，不计入抖动
+        float interval_ms = (now - last_arrival_us_) / 1000.0f;
+        if (interval_ms < 1000) {
+            float deviation = std::fabs(interval_ms - frame_duration_ms);
+            quality_.jitter_ms += (deviation - quality_.jitter_ms) / LINK_STATS_SMOOTHING;
+        }
+    }
+    last_arrival_us_ = now;
+}
+
+void LinkStats::OnSequence(uint32_t sequence) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (highest_sequence_ == 0 || sequence > highest_sequence_) {
+        if (highest_sequence_ != 0 && sequence > highest_sequence_ + 1) {
+            quality_.packets_lost += sequence - highest_sequence_ - 1;
+        }
+        highest_sequence_ = sequence;
+    } else {
+        // 迟到的包先前已被计为丢失
+        quality_.packets_reordered++;
+        if (quality_.packets_lost > 0) {
+            quality_.packets_lost--;
+        }
+    }
+}
+
+LinkQuality LinkStats::GetQuality() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    LinkQuality quality = quality_;
+    if (session_start_us_ != 0) {
+        quality.duration_s = (esp_timer_get_time() - session_start_us_) / 1000000;
+    }
+    return quality;
+}
@@ -0,0 +1,53 @@
+#ifndef LINK_STATS_H
+#define LINK_STATS_H
+
+#include <cstdint>
+#include <mutex>
+#include <string>
+
+enum LinkQualityLevel {
+    kLinkQualityUnknown,
+    kLinkQualityPoor,
+    kLinkQualityFair,
+    kLinkQualityGood,
+};
+
+// 一次会话内的链路质量统计快照
+struct LinkQuality {
+    int rtt_ms = -1;               // 平滑 RTT，-1 表示还没有样本
+    int rtt_max_ms = 0;
+    uint32_t rtt_samples = 0;
+    int send_block_avg_us = 0;     // 上行发送调用的平均阻塞时间
+    int send_block_max_us = 0;
+    uint32_t packets_sent = 0;
+    uint32_t send_failures = 0;
+    uint32_t packets_received = 0;
+    uint32_t packets_lost = 0;     // 仅 UDP 可根据序号统计
+    uint32_t packets_reordered = 0;
+    float jitter_ms = 0;           // 下行到达间隔抖动（RFC 3550 算法）
+    int duration_s = 0;
+
+    float LossRate() const;
+    LinkQualityLevel Level() const;
+    std::string ToJson() const;
+};
+
+class LinkStats {
+public:
+    void Reset();
+    void OnRttSample(int rtt_ms);
+    void OnPacketSent(int64_t block_us, bool success);
+    void OnPacketReceived(int frame_duration_ms);
+    void OnSequence(uint32_t sequence);
+    LinkQuality GetQuality() const;
+
+private:
+    mutable std::mutex mutex_;
+    LinkQuality quality_;
+    int64_t session_start_us_ = 0;
+    int64_t last_arrival_us_ = 0;
+    int64_t send_block_total_us_ = 0;
+    uint32_t highest_sequence_ = 0;
+};
+
+#endif // LINK_STATS_H
@@ -2,8 +2,11 @@
 #include "board.h"
 #include "application.h"
 #include "settings.h"
+#include "connection_race.h"
 
+#include <tcp.h>
 #include <esp_log.h>
+#include <esp_timer.h>
 #include <cstring>
 #include <arpa/inet.h>
 #include "assets/lang_config.h"
@@ -32,7 +35,9 @@ bool MqttProtocol::Start() {
 bool MqttProtocol::StartMqttClient(bool report_error) {
     if (mqtt_ != nullptr) {
         ESP_LOGW(TAG, "Mqtt client already started");
+        ClearMqttCallbacks(mqtt_);
         delete mqtt_;
+        mqtt_ = nullptr;
     }
 
     Settings settings("mqtt", false);
@@ -51,15 +56,66 @@ bool MqttProtocol::StartMqttClient(bool report_error) {
         return false;
     }
 
-    auto network = Board::GetInstance().GetNetwork();
-    mqtt_ = network->CreateMqtt(0);
-    mqtt_->SetKeepAlive(keepalive_interval);
+    ESP_LOGI(TAG, "Connecting to endpoint %s", endpoint.c_str());
+    std::string broker_address;
+    int broker_port = 8883;
+    size_t pos = endpoint.find(':');
+    if (pos != std::string::npos) {
+        broker_address = endpoint.substr(0, pos);
+        broker_port = std::stoi(endpoint.substr(pos + 1));
+    } else {
+        broker_address = endpoint;
+    }
+
+    // 双网络板卡上只对 TCP 可达性竞速，再在胜出的网络上发起一次 MQTT 连接。
+    // 两条链路都用同一个 client_id 发送 CONNECT 时，后到的会被服务器当作会话接管，把先连上的踢下线
+    auto networks = Board::GetInstance().GetNetworks();
+    NetworkInterface* network = networks.empty() ? nullptr : networks[0];
+    if (networks.size() > 1) {
+        auto probe = ConnectionRace<Tcp>::Run(networks, [broker_address, broker_port](NetworkInterface* network) -> Tcp* {
+            auto tcp = network->CreateTcp(0);
+            if (!tcp->Connect(broker_address, broker_port)) {
+                delete tcp;
+                return nullptr;
+            }
+            return tcp;
+        }, nullptr, &network);
+        if (probe == nullptr) {
+            network = nullptr;
+        } else {
+            delete probe;
+        }
+    }
+    if (network == nullptr) {
+        ESP_LOGE(TAG, "Failed to reach endpoint");
+        SetError(Lang::Strings::SERVER_NOT_CONNECTED);
+        return false;
+    }
 
-    mqtt_->OnDisconnected([this]() {
+    // 回调在 Connect 之前注册，连上后、返回前到达的消息不会丢失
+    auto mqtt = network->CreateMqtt(0);
+    mqtt->SetKeepAlive(keepalive_interval);
+    SetupMqttCallbacks(mqtt);
+    if (!mqtt->Connect(broker_address, broker_port, client_id, username, password)) {
+        ESP_LOGE(TAG, "Failed to connect to endpoint");
+        ClearMqttCallbacks(mqtt);
+        delete mqtt;
+        SetError(Lang::Strings::SERVER_NOT_CONNECTED);
+        return false;
+    }
+    mqtt_ = mqtt;
+    network_ = network;
+
+    ESP_LOGI(TAG, "Connected to endpoint");
+    return true;
+}
+
+void MqttProtocol::SetupMqttCallbacks(Mqtt* mqtt) {
+    mqtt->OnDisconnected([this]() {
         ESP_LOGI(TAG, "Disconnected from endpoint");
     });
 
-    mqtt_->OnMessage([this](const std::string& topic, const std::string& payload) {
+    mqtt->OnMessage([this](const std::string& topic, const std::string& payload) {
         cJSON* root = cJSON_Parse(payload.c_str());
         if (root == nullptr) {
             ESP_LOGE(TAG, "Failed to parse json message %s", payload.c_str());
@@ -82,37 +138,29 @@ bool MqttProtocol::StartMqttClient(bool report_error) {
                     CloseAudioChannel();
                 });
             }
+        } else if (HandlePong(root)) {
+            // RTT 已记录
         } else if (on_incoming_json_ != nullptr) {
             on_incoming_json_(root);
         }
         cJSON_Delete(root);
         last_incoming_time_ = std::chrono::steady_clock::now();
     });
+}
 
-    ESP_LOGI(TAG, "Connecting to endpoint %s", endpoint.c_str());
-    std::string broker_address;
-    int broker_port = 8883;
-    size_t pos = endpoint.find(':');
-    if (pos != std::string::npos) {
-        broker_address = endpoint.substr(0, pos);
-        broker_port = std::stoi(endpoint.substr(pos + 1));
-    } else {
-        broker_address = endpoint;
-    }
-    if (!mqtt_->Connect(broker_address, broker_port, client_id, username, password)) {
-        ESP_LOGE(TAG, "Failed to connect to endpoint");
-        SetError(Lang::Strings::SERVER_NOT_CONNECTED);
-        return false;
-    }
-
-    ESP_LOGI(TAG, "Connected to endpoint");
-    return true;
+void MqttProtocol::ClearMqttCallbacks(Mqtt* mqtt) {
+    mqtt->OnDisconnected([]() {});
+    mqtt->OnMessage([](const std::string&, const std::string&) {});
 }
 
 bool MqttProtocol::SendText(const std::string& text) {
     if (publish_topic_.empty()) {
         return false;
     }
+    // 连接或迁移失败后 mqtt_ 为空
+    if (mqtt_ == nullptr || !mqtt_->IsConnected()) {
+        return false;
+    }
     if (!mqtt_->Publish(publish_topic_, text)) {
         ESP_LOGE(TAG, "Failed to publish message: %s", text.c_str());
         SetError(Lang::Strings::SERVER_ERROR);
@@ -127,27 +175,22 @@ bool MqttProtocol::SendAudio(std::unique_ptr<AudioStreamPacket> packet) {
         return false;
     }
 
-    std::string nonce(aes_nonce_);
-    *(uint16_t*)&nonce[2] = htons(packet->payload.size());
-    *(uint32_t*)&nonce[8] = htonl(packet->timestamp);
-    *(uint32_t*)&nonce[12] = htonl(++local_sequence_);
-
     std::string encrypted;
-    encrypted.resize(aes_nonce_.size() + packet->payload.size());
-    memcpy(encrypted.data(), nonce.data(), nonce.size());
-
-    size_t nc_off = 0;
-    uint8_t stream_block[16] = {0};
-    if (mbedtls_aes_crypt_ctr(&aes_ctx_, packet->payload.size(), &nc_off, (uint8_t*)nonce.c_str(), stream_block,
-        (uint8_t*)packet->payload.data(), (uint8_t*)&encrypted[nonce.size()]) != 0) {
+    if (!cipher_.Encrypt(*packet, ++local_sequence_, encrypted)) {
         ESP_LOGE(TAG, "Failed to encrypt audio data");
         return false;
     }
 
-    return udp_->Send(encrypted) > 0;
+    // UDP 发送很少阻塞，阻塞时间主要来自 modem/Wi-Fi 驱动缓冲区占满
+    int64_t start_time = esp_timer_get_time();
+    bool success = udp_->Send(encrypted) > 0;
+    link_stats_.OnPacketSent(esp_timer_get_time() - start_time, success);
+    return success;
 }
 
 void MqttProtocol::CloseAudioChannel() {
+    LogLinkSummary();
+    server_supports_ping_ = false;
     {
         std::lock_guard<std::mutex> lock(channel_mutex_);
         if (udp_ != nullptr) {
@@ -167,6 +210,23 @@ void MqttProtocol::CloseAudioChannel() {
     }
 }
 
+bool MqttProtocol::MigrateAudioChannel() {
+    // MQTT 连接也绑定在旧网络上，一并重建；不发送 goodbye，也不触发 on_audio_channel_closed_
+    {
+        std::lock_guard<std::mutex> lock(channel_mutex_);
+        if (udp_ != nullptr) {
+            delete udp_;
+            udp_ = nullptr;
+        }
+    }
+    if (mqtt_ != nullptr) {
+        ClearMqttCallbacks(mqtt_);
+        delete mqtt_;
+        mqtt_ = nullptr;
+    }
+    return OpenAudioChannel();
+}
+
 bool MqttProtocol::OpenAudioChannel() {
     if (mqtt_ == nullptr || !mqtt_->IsConnected()) {
         ESP_LOGI(TAG, "MQTT is not connected, try to connect now");
@@ -179,6 +239,7 @@ bool MqttProtocol::OpenAudioChannel() {
     session_id_ = "";
     xEventGroupClearBits(event_group_handle_, MQTT_PROTOCOL_SERVER_HELLO_EVENT);
 
+    BeginLinkSession();
     auto message = GetHelloMessage();
     if (!SendText(message)) {
         return false;
@@ -197,15 +258,15 @@ bool MqttProtocol::OpenAudioChannel() {
         delete udp_;
     }
 
-    auto network = Board::GetInstance().GetNetwork();
-    udp_ = network->CreateUdp(2);
+    // UDP 音频通道与 MQTT 控制通道走同一个网络
+    udp_ = network_->CreateUdp(2);
     udp_->OnMessage([this](const std::string& data) {
         /*
          * UDP Encrypted OPUS Packet Format:
          * |type 1u|flags 1u|payload_len 2u|ssrc 4u|timestamp 4u|sequence 4u|
          * |payload payload_len|
          */
-        if (data.size() < sizeof(aes_nonce_)) {
+        if (data.size() < UDP_AUDIO_NONCE_SIZE) {
             ESP_LOGE(TAG, "Invalid audio packet size: %u", data.size());
             return;
         }
@@ -215,6 +276,7 @@ bool MqttProtocol::OpenAudioChannel() {
         }
         uint32_t timestamp = ntohl(*(uint32_t*)&data[8]);
         uint32_t sequence = ntohl(*(uint32_t*)&data[12]);
+        link_stats_.OnSequence(sequence);
         if (sequence < remote_sequence_) {
             ESP_LOGW(TAG, "Received audio packet with old sequence: %lu, expected: %lu", sequence, remote_sequence_);
             return;
@@ -223,21 +285,15 @@ bool MqttProtocol::OpenAudioChannel() {
             ESP_LOGW(TAG, "Received audio packet with wrong sequence: %lu, expected: %lu", sequence, remote_sequence_ + 1);
         }
 
-        size_t decrypted_size = data.size() - aes_nonce_.size();
-        size_t nc_off = 0;
-        uint8_t stream_block[16] = {0};
-        auto nonce = (uint8_t*)data.data();
-        auto encrypted = (uint8_t*)data.data() + aes_nonce_.size();
         auto packet = std::make_unique<AudioStreamPacket>();
         packet->sample_rate = server_sample_rate_;
         packet->frame_duration = server_frame_duration_;
         packet->timestamp = timestamp;
-        packet->payload.resize(decrypted_size);
-        int ret = mbedtls_aes_crypt_ctr(&aes_ctx_, decrypted_size, &nc_off, nonce, stream_block, encrypted, (uint8_t*)packet->payload.data());
-        if (ret != 0) {
-            ESP_LOGE(TAG, "Failed to decrypt audio data, ret: %d", ret);
+        if (!cipher_.Decrypt(data, packet->payload)) {
+            ESP_LOGE(TAG, "Failed to decrypt audio data");
             return;
         }
+        link_stats_.OnPacketReceived(server_frame_duration_);
         if (on_incoming_audio_ != nullptr) {
             on_incoming_audio_(std::move(packet));
         }
@@ -264,12 +320,17 @@ std::string MqttProtocol::GetHelloMessage() {
     cJSON_AddBoolToObject(features, "aec", true);
 #endif
     cJSON_AddBoolToObject(features, "mcp", true);
+    cJSON_AddBoolToObject(features, "ping", true);
+    if (tts_cache_enabled_) {
+        cJSON_AddBoolToObject(features, "tts_cache", true);
+    }
     cJSON_AddItemToObject(root, "features", features);
     cJSON* audio_params = cJSON_CreateObject();
     cJSON_AddStringToObject(audio_params, "format", "opus");
     cJSON_AddNumberToObject(audio_params, "sample_rate", 16000);
     cJSON_AddNumberToObject(audio_params, "channels", 1);
     cJSON_AddNumberToObject(audio_params, "frame_duration", OPUS_FRAME_DURATION_MS);
+    AddDownlinkAudioParams(audio_params);
     cJSON_AddItemToObject(root, "audio_params", audio_params);
     auto json_str = cJSON_PrintUnformatted(root);
     std::string message(json_str);
@@ -291,18 +352,10 @@ void MqttProtocol::ParseServerHello(const cJSON* root) {
         ESP_LOGI(TAG, "Session ID: %s", session_id_.c_str());
     }
 
+    ParseServerFeatures(root);
+
     // Get sample rate from hello message
-    auto audio_params = cJSON_GetObjectItem(root, "audio_params");
-    if (cJSON_IsObject(audio_params)) {
-        auto sample_rate = cJSON_GetObjectItem(audio_params, "sample_rate");
-        if (cJSON_IsNumber(sample_rate)) {
-            server_sample_rate_ = sample_rate->valueint;
-        }
-        auto frame_duration = cJSON_GetObjectItem(audio_params, "frame_duration");
-        if (cJSON_IsNumber(frame_duration)) {
-            server_frame_duration_ = frame_duration->valueint;
-        }
-    }
+    ParseServerAudioParams(root);
 
     auto udp = cJSON_GetObjectItem(root, "udp");
     if (!cJSON_IsObject(udp)) {
@@ -316,9 +369,10 @@ void MqttProtocol::ParseServerHello(const cJSON* root) {
 
     // auto encryption = cJSON_GetObjectItem(udp, "encryption")->valuestring;
     // ESP_LOGI(TAG, "UDP server: %s, port: %d, encryption: %s", udp_server_.c_str(), udp_port_, encryption);
-    aes_nonce_ = DecodeHexString(nonce);
-    mbedtls_aes_init(&aes_ctx_);
-    mbedtls_aes_setkey_enc(&aes_ctx_, (const unsigned char*)DecodeHexString(key).c_str(), 128);
+    if (!cipher_.SetKey(DecodeHexString(key), DecodeHexString(nonce))) {
+        ESP_LOGE(TAG, "Invalid UDP key or nonce");
+        return;
+    }
     local_sequence_ = 0;
     remote_sequence_ = 0;
     xEventGroupSetBits(event_group_handle_, MQTT_PROTOCOL_SERVER_HELLO_EVENT);
@@ -3,10 +3,10 @@
 
 
 #include "protocol.h"
+#include "udp_audio_cipher.h"
 #include <mqtt.h>
 #include <udp.h>
 #include <cJSON.h>
-#include <mbedtls/aes.h>
 #include <freertos/FreeRTOS.h>
 #include <freertos/event_groups.h>
 
@@ -30,6 +30,7 @@ public:
     bool OpenAudioChannel() override;
     void CloseAudioChannel() override;
     bool IsAudioChannelOpened() const override;
+    bool MigrateAudioChannel() override;
 
 private:
     EventGroupHandle_t event_group_handle_;
@@ -39,8 +40,7 @@ private:
     std::mutex channel_mutex_;
     Mqtt* mqtt_ = nullptr;
     Udp* udp_ = nullptr;
-    mbedtls_aes_context aes_ctx_;
-    std::string aes_nonce_;
+    UdpAudioCipher cipher_;
     std::string udp_server_;
     int udp_port_;
     uint32_t local_sequence_;
@@ -48,6 +48,8 @@ private:
 
     bool StartMqttClient(bool report_error=false);
     void ParseServerHello(const cJSON* root);
+    void SetupMqttCallbacks(Mqtt* mqtt);
+    static void ClearMqttCallbacks(Mqtt* mqtt);
     std::string DecodeHexString(const std::string& hex_string);
 
     bool SendText(const std::string& text) override;
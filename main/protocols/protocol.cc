@@ -1,6 +1,8 @@
 #include "protocol.h"
 
 #include <esp_log.h>
+#include <esp_timer.h>
+#include <cstring>
 
 #define TAG "Protocol"
 
@@ -102,12 +104,176 @@ void Protocol::SendMcpMessage(const std::string &payload)
     SendText(message);
 }
 
+void Protocol::SendPing()
+{
+    // 旧服务器不认识 ping 消息，只有在 hello 中声明支持时才发送
+    if (!server_supports_ping_ || session_id_.empty())
+    {
+        return;
+    }
+    ping_sent_time_us_ = esp_timer_get_time();
+    std::string message = "{\"session_id\":\"" + session_id_ + "\",\"type\":\"ping\",\"id\":" + std::to_string(++ping_id_) + "}";
+    SendText(message);
+}
+
+void Protocol::SendTtsCacheHit(const std::string &hash)
+{
+    // 设备已缓存该句音频，服务器收到后跳过该句的下发
+    std::string message = "{\"session_id\":\"" + session_id_ + "\",\"type\":\"tts\",\"state\":\"cache_hit\",\"hash\":\"" + hash + "\"}";
+    SendText(message);
+}
+
+void Protocol::BeginLinkSession()
+{
+    link_stats_.Reset();
+    server_supports_ping_ = false;
+    ping_sent_time_us_ = 0;
+    hello_sent_time_us_ = esp_timer_get_time();
+}
+
+void Protocol::ParseServerFeatures(const cJSON *root)
+{
+    // hello 往返作为第一个 RTT 样本
+    if (hello_sent_time_us_ != 0)
+    {
+        link_stats_.OnRttSample((esp_timer_get_time() - hello_sent_time_us_) / 1000);
+        hello_sent_time_us_ = 0;
+    }
+    auto features = cJSON_GetObjectItem(root, "features");
+    if (cJSON_IsObject(features))
+    {
+        server_supports_ping_ = cJSON_IsTrue(cJSON_GetObjectItem(features, "ping"));
+    }
+}
+
+static bool IsOpusSampleRate(int sample_rate)
+{
+    return sample_rate == 8000 || sample_rate == 12000 || sample_rate == 16000 || sample_rate == 24000 || sample_rate == 48000;
+}
+
+static bool IsOpusFrameDuration(int frame_duration)
+{
+    return frame_duration == 10 || frame_duration == 20 || frame_duration == 40 || frame_duration == 60 || frame_duration == 80 || frame_duration == 100 ||
+           frame_duration == 120;
+}
+
+void Protocol::SetPreferredDownlinkFormat(int sample_rate, int frame_duration)
+{
+    // Opus 只支持固定的几种采样率，其他输出采样率无论如何都要重采样，不声明偏好，沿用服务器默认值
+    if (!IsOpusSampleRate(sample_rate) || !IsOpusFrameDuration(frame_duration))
+    {
+        ESP_LOGW(TAG, "Output format %d Hz / %d ms is not supported by Opus, using server default", sample_rate, frame_duration);
+        return;
+    }
+    preferred_downlink_sample_rate_ = sample_rate;
+    preferred_downlink_frame_duration_ = frame_duration;
+}
+
+void Protocol::AddDownlinkAudioParams(cJSON *audio_params) const
+{
+    // 上行参数保持不变，单独声明期望的下行参数，旧服务器会忽略该字段
+    if (preferred_downlink_sample_rate_ == 0)
+    {
+        return;
+    }
+    cJSON *downlink = cJSON_CreateObject();
+    cJSON_AddNumberToObject(downlink, "sample_rate", preferred_downlink_sample_rate_);
+    cJSON_AddNumberToObject(downlink, "frame_duration", preferred_downlink_frame_duration_);
+    cJSON_AddItemToObject(audio_params, "downlink", downlink);
+}
+
+void Protocol::ParseServerAudioParams(const cJSON *root)
+{
+    // 服务器 hello 中的 audio_params 即服务器最终选择的下行参数
+    auto audio_params = cJSON_GetObjectItem(root, "audio_params");
+    if (!cJSON_IsObject(audio_params))
+    {
+        return;
+    }
+    auto sample_rate = cJSON_GetObjectItem(audio_params, "sample_rate");
+    if (cJSON_IsNumber(sample_rate))
+    {
+        if (IsOpusSampleRate(sample_rate->valueint))
+        {
+            server_sample_rate_ = sample_rate->valueint;
+        }
+        else
+        {
+            ESP_LOGW(TAG, "Ignoring invalid server sample rate %d", sample_rate->valueint);
+        }
+    }
+    auto frame_duration = cJSON_GetObjectItem(audio_params, "frame_duration");
+    if (cJSON_IsNumber(frame_duration))
+    {
+        if (IsOpusFrameDuration(frame_duration->valueint))
+        {
+            server_frame_duration_ = frame_duration->valueint;
+        }
+        else
+        {
+            ESP_LOGW(TAG, "Ignoring invalid server frame duration %d", frame_duration->valueint);
+        }
+    }
+    ESP_LOGI(TAG, "Downlink audio: %d Hz / %d ms", server_sample_rate_, server_frame_duration_);
+}
+
+bool Protocol::HandlePong(const cJSON *root)
+{
+    auto type = cJSON_GetObjectItem(root, "type");
+    if (!cJSON_IsString(type) || strcmp(type->valuestring, "pong") != 0)
+    {
+        return false;
+    }
+    // 只接受最近一次 ping 的应答，迟到的 pong 不计入 RTT
+    auto id = cJSON_GetObjectItem(root, "id");
+    if (ping_sent_time_us_ != 0 && cJSON_IsNumber(id) && (uint32_t)id->valuedouble == ping_id_)
+    {
+        link_stats_.OnRttSample((esp_timer_get_time() - ping_sent_time_us_) / 1000);
+        ping_sent_time_us_ = 0;
+    }
+    return true;
+}
+
+void Protocol::LogLinkSummary()
+{
+    auto quality = link_stats_.GetQuality();
+    if (quality.duration_s == 0 && quality.packets_sent == 0 && quality.packets_received == 0)
+    {
+        return;
+    }
+    ESP_LOGI(TAG, "Session %s link summary: %s", session_id_.c_str(), quality.ToJson().c_str());
+}
+
+bool Protocol::MigrateAudioChannel()
+{
+    // 默认实现：在新的首选网络上重新建立音频通道
+    CloseAudioChannel();
+    return OpenAudioChannel();
+}
+
+int Protocol::GetSilentTimeMs() const
+{
+    auto now = std::chrono::steady_clock::now();
+    return std::chrono::duration_cast<std::chrono::milliseconds>(now - last_incoming_time_).count();
+}
+
+bool Protocol::IsPeerDead() const
+{
+    // 服务器每次都会应答心跳，超过心跳超时没有任何下行数据即可判定连接已死，
+    // 不必等待 TCP 重传超时或 120 秒的会话超时
+    if (!server_supports_ping_)
+    {
+        return false;
+    }
+    return GetSilentTimeMs() > CONFIG_HEARTBEAT_TIMEOUT_SECONDS * 1000;
+}
+
 bool Protocol::IsTimeout() const
 {
     const int kTimeoutSeconds = 120;
     auto now = std::chrono::steady_clock::now();
     auto duration = std::chrono::duration_cast<std::chrono::seconds>(now - last_incoming_time_);
-    bool timeout = duration.count() > kTimeoutSeconds;
+    bool timeout = duration.count() > kTimeoutSeconds || IsPeerDead();
     if (timeout)
     {
         ESP_LOGE(TAG, "Channel timeout %ld seconds", (long)duration.count());
@@ -119,7 +285,8 @@ bool Protocol::IsTimeout(bool check_timeout) const
 {
     if (!check_timeout)
     {
-        return false; // 在待命状态下不进行超时检查
+        // 在待命状态下不进行会话超时检查，但心跳仍然可以发现死连接
+        return IsPeerDead();
     }
     return IsTimeout();
 }
@@ -1,38 +1,16 @@
 #ifndef PROTOCOL_H
 #define PROTOCOL_H
 
+#include "audio_packet.h"
 #include "device_state.h"
+#include "link_stats.h"
 #include <cJSON.h>
 #include <chrono>
 #include <functional>
 #include <string>
 #include <vector>
 
-struct AudioStreamPacket
-{
-    int sample_rate = 0;
-    int frame_duration = 0;
-    uint32_t timestamp = 0;
-    std::vector<uint8_t> payload;
-};
-
-struct BinaryProtocol2
-{
-    uint16_t version;
-    uint16_t type;         // Message type (0: OPUS, 1: JSON)
-    uint32_t reserved;     // Reserved for future use
-    uint32_t timestamp;    // Timestamp in milliseconds (used for server-side AEC)
-    uint32_t payload_size; // Payload size in bytes
-    uint8_t payload[];     // Payload data
-} __attribute__((packed));
-
-struct BinaryProtocol3
-{
-    uint8_t type;
-    uint8_t reserved;
-    uint16_t payload_size;
-    uint8_t payload[];
-} __attribute__((packed));
+class NetworkInterface;
 
 enum AbortReason
 {
@@ -55,6 +33,7 @@ public:
     inline int server_sample_rate() const { return server_sample_rate_; }
     inline int server_frame_duration() const { return server_frame_duration_; }
     inline const std::string &session_id() const { return session_id_; }
+    inline LinkQuality GetLinkQuality() const { return link_stats_.GetQuality(); }
 
     void OnIncomingAudio(std::function<void(std::unique_ptr<AudioStreamPacket> packet)> callback);
     void OnIncomingJson(std::function<void(const cJSON *root)> callback);
@@ -66,12 +45,19 @@ public:
     virtual bool OpenAudioChannel() = 0;
     virtual void CloseAudioChannel() = 0;
     virtual bool IsAudioChannelOpened() const = 0;
+    virtual bool MigrateAudioChannel();
     virtual bool SendAudio(std::unique_ptr<AudioStreamPacket> packet) = 0;
     virtual void SendWakeWordDetected(const std::string &wake_word, const std::string &user_info = "");
     virtual void SendStartListening(ListeningMode mode);
     virtual void SendStopListening();
     virtual void SendAbortSpeaking(AbortReason reason);
     virtual void SendMcpMessage(const std::string &message);
+    virtual void SendPing();
+    virtual void SendTtsCacheHit(const std::string &hash);
+    void EnableTtsCache(bool enable) { tts_cache_enabled_ = enable; }
+    void SetPreferredDownlinkFormat(int sample_rate, int frame_duration);
+    bool IsPeerDead() const;
+    int GetSilentTimeMs() const;
     virtual void SetDeviceState(DeviceState state) {} // 默认实现为空，子类可以重写
 
 protected:
@@ -85,12 +71,27 @@ protected:
     int server_frame_duration_ = 60;
     bool error_occurred_ = false;
     std::string session_id_;
+    NetworkInterface *network_ = nullptr; // 当前连接所在的网络接口（连接竞速的胜者）
     std::chrono::time_point<std::chrono::steady_clock> last_incoming_time_;
+    LinkStats link_stats_;                // 当前会话的链路质量统计
+    bool server_supports_ping_ = false;   // 服务器 hello 中声明了 features.ping
+    int64_t hello_sent_time_us_ = 0;
+    int64_t ping_sent_time_us_ = 0;
+    uint32_t ping_id_ = 0;
+    bool tts_cache_enabled_ = false;      // 在 hello 中声明支持 TTS 缓存
+    int preferred_downlink_sample_rate_ = 0;  // 设备希望的下行采样率，0 表示不声明
+    int preferred_downlink_frame_duration_ = 0;
 
     virtual bool SendText(const std::string &text) = 0;
     virtual void SetError(const std::string &message);
     virtual bool IsTimeout() const;
     virtual bool IsTimeout(bool check_timeout) const;
+    void BeginLinkSession();
+    void ParseServerFeatures(const cJSON *root);
+    void AddDownlinkAudioParams(cJSON *audio_params) const;
+    void ParseServerAudioParams(const cJSON *root);
+    bool HandlePong(const cJSON *root);
+    void LogLinkSummary();
 };
 
 #endif // PROTOCOL_H
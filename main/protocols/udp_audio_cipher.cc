@@ -0,0 +1,59 @@
+#include "udp_audio_cipher.h"
+
+#include <arpa/inet.h>
+#include <cstring>
+
+UdpAudioCipher::UdpAudioCipher() {
+    mbedtls_aes_init(&aes_ctx_);
+}
+
+UdpAudioCipher::~UdpAudioCipher() {
+    mbedtls_aes_free(&aes_ctx_);
+}
+
+bool UdpAudioCipher::SetKey(const std::string& key, const std::string& nonce) {
+    if (nonce.size() != UDP_AUDIO_NONCE_SIZE || key.size() * 8 < 128) {
+        return false;
+    }
+    nonce_ = nonce;
+    return mbedtls_aes_setkey_enc(&aes_ctx_, (const unsigned char*)key.data(), 128) == 0;
+}
+
+bool UdpAudioCipher::Encrypt(const AudioStreamPacket& packet, uint32_t sequence, std::string& output) {
+    if (nonce_.size() != UDP_AUDIO_NONCE_SIZE) {
+        return false;
+    }
+
+    output.resize(UDP_AUDIO_NONCE_SIZE + packet.payload.size());
+    auto nonce = (uint8_t*)output.data();
+    memcpy(nonce, nonce_.data(), UDP_AUDIO_NONCE_SIZE);
+    uint16_t payload_size = htons(packet.payload.size());
+    uint32_t timestamp = htonl(packet.timestamp);
+    sequence = htonl(sequence);
+    memcpy(nonce + 2, &payload_size, sizeof(payload_size));
+    memcpy(nonce + 8, &timestamp, sizeof(timestamp));
+    memcpy(nonce + 12, &sequence, sizeof(sequence));
+
+    // CTR 会更新计数器，使用副本，保留输出中的 nonce
+    uint8_t counter[UDP_AUDIO_NONCE_SIZE];
+    memcpy(counter, nonce, UDP_AUDIO_NONCE_SIZE);
+    size_t nc_off = 0;
+    uint8_t stream_block[16] = {0};
+    return mbedtls_aes_crypt_ctr(&aes_ctx_, packet.payload.size(), &nc_off, counter, stream_block,
+        packet.payload.data(), nonce + UDP_AUDIO_NONCE_SIZE) == 0;
+}
+
+bool UdpAudioCipher::Decrypt(const std::string& data, std::vector<uint8_t>& payload) {
+    if (data.size() < UDP_AUDIO_NONCE_SIZE) {
+        return false;
+    }
+
+    uint8_t counter[UDP_AUDIO_NONCE_SIZE];
+    memcpy(counter, data.data(), UDP_AUDIO_NONCE_SIZE);
+    size_t encrypted_size = data.size() - UDP_AUDIO_NONCE_SIZE;
+    payload.resize(encrypted_size);
+    size_t nc_off = 0;
+    uint8_t stream_block[16] = {0};
+    return mbedtls_aes_crypt_ctr(&aes_ctx_, encrypted_size, &nc_off, counter, stream_block,
+        (const uint8_t*)data.data() + UDP_AUDIO_NONCE_SIZE, payload.data()) == 0;
+}
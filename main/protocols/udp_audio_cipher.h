@@ -0,0 +1,36 @@
+#ifndef UDP_AUDIO_CIPHER_H
+#define UDP_AUDIO_CIPHER_H
+
+#include "audio_packet.h"
+#include <mbedtls/aes.h>
+
+#include <string>
+#include <vector>
+
+#define UDP_AUDIO_NONCE_SIZE 16
+
+/*
+ * MQTT 协议 UDP 音频通道的 AES-128-CTR 加解密。
+ * 数据包格式：|type 1u|flags 1u|payload_len 2u|ssrc 4u|timestamp 4u|sequence 4u|payload payload_len|
+ * 其中前 16 字节同时作为 CTR 的 nonce。只依赖 mbedtls，可以在主机上编译做基准测试
+ */
+class UdpAudioCipher {
+public:
+    UdpAudioCipher();
+    ~UdpAudioCipher();
+    UdpAudioCipher(const UdpAudioCipher&) = delete;
+    UdpAudioCipher& operator=(const UdpAudioCipher&) = delete;
+
+    // key 和 nonce 为服务器 hello 消息中十六进制字符串解码后的字节
+    bool SetKey(const std::string& key, const std::string& nonce);
+    // 填入长度、时间戳和序号后输出 nonce + 密文，output 的容量可以复用
+    bool Encrypt(const AudioStreamPacket& packet, uint32_t sequence, std::string& output);
+    // data 为 nonce + 密文，明文写入 payload
+    bool Decrypt(const std::string& data, std::vector<uint8_t>& payload);
+
+private:
+    mbedtls_aes_context aes_ctx_;
+    std::string nonce_;
+};
+
+#endif // UDP_AUDIO_CIPHER_H
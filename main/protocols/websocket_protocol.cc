@@ -1,15 +1,17 @@
 #include "websocket_protocol.h"
 #include "application.h"
 #include "board.h"
+#include "connection_race.h"
 #include "settings.h"
 #include "system_info.h"
 #include "user_manager.h"
 
 #include "assets/lang_config.h"
-#include <arpa/inet.h>
 #include <cJSON.h>
 #include <cstring>
 #include <esp_log.h>
+#include <esp_timer.h>
+#include <map>
 
 #define TAG "WS"
 
@@ -37,36 +39,15 @@ bool WebsocketProtocol::SendAudio(std::unique_ptr<AudioStreamPacket> packet)
         return false;
     }
 
-    if (version_ == 2)
-    {
-        std::string serialized;
-        serialized.resize(sizeof(BinaryProtocol2) + packet->payload.size());
-        auto bp2 = (BinaryProtocol2 *)serialized.data();
-        bp2->version = htons(version_);
-        bp2->type = 0;
-        bp2->reserved = 0;
-        bp2->timestamp = htonl(packet->timestamp);
-        bp2->payload_size = htonl(packet->payload.size());
-        memcpy(bp2->payload, packet->payload.data(), packet->payload.size());
-
-        return websocket_->Send(serialized.data(), serialized.size(), true);
-    }
-    else if (version_ == 3)
-    {
-        std::string serialized;
-        serialized.resize(sizeof(BinaryProtocol3) + packet->payload.size());
-        auto bp3 = (BinaryProtocol3 *)serialized.data();
-        bp3->type = 0;
-        bp3->reserved = 0;
-        bp3->payload_size = htons(packet->payload.size());
-        memcpy(bp3->payload, packet->payload.data(), packet->payload.size());
-
-        return websocket_->Send(serialized.data(), serialized.size(), true);
-    }
-    else
-    {
-        return websocket_->Send(packet->payload.data(), packet->payload.size(), true);
-    }
+    // 版本 1 直接发送 payload，只有带帧头的版本才需要拼接缓冲区
+    std::string buffer;
+    auto serialized = SerializeAudioPacket(version_, *packet, buffer);
+
+    // 发送调用的阻塞时间反映了 TCP 发送窗口的拥塞程度
+    int64_t start_time = esp_timer_get_time();
+    bool success = websocket_->Send(serialized.data(), serialized.size(), true);
+    link_stats_.OnPacketSent(esp_timer_get_time() - start_time, success);
+    return success;
 }
 
 bool WebsocketProtocol::SendText(const std::string &text)
@@ -95,6 +76,8 @@ bool WebsocketProtocol::IsAudioChannelOpened() const
 
 void WebsocketProtocol::CloseAudioChannel()
 {
+    LogLinkSummary();
+    server_supports_ping_ = false;
     if (websocket_ != nullptr)
     {
         delete websocket_;
@@ -102,6 +85,85 @@ void WebsocketProtocol::CloseAudioChannel()
     }
 }
 
+bool WebsocketProtocol::MigrateAudioChannel()
+{
+    // 丢弃旧连接时不触发 on_audio_channel_closed_，否则会结束当前对话。
+    // 旧连接的断开事件可能在关闭后异步到达，靠代数区分而不是临时标志
+    connection_generation_ = ++last_generation_;
+    CloseAudioChannel();
+    return OpenAudioChannel();
+}
+
+void WebsocketProtocol::SetupWebsocketCallbacks(WebSocket *websocket, uint32_t generation)
+{
+    websocket->OnData(
+        [this, generation](const char *data, size_t len, bool binary)
+        {
+            if (generation != connection_generation_)
+            {
+                return;
+            }
+            if (binary)
+            {
+                link_stats_.OnPacketReceived(server_frame_duration_);
+                if (on_incoming_audio_ != nullptr)
+                {
+                    auto packet = ParseAudioPacket(version_, data, len, server_sample_rate_, server_frame_duration_);
+                    if (packet == nullptr)
+                    {
+                        ESP_LOGW(TAG, "Invalid binary audio packet, version: %d, length: %u", version_, len);
+                    }
+                    else
+                    {
+                        on_incoming_audio_(std::move(packet));
+                    }
+                }
+            }
+            else
+            {
+                // Parse JSON data
+                auto root = cJSON_Parse(data);
+                auto type = cJSON_GetObjectItem(root, "type");
+                if (cJSON_IsString(type))
+                {
+                    if (strcmp(type->valuestring, "hello") == 0)
+                    {
+                        ParseServerHello(root);
+                    }
+                    else if (!HandlePong(root))
+                    {
+                        if (on_incoming_json_ != nullptr)
+                        {
+                            on_incoming_json_(root);
+                        }
+                    }
+                }
+                else
+                {
+                    ESP_LOGE(TAG, "Missing message type, data: %s", data);
+                }
+                cJSON_Delete(root);
+            }
+            last_incoming_time_ = std::chrono::steady_clock::now();
+        });
+
+    websocket->OnDisconnected(
+        [this, generation]()
+        {
+            if (generation != connection_generation_)
+            {
+                ESP_LOGI(TAG, "Stale websocket disconnected, ignored");
+                return;
+            }
+            ESP_LOGI(TAG, "Websocket disconnected");
+            server_supports_ping_ = false;
+            if (on_audio_channel_closed_ != nullptr)
+            {
+                on_audio_channel_closed_();
+            }
+        });
+}
+
 void WebsocketProtocol::SetDeviceState(DeviceState state)
 {
     device_state_ = state;
@@ -126,9 +188,6 @@ bool WebsocketProtocol::OpenAudioChannel()
 
     error_occurred_ = false;
 
-    auto network = Board::GetInstance().GetNetwork();
-    websocket_ = network->CreateWebSocket(1);
-
     if (!token.empty())
     {
         // If token not has a space, add "Bearer " prefix
@@ -136,37 +195,42 @@ bool WebsocketProtocol::OpenAudioChannel()
         {
             token = "Bearer " + token;
         }
-        websocket_->SetHeader("Authorization", token.c_str());
     }
-    websocket_->SetHeader("Protocol-Version", std::to_string(version_).c_str());
-    websocket_->SetHeader("Device-Id", SystemInfo::GetMacAddress().c_str());
-    websocket_->SetHeader("Client-Id", Board::GetInstance().GetUuid().c_str());
 
     // 获取UserManager实例并添加用户认证信息到请求头
     auto &app = Application::GetInstance();
     auto &user_manager = app.GetUserManager();
 
+    std::vector<std::pair<std::string, std::string>> headers;
+    if (!token.empty())
+    {
+        headers.emplace_back("Authorization", token);
+    }
+    headers.emplace_back("Protocol-Version", std::to_string(version_));
+    headers.emplace_back("Device-Id", SystemInfo::GetMacAddress());
+    headers.emplace_back("Client-Id", Board::GetInstance().GetUuid());
+
     if (user_manager.IsLoggedIn())
     {
         // 添加API ID和API Key到请求头
         if (!user_manager.GetApiId().empty())
         {
             // 外发握手头使用 secret_id，但设备内部仍使用 Api-Id 存储
-            websocket_->SetHeader("secret_id", user_manager.GetApiId().c_str());
+            headers.emplace_back("secret_id", user_manager.GetApiId());
         }
         if (!user_manager.GetApiKey().empty())
         {
             // 外发握手头使用 secret_key，但设备内部仍使用 Api-Key 存储
-            websocket_->SetHeader("secret_key", user_manager.GetApiKey().c_str());
+            headers.emplace_back("secret_key", user_manager.GetApiKey());
         }
         // 可选：添加用户名和账户信息
         if (!user_manager.GetName().empty())
         {
-            websocket_->SetHeader("User-Name", user_manager.GetName().c_str());
+            headers.emplace_back("User-Name", user_manager.GetName());
         }
         if (!user_manager.GetAccount().empty())
         {
-            websocket_->SetHeader("User-Account", user_manager.GetAccount().c_str());
+            headers.emplace_back("User-Account", user_manager.GetAccount());
         }
         ESP_LOGI(TAG, "Added user authentication headers: secret_id=%s, user=%s", user_manager.GetApiId().c_str(), user_manager.GetName().c_str());
     }
@@ -206,84 +270,53 @@ bool WebsocketProtocol::OpenAudioChannel()
     }
     ESP_LOGI(TAG, "==========================================");
 
-    websocket_->OnData(
-        [this](const char *data, size_t len, bool binary)
+    ESP_LOGI(TAG, "Connecting to websocket server: %s with version: %d", url.c_str(), version_);
+    // 双网络板卡上在所有可用网络上竞速连接，单网络时等同于直接连接。
+    // 回调在 Connect 之前注册；客户端 hello 在选出胜者后才发送，此前到达的事件可以安全忽略
+    // 每个网络上的尝试各用一个代数，竞速期间当前代数不属于任何尝试，
+    // 落败连接在清除回调前断开也不会触发 on_audio_channel_closed_；胜出后才切换为胜者的代数
+    auto networks = Board::GetInstance().GetNetworks();
+    connection_generation_ = ++last_generation_;
+    std::map<NetworkInterface *, uint32_t> generations;
+    for (auto network : networks)
+    {
+        generations[network] = ++last_generation_;
+    }
+    auto discard = [](WebSocket *websocket)
+    {
+        websocket->OnData([](const char *, size_t, bool) {});
+        websocket->OnDisconnected([]() {});
+    };
+    websocket_ = ConnectionRace<WebSocket>::Run(
+        networks,
+        [this, url, headers, generations, discard](NetworkInterface *network) -> WebSocket *
         {
-            if (binary)
-            {
-                if (on_incoming_audio_ != nullptr)
-                {
-                    if (version_ == 2)
-                    {
-                        BinaryProtocol2 *bp2 = (BinaryProtocol2 *)data;
-                        bp2->version = ntohs(bp2->version);
-                        bp2->type = ntohs(bp2->type);
-                        bp2->timestamp = ntohl(bp2->timestamp);
-                        bp2->payload_size = ntohl(bp2->payload_size);
-                        auto payload = (uint8_t *)bp2->payload;
-                        on_incoming_audio_(std::make_unique<AudioStreamPacket>(AudioStreamPacket{.sample_rate = server_sample_rate_, .frame_duration = server_frame_duration_, .timestamp = bp2->timestamp, .payload = std::vector<uint8_t>(payload, payload + bp2->payload_size)}));
-                    }
-                    else if (version_ == 3)
-                    {
-                        BinaryProtocol3 *bp3 = (BinaryProtocol3 *)data;
-                        bp3->type = bp3->type;
-                        bp3->payload_size = ntohs(bp3->payload_size);
-                        auto payload = (uint8_t *)bp3->payload;
-                        on_incoming_audio_(std::make_unique<AudioStreamPacket>(AudioStreamPacket{.sample_rate = server_sample_rate_, .frame_duration = server_frame_duration_, .timestamp = 0, .payload = std::vector<uint8_t>(payload, payload + bp3->payload_size)}));
-                    }
-                    else
-                    {
-                        on_incoming_audio_(std::make_unique<AudioStreamPacket>(AudioStreamPacket{.sample_rate = server_sample_rate_, .frame_duration = server_frame_duration_, .timestamp = 0, .payload = std::vector<uint8_t>((uint8_t *)data, (uint8_t *)data + len)}));
-                    }
-                }
-            }
-            else
+            uint32_t generation = generations.at(network);
+            auto websocket = network->CreateWebSocket(1);
+            for (auto &header : headers)
             {
-                // Parse JSON data
-                auto root = cJSON_Parse(data);
-                auto type = cJSON_GetObjectItem(root, "type");
-                if (cJSON_IsString(type))
-                {
-                    if (strcmp(type->valuestring, "hello") == 0)
-                    {
-                        ParseServerHello(root);
-                    }
-                    else
-                    {
-                        if (on_incoming_json_ != nullptr)
-                        {
-                            on_incoming_json_(root);
-                        }
-                    }
-                }
-                else
-                {
-                    ESP_LOGE(TAG, "Missing message type, data: %s", data);
-                }
-                cJSON_Delete(root);
+                websocket->SetHeader(header.first.c_str(), header.second.c_str());
             }
-            last_incoming_time_ = std::chrono::steady_clock::now();
-        });
-
-    websocket_->OnDisconnected(
-        [this]()
-        {
-            ESP_LOGI(TAG, "Websocket disconnected");
-            if (on_audio_channel_closed_ != nullptr)
+            SetupWebsocketCallbacks(websocket, generation);
+            if (!websocket->Connect(url.c_str()))
             {
-                on_audio_channel_closed_();
+                discard(websocket);
+                delete websocket;
+                return nullptr;
             }
-        });
-
-    ESP_LOGI(TAG, "Connecting to websocket server: %s with version: %d", url.c_str(), version_);
-    if (!websocket_->Connect(url.c_str()))
+            return websocket;
+        },
+        discard, &network_);
+    if (websocket_ == nullptr)
     {
         ESP_LOGE(TAG, "Failed to connect to websocket server");
         SetError(Lang::Strings::SERVER_NOT_CONNECTED);
         return false;
     }
+    connection_generation_ = generations[network_];
 
     // Send hello message to describe the client
+    BeginLinkSession();
     auto message = GetHelloMessage();
     if (!SendText(message))
     {
@@ -318,6 +351,11 @@ std::string WebsocketProtocol::GetHelloMessage()
     cJSON_AddBoolToObject(features, "aec", true);
 #endif
     cJSON_AddBoolToObject(features, "mcp", true);
+    cJSON_AddBoolToObject(features, "ping", true);
+    if (tts_cache_enabled_)
+    {
+        cJSON_AddBoolToObject(features, "tts_cache", true);
+    }
     cJSON_AddItemToObject(root, "features", features);
     cJSON_AddStringToObject(root, "transport", "websocket");
     cJSON *audio_params = cJSON_CreateObject();
@@ -325,6 +363,7 @@ std::string WebsocketProtocol::GetHelloMessage()
     cJSON_AddNumberToObject(audio_params, "sample_rate", 16000);
     cJSON_AddNumberToObject(audio_params, "channels", 1);
     cJSON_AddNumberToObject(audio_params, "frame_duration", OPUS_FRAME_DURATION_MS);
+    AddDownlinkAudioParams(audio_params);
     cJSON_AddItemToObject(root, "audio_params", audio_params);
     auto json_str = cJSON_PrintUnformatted(root);
     std::string message(json_str);
@@ -349,20 +388,9 @@ void WebsocketProtocol::ParseServerHello(const cJSON *root)
         ESP_LOGI(TAG, "Session ID: %s", session_id_.c_str());
     }
 
-    auto audio_params = cJSON_GetObjectItem(root, "audio_params");
-    if (cJSON_IsObject(audio_params))
-    {
-        auto sample_rate = cJSON_GetObjectItem(audio_params, "sample_rate");
-        if (cJSON_IsNumber(sample_rate))
-        {
-            server_sample_rate_ = sample_rate->valueint;
-        }
-        auto frame_duration = cJSON_GetObjectItem(audio_params, "frame_duration");
-        if (cJSON_IsNumber(frame_duration))
-        {
-            server_frame_duration_ = frame_duration->valueint;
-        }
-    }
+    ParseServerFeatures(root);
+
+    ParseServerAudioParams(root);
 
     xEventGroupSetBits(event_group_handle_, WEBSOCKET_PROTOCOL_SERVER_HELLO_EVENT);
 }
@@ -8,6 +8,8 @@
 #include <freertos/event_groups.h>
 #include <web_socket.h>
 
+#include <atomic>
+
 #define WEBSOCKET_PROTOCOL_SERVER_HELLO_EVENT (1 << 0)
 
 class WebsocketProtocol : public Protocol
@@ -21,6 +23,7 @@ public:
     bool OpenAudioChannel() override;
     void CloseAudioChannel() override;
     bool IsAudioChannelOpened() const override;
+    bool MigrateAudioChannel() override;
 
     void SetDeviceState(DeviceState state); // 设置设备状态以控制超时行为
 
@@ -30,9 +33,12 @@ private:
     int version_ = 1;
     bool audio_channel_active_ = false;              // 音频通道状态
     bool connection_established_ = false;            // 连接状态
+    std::atomic<uint32_t> connection_generation_{0}; // 当前连接的代数，其他连接的回调据此被忽略
+    uint32_t last_generation_ = 0;                   // 已分配的最大代数，只在打开和迁移通道时使用
     DeviceState device_state_ = kDeviceStateUnknown; // 设备状态
 
     void ParseServerHello(const cJSON *root);
+    void SetupWebsocketCallbacks(WebSocket *websocket, uint32_t generation);
     bool SendText(const std::string &text) override;
     std::string GetHelloMessage();
     bool EstablishConnection(); // 建立基础连接
@@ -0,0 +1,55 @@
+#include "string_utils.h"
+
+#include <cstdlib>
+
+// Unicode解码函数
+std::string DecodeUnicodeEscapes(const std::string &input)
+{
+    std::string result;
+    result.reserve(input.length());
+
+    for (size_t i = 0; i < input.length(); ++i)
+    {
+        if (input[i] == '\\' && i + 1 < input.length() && input[i + 1] == 'u' && i + 5 < input.length())
+        {
+            // 解析 \uXXXX 格式的Unicode转义序列
+            std::string hex_str = input.substr(i + 2, 4);
+            char *end_ptr;
+            unsigned long unicode_value = strtoul(hex_str.c_str(), &end_ptr, 16);
+
+            if (end_ptr == hex_str.c_str() + 4) // 确保解析成功
+            {
+                // 将Unicode码点转换为UTF-8
+                if (unicode_value <= 0x7F)
+                {
+                    // 1字节UTF-8
+                    result += static_cast<char>(unicode_value);
+                }
+                else if (unicode_value <= 0x7FF)
+                {
+                    // 2字节UTF-8
+                    result += static_cast<char>(0xC0 | (unicode_value >> 6));
+                    result += static_cast<char>(0x80 | (unicode_value & 0x3F));
+                }
+                else if (unicode_value <= 0xFFFF)
+                {
+                    // 3字节UTF-8
+                    result += static_cast<char>(0xE0 | (unicode_value >> 12));
+                    result += static_cast<char>(0x80 | ((unicode_value >> 6) & 0x3F));
+                    result += static_cast<char>(0x80 | (unicode_value & 0x3F));
+                }
+                i += 5; // 跳过 \uXXXX
+            }
+            else
+            {
+                result += input[i]; // 解析失败，保持原字符
+            }
+        }
+        else
+        {
+            result += input[i];
+        }
+    }
+
+    return result;
+}
@@ -0,0 +1,9 @@
+#ifndef STRING_UTILS_H
+#define STRING_UTILS_H
+
+#include <string>
+
+// 将 \uXXXX 转义序列解码为 UTF-8，无法解析的转义保持原样
+std::string DecodeUnicodeEscapes(const std::string &input);
+
+#endif // STRING_UTILS_H
@@ -1,54 +1,183 @@
 import socket
+import struct
 import wave
 import argparse
 
 
 '''
   Create a UDP socket and bind it to the server's IP:8000.
-  Listen for incoming messages and print them to the console.
-  Save the audio to a WAV file.
+  Receive the audio debug streams sent by the device (AudioDebugger),
+  demux them by tap, reassemble them by sample position and save one WAV file per tap.
+
+  Packet layout (little endian):
+    magic u16 ("AD"), version u8, tap u8, codec u8, channels u8, sample_rate u16,
+    sequence u32, sample_index u32, frames u16, reserved u16
+  ADPCM packets are followed by channels x (predictor i16, step_index u8, pad u8),
+  then 4-bit samples interleaved by channel, low nibble first.
+  Packets without the header are treated as raw PCM from older firmware.
 '''
-def main(samplerate, channels):
+
+HEADER = struct.Struct('<HBBBBHIIHH')
+MAGIC = 0x4441
+TAP_NAMES = ['mic', 'reference', 'afe_output', 'downlink', 'playback']
+CODEC_PCM = 0
+CODEC_ADPCM = 1
+# 乱序缓冲的最大数据报数，超过后认为缺失的数据报已丢失并用静音补齐
+REORDER_WINDOW = 16
+
+STEP_TABLE = [
+    7, 8, 9, 10, 11, 12, 13, 14, 16, 17, 19, 21, 23, 25, 28, 31, 34, 37, 41, 45,
+    50, 55, 60, 66, 73, 80, 88, 97, 107, 118, 130, 143, 157, 173, 190, 209, 230,
+    253, 279, 307, 337, 371, 408, 449, 494, 544, 598, 658, 724, 796, 876, 963,
+    1060, 1166, 1282, 1411, 1552, 1707, 1878, 2066, 2272, 2499, 2749, 3024, 3327,
+    3660, 4026, 4428, 4871, 5358, 5894, 6484, 7132, 7845, 8630, 9493, 10442,
+    11487, 12635, 13899, 15289, 16818, 18500, 20350, 22385, 24623, 27086, 29794, 32767,
+]
+INDEX_TABLE = [-1, -1, -1, -1, 2, 4, 6, 8, -1, -1, -1, -1, 2, 4, 6, 8]
+
+
+def decode_adpcm(payload, channels, frames):
+    states = []
+    for ch in range(channels):
+        predictor, index, _ = struct.unpack_from('<hBB', payload, ch * 4)
+        states.append([predictor, index])
+    data = payload[channels * 4:]
+    samples = []
+    for i in range(frames * channels):
+        byte = data[i >> 1]
+        nibble = (byte >> 4) if (i & 1) else (byte & 0x0F)
+        state = states[i % channels]
+        step = STEP_TABLE[state[1]]
+        delta = step >> 3
+        if nibble & 4:
+            delta += step
+        if nibble & 2:
+            delta += step >> 1
+        if nibble & 1:
+            delta += step >> 2
+        predictor = state[0] - delta if nibble & 8 else state[0] + delta
+        state[0] = max(-32768, min(32767, predictor))
+        state[1] = max(0, min(88, state[1] + INDEX_TABLE[nibble]))
+        samples.append(state[0])
+    return struct.pack(f'<{len(samples)}h', *samples)
+
+
+class TapStream:
+    def __init__(self, tap, channels, samplerate, segment):
+        name = TAP_NAMES[tap] if tap < len(TAP_NAMES) else f'tap{tap}'
+        suffix = f'_{segment}' if segment > 0 else ''
+        self.filename = f'{name}_{samplerate}_{channels}{suffix}.wav'
+        self.channels = channels
+        self.samplerate = samplerate
+        self.wav_file = wave.open(self.filename, 'wb')
+        self.wav_file.setnchannels(channels)
+        self.wav_file.setsampwidth(2)
+        self.wav_file.setframerate(samplerate)
+        self.next_index = 0
+        self.pending = {}
+        self.first_sequence = None
+        self.max_sequence = None
+        self.received = 0
+        self.silence_frames = 0
+        print(f'New stream {self.filename}')
+
+    def push(self, sequence, sample_index, pcm):
+        self.received += 1
+        if self.first_sequence is None:
+            self.first_sequence = self.max_sequence = sequence
+        self.max_sequence = max(self.max_sequence, sequence)
+        if sample_index < self.next_index:
+            return  # 重复或已被静音补齐的数据报
+        self.pending[sample_index] = pcm
+        self.flush(force=len(self.pending) > REORDER_WINDOW)
+
+    def flush(self, force=False):
+        while self.pending:
+            if self.next_index in self.pending:
+                pcm = self.pending.pop(self.next_index)
+            elif force:
+                gap = min(self.pending) - self.next_index
+                pcm = b'\x00' * (gap * self.channels * 2)
+                self.silence_frames += gap
+                force = len(self.pending) > REORDER_WINDOW
+            else:
+                break
+            self.wav_file.writeframes(pcm)
+            self.next_index += len(pcm) // (self.channels * 2)
+
+    def close(self):
+        self.flush(force=True)
+        self.wav_file.close()
+        lost = 0 if self.first_sequence is None else self.max_sequence - self.first_sequence + 1 - self.received
+        print(f'{self.filename}: {self.received} packets, {max(lost, 0)} lost, '
+              f'{self.silence_frames / self.samplerate:.2f}s filled with silence')
+
+
+def main(samplerate, channels, port):
     # Create a UDP socket
     server_socket = socket.socket(socket.AF_INET, socket.SOCK_DGRAM)
-    server_socket.bind(('0.0.0.0', 8000))
+    server_socket.bind(('0.0.0.0', port))
 
-    # Create WAV file with parameters
-    filename = f"{samplerate}_{channels}.wav"
-    wav_file = wave.open(filename, "wb")
-    wav_file.setnchannels(channels)     # channels parameter
-    wav_file.setsampwidth(2)            # 2 bytes per sample (16-bit)
-    wav_file.setframerate(samplerate)   # samplerate parameter
+    streams = {}
+    segments = {}
+    legacy_file = None
 
-    print(f"Start saving audio from 0.0.0.0:8000 to {filename}...")
+    print(f'Start receiving audio debug streams on 0.0.0.0:{port}...')
 
     try:
         while True:
-            # Receive a message from the client
             message, address = server_socket.recvfrom(8000)
-            
-            # Write PCM data to WAV file
-            wav_file.writeframes(message)
 
-            # Print length of the message
-            print(f"Received {len(message)} bytes from {address}")
-    
+            if len(message) < HEADER.size or HEADER.unpack_from(message)[0] != MAGIC:
+                # 旧版固件直接发送原始 PCM
+                if legacy_file is None:
+                    filename = f'{samplerate}_{channels}.wav'
+                    legacy_file = wave.open(filename, 'wb')
+                    legacy_file.setnchannels(channels)
+                    legacy_file.setsampwidth(2)
+                    legacy_file.setframerate(samplerate)
+                    print(f'Saving raw audio to {filename}')
+                legacy_file.writeframes(message)
+                continue
+
+            _, version, tap, codec, ch, rate, sequence, sample_index, frames, _ = HEADER.unpack_from(message)
+            payload = message[HEADER.size:]
+            if codec == CODEC_ADPCM:
+                pcm = decode_adpcm(payload, ch, frames)
+            else:
+                pcm = payload[:frames * ch * 2]
+
+            # 格式变化或流重新开始时另存一个文件
+            stream = streams.get(tap)
+            if stream is None or stream.channels != ch or stream.samplerate != rate or \
+                    (sample_index == 0 and stream.next_index > 0):
+                if stream is not None:
+                    stream.close()
+                segments[tap] = segments.get(tap, -1) + 1
+                stream = TapStream(tap, ch, rate, segments[tap])
+                streams[tap] = stream
+            stream.push(sequence, sample_index, pcm)
+
     except KeyboardInterrupt:
-        print("\nStopping recording...")
-    
+        print('\nStopping recording...')
+
     finally:
         # Close files and socket
-        wav_file.close()
+        for stream in streams.values():
+            stream.close()
+        if legacy_file is not None:
+            legacy_file.close()
         server_socket.close()
-        print(f"WAV file '{filename}' saved successfully")
 
 
 if __name__ == "__main__":
-    parser = argparse.ArgumentParser(description='UDP音频数据接收器，保存为WAV文件')
-    parser.add_argument('--samplerate', '-s', type=int, default=16000, 
-                        help='采样率 (默认: 16000)')
-    parser.add_argument('--channels', '-c', type=int, default=2, 
-                        help='声道数 (默认: 2)')
-    
+    parser = argparse.ArgumentParser(description='UDP音频调试数据接收器，按采集点分别保存为WAV文件')
+    parser.add_argument('--samplerate', '-s', type=int, default=16000,
+                        help='旧版原始PCM数据的采样率 (默认: 16000)')
+    parser.add_argument('--channels', '-c', type=int, default=2,
+                        help='旧版原始PCM数据的声道数 (默认: 2)')
+    parser.add_argument('--port', '-p', type=int, default=8000,
+                        help='监听端口 (默认: 8000)')
+
     args = parser.parse_args()
-    main(args.samplerate, args.channels)
+    main(args.samplerate, args.channels, args.port)